@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+// Measures the time taken by each integrity check depending on the number of
+// threads used.
+//
+// Usage: check_integrity [entryCount] [contentSize]
+
+#include <zim/archive.h>
+
+#include "tools.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace zim::benchmark;
+
+namespace
+{
+
+const char* const CHECK_NAMES[] = {
+  "checksum", "dirent ptrs", "dirent order", "title index",
+  "cluster ptrs", "clusters offsets", "dirent mimetypes", "cluster checksums"
+};
+
+void checkIntegrity(const std::string& path, unsigned threadCount)
+{
+  std::cout << threadCount << " thread(s):" << std::endl;
+  double totalMs = 0;
+  for ( size_t i = 0; i < size_t(zim::IntegrityCheck::COUNT); ++i ) {
+    // Use a fresh archive for each check to not benefit from the caches.
+    zim::Archive archive(path);
+    Timer timer;
+    const bool valid = archive.checkIntegrity(zim::IntegrityCheck(i), threadCount);
+    const double ms = timer.elapsedMs();
+    totalMs += ms;
+    std::cout << "  " << CHECK_NAMES[i] << " : " << ms << " ms"
+              << (valid ? "" : " (FAILED)") << std::endl;
+  }
+  std::cout << "  total : " << totalMs << " ms" << std::endl;
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+  SyntheticArchiveConfig config;
+  config.entryCount = getArg(argc, argv, 1, 100000);
+  config.contentSize = getArg(argc, argv, 2, 4096);
+
+  TempDir tmpDir("zim_check_integrity_benchmark");
+  const std::string path = tmpDir.path() + "/archive.zim";
+  std::cout << "Creating an archive of " << config.entryCount << " entries..." << std::endl;
+  createSyntheticArchive(path, config);
+
+  const unsigned maxThreadCount = std::max(1U, std::thread::hardware_concurrency());
+  for ( unsigned threadCount = 1; threadCount < maxThreadCount; threadCount *= 2 ) {
+    checkIntegrity(path, threadCount);
+  }
+  checkIntegrity(path, maxThreadCount);
+  return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+// Measures the latency of opening many (small) archives, with and without
+// lazy opening.
+//
+// Usage: open_archives [archiveCount] [entryCountPerArchive]
+
+#include <zim/archive.h>
+#include <zim/item.h>
+
+#include "tools.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace zim::benchmark;
+
+namespace
+{
+
+void openArchives(const std::vector<std::string>& paths,
+                  const std::string& name,
+                  zim::OpenConfig openConfig)
+{
+  std::vector<zim::Archive> archives;
+  archives.reserve(paths.size());
+
+  Timer openTimer;
+  for ( const auto& path : paths ) {
+    archives.emplace_back(path, openConfig);
+  }
+  const double openMs = openTimer.elapsedMs();
+
+  Timer accessTimer;
+  for ( const auto& archive : archives ) {
+    archive.getEntryByPath("entry_0").getItem().getSize();
+  }
+  const double accessMs = accessTimer.elapsedMs();
+
+  std::cout << name << ":\n"
+            << "  open         : " << openMs << " ms ("
+            << 1000 * openMs / paths.size() << " us/archive)\n"
+            << "  first access : " << accessMs << " ms ("
+            << 1000 * accessMs / paths.size() << " us/archive)" << std::endl;
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+  const unsigned archiveCount = getArg(argc, argv, 1, 500);
+  SyntheticArchiveConfig config;
+  config.entryCount = getArg(argc, argv, 2, 200);
+
+  TempDir tmpDir("zim_open_benchmark");
+  std::vector<std::string> paths;
+  std::cout << "Creating " << archiveCount << " archives of "
+            << config.entryCount << " entries..." << std::endl;
+  for ( unsigned i = 0; i < archiveCount; ++i ) {
+    paths.push_back(tmpDir.path() + "/archive_" + std::to_string(i) + ".zim");
+    createSyntheticArchive(paths.back(), config);
+  }
+
+  openArchives(paths, "default", zim::OpenConfig());
+  openArchives(paths, "no preloading", zim::OpenConfig().preloadXapianDb(false).preloadDirentRanges(0));
+  openArchives(paths, "lazy", zim::OpenConfig().lazyOpen(true));
+  return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+// Measures the fulltext search throughput depending on the number of threads
+// searching concurrently in the same archive.
+//
+// Usage: search [entryCount] [queriesPerThread]
+
+#include <zim/archive.h>
+#include <zim/search.h>
+
+#include "tools.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace zim::benchmark;
+
+namespace
+{
+
+const char* const QUERIES[] = {
+  "archive", "cluster reader", "offline library", "kiwix", "search index",
+  "wikipedia content", "compression server", "title entry"
+};
+
+void runQueries(const zim::Archive& archive, unsigned threadIndex, unsigned queryCount)
+{
+  zim::Searcher searcher(archive);
+  const size_t queryKinds = sizeof(QUERIES)/sizeof(QUERIES[0]);
+  for ( unsigned i = 0; i < queryCount; ++i ) {
+    auto search = searcher.search(zim::Query(QUERIES[(threadIndex + i) % queryKinds]));
+    search.getEstimatedMatches();
+    for ( const auto& result : search.getResults(0, 20) ) {
+      (void)result.getPath();
+    }
+  }
+}
+
+void search(const zim::Archive& archive, unsigned threadCount, unsigned queriesPerThread)
+{
+  Timer timer;
+  std::vector<std::thread> threads;
+  for ( unsigned i = 0; i < threadCount; ++i ) {
+    threads.emplace_back(runQueries, std::cref(archive), i, queriesPerThread);
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+  const double ms = timer.elapsedMs();
+  const unsigned queryCount = threadCount * queriesPerThread;
+  std::cout << threadCount << " thread(s): " << queryCount << " queries in "
+            << ms << " ms (" << 1000 * queryCount / ms << " queries/s)" << std::endl;
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+  SyntheticArchiveConfig config;
+  config.entryCount = getArg(argc, argv, 1, 20000);
+  config.withFulltextIndex = true;
+  const unsigned queriesPerThread = getArg(argc, argv, 2, 200);
+
+  TempDir tmpDir("zim_search_benchmark");
+  const std::string path = tmpDir.path() + "/archive.zim";
+  std::cout << "Creating an archive of " << config.entryCount << " entries..." << std::endl;
+  createSyntheticArchive(path, config);
+
+  const zim::Archive archive(path);
+  // Warm up the caches (and open the fulltext index).
+  runQueries(archive, 0, 1);
+
+  const unsigned maxThreadCount = std::max(1U, std::thread::hardware_concurrency());
+  for ( unsigned threadCount = 1; threadCount < maxThreadCount; threadCount *= 2 ) {
+    search(archive, threadCount, queriesPerThread);
+  }
+  search(archive, maxThreadCount, queriesPerThread);
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "tools.h"
+
+#include <zim/writer/creator.h>
+#include <zim/writer/item.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <sstream>
+
+namespace zim
+{
+
+namespace benchmark
+{
+
+namespace
+{
+
+const char* const WORDS[] = {
+  "archive", "cluster", "entry", "offline", "reader", "wikipedia", "content",
+  "library", "kiwix", "search", "title", "index", "compression", "server"
+};
+
+} // unnamed namespace
+
+TempDir::TempDir(const std::string& name)
+{
+  namespace fs = std::filesystem;
+  std::random_device rd;
+  for ( ;; ) {
+    const auto p = fs::temp_directory_path() / (name + "_" + std::to_string(rd()));
+    if ( fs::create_directory(p) ) {
+      path_ = p.string();
+      break;
+    }
+  }
+}
+
+TempDir::~TempDir()
+{
+  std::error_code ec;
+  std::filesystem::remove_all(path_, ec);
+}
+
+std::string syntheticContent(unsigned i, unsigned contentSize)
+{
+  std::mt19937 gen(i);
+  std::ostringstream ss;
+  ss << "<html><head><title>Entry " << i << "</title></head><body><p>";
+  while ( ss.tellp() < std::streamoff(contentSize) ) {
+    ss << WORDS[gen() % (sizeof(WORDS)/sizeof(WORDS[0]))] << ' ';
+  }
+  ss << "</p></body></html>";
+  return ss.str();
+}
+
+void createSyntheticArchive(const std::string& path, const SyntheticArchiveConfig& config)
+{
+  zim::writer::Creator creator;
+  creator.configIndexing(config.withFulltextIndex, "eng");
+  if ( !config.compressed ) {
+    creator.configCompression(zim::Compression::None);
+  }
+  creator.startZimCreation(path);
+  for ( unsigned i = 0; i < config.entryCount; ++i ) {
+    creator.addItem(zim::writer::StringItem::create(
+      "entry_" + std::to_string(i),
+      "text/html",
+      "Entry " + std::to_string(i),
+      zim::writer::Hints{{zim::writer::FRONT_ARTICLE, 1}},
+      syntheticContent(i, config.contentSize)));
+  }
+  creator.addMetadata("Title", "Synthetic archive");
+  creator.addMetadata("Language", "eng");
+  if ( config.entryCount ) {
+    creator.setMainPath("entry_0");
+  }
+  creator.finishZimCreation();
+}
+
+unsigned getArg(int argc, char* argv[], int index, unsigned defaultValue)
+{
+  if ( index < argc ) {
+    return unsigned(std::strtoul(argv[index], nullptr, 10));
+  }
+  return defaultValue;
+}
+
+} // namespace benchmark
+
+} // namespace zim
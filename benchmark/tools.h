@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#ifndef ZIM_BENCHMARK_TOOLS_H
+#define ZIM_BENCHMARK_TOOLS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace zim
+{
+
+namespace benchmark
+{
+
+// Measures the wall clock time elapsed since its construction.
+class Timer
+{
+  typedef std::chrono::steady_clock Clock;
+
+public:
+  Timer() : start_(Clock::now()) {}
+
+  double elapsedMs() const
+  {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start_).count();
+  }
+
+private:
+  Clock::time_point start_;
+};
+
+// A temporary directory, removed (with its content) at destruction.
+class TempDir
+{
+public:
+  explicit TempDir(const std::string& name);
+  TempDir(const TempDir&) = delete;
+  void operator=(const TempDir&) = delete;
+  ~TempDir();
+
+  const std::string& path() const { return path_; }
+
+private:
+  std::string path_;
+};
+
+struct SyntheticArchiveConfig
+{
+  unsigned entryCount = 1000;
+  unsigned contentSize = 1024;
+  bool compressed = true;
+  bool withFulltextIndex = false;
+};
+
+// Creates a zim archive at `path` filled with generated html entries.
+// Entry `i` has path `entry_<i>` and title `Entry <i>`.
+void createSyntheticArchive(const std::string& path, const SyntheticArchiveConfig& config);
+
+// Generated content of the entry `i` (as stored by createSyntheticArchive).
+std::string syntheticContent(unsigned i, unsigned contentSize);
+
+// Parses the `index`th command line argument as an unsigned int.
+unsigned getArg(int argc, char* argv[], int index, unsigned defaultValue);
+
+} // namespace benchmark
+
+} // namespace zim
+
+#endif // ZIM_BENCHMARK_TOOLS_H
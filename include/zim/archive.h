@@ -23,6 +23,7 @@
 #define ZIM_ARCHIVE_H
 
 #include "zim.h"
+#include "blob.h"
 #include "entry.h"
 #include "illustration.h"
 #include "uuid.h"
@@ -31,6 +32,8 @@
 #include <vector>
 #include <memory>
 #include <bitset>
+#include <functional>
+#include <future>
 #include <set>
 
 namespace zim
@@ -64,6 +67,159 @@ namespace zim
    */
   void LIBZIM_API setClusterCacheMaxSize(size_t sizeInB);
 
+  /** Get the maximum number of file descriptors kept opened by the fd pool.
+   *
+   * @return The maximum number of opened file descriptors (0 means no limit).
+   */
+  size_t LIBZIM_API getFdPoolMaxSize();
+
+  /** Get the number of file descriptors currently opened by the fd pool.
+   *
+   * Only the file descriptors the pool can close (and reopen) are counted.
+   * Files opened from a file descriptor given by the user are never closed
+   * by the pool and so are not counted.
+   *
+   * @return The number of opened file descriptors managed by the pool.
+   */
+  size_t LIBZIM_API getFdPoolCurrentSize();
+
+  /** Set the maximum number of file descriptors kept opened by the fd pool.
+   *
+   * All the files opened by libzim (from a path) are managed by a process-wide
+   * pool. If a limit is set, the least recently used file descriptors are
+   * closed to respect it and transparently reopened when needed.
+   * This allows to keep opened more archives (or parts of archives) than the
+   * limit of file descriptors of the process.
+   *
+   * By default, there is no limit and file descriptors are never closed.
+   *
+   * @param maxSize The maximum number of opened file descriptors
+   *                (0 to remove the limit).
+   */
+  void LIBZIM_API setFdPoolMaxSize(size_t maxSize);
+
+  /** Get the number of times a file descriptor was found opened in the fd pool.
+   *
+   * Hits are counted only while a limit is set.
+   */
+  size_t LIBZIM_API getFdPoolHitCount();
+
+  /** Get the number of times a file descriptor had to be reopened.
+   */
+  size_t LIBZIM_API getFdPoolMissCount();
+
+  /**
+   * An allocator for the decompressed data of the clusters.
+   *
+   * Implementations must be threadsafe.
+   */
+  class LIBZIM_API ClusterBufferAllocator
+  {
+    public:
+      virtual ~ClusterBufferAllocator() = default;
+
+      /** Allocate a buffer of (at least) `size` bytes.
+       *
+       * Must return a valid pointer or throw (`std::bad_alloc`).
+       */
+      virtual char* allocate(size_t size) = 0;
+
+      /** Deallocate a buffer previously returned by `allocate(size)`.
+       *
+       * Must not throw.
+       */
+      virtual void deallocate(char* data, size_t size) = 0;
+  };
+
+  /** Statistics of the default allocator of the decompressed cluster data.
+   */
+  struct ClusterBufferArenaStats
+  {
+    /// The number of buffers allocated.
+    size_t allocationCount = 0;
+
+    /// The number of allocations served by reusing a freed buffer.
+    size_t reuseCount = 0;
+
+    /// The memory size (in bytes) used by the currently allocated buffers.
+    size_t usedSize = 0;
+
+    /// The memory size (in bytes) of the freed buffers kept for reuse.
+    size_t cachedSize = 0;
+  };
+
+  /** Set the allocator used for the decompressed cluster data.
+   *
+   * By default, the decompressed cluster data is allocated by an arena
+   * recycling the freed buffers (see `setClusterBufferArenaMaxCachedSize`).
+   * Buffers already allocated are deallocated by the allocator which
+   * allocated them (which is kept alive as long as needed).
+   *
+   * @param allocator The allocator to use. nullptr to use the default arena.
+   */
+  void LIBZIM_API setClusterBufferAllocator(std::shared_ptr<ClusterBufferAllocator> allocator);
+
+  /** Get the statistics of the default arena.
+   *
+   * Allocations done by a custom allocator are not counted.
+   */
+  ClusterBufferArenaStats LIBZIM_API getClusterBufferArenaStats();
+
+  /** Get the maximum size of the freed buffers kept for reuse by the default arena.
+   *
+   * @return The maximum size (in bytes) of the freed buffers kept for reuse.
+   */
+  size_t LIBZIM_API getClusterBufferArenaMaxCachedSize();
+
+  /** Set the maximum size of the freed buffers kept for reuse by the default arena.
+   *
+   * Freed buffers are kept by size class to be reused by the next allocations
+   * of the same size class. If the new size is lower than the size of the
+   * buffers currently kept, some of them are released.
+   * Note that this memory is not accounted in the cluster cache size.
+   *
+   * Default is 32MiB.
+   *
+   * @param sizeInB The maximum size (0 to disable the reuse of buffers).
+   */
+  void LIBZIM_API setClusterBufferArenaMaxCachedSize(size_t sizeInB);
+
+  /** Advise the system to back big buffers of the default arena with huge pages.
+   *
+   * This concerns buffers of 2MiB or more and is only supported on Linux
+   * (with transparent huge pages in `madvise` mode). It affects only the
+   * buffers allocated after the call.
+   *
+   * Default is false.
+   */
+  void LIBZIM_API setClusterBufferArenaUseHugePages(bool useHugePages);
+
+  /** Get the number of threads used by the asynchronous item data API.
+   *
+   * @return The maximum number of threads used.
+   */
+  unsigned LIBZIM_API getAsyncThreadCount();
+
+  /** Set the number of threads used by the asynchronous item data API.
+   *
+   * The threads are started on demand. The call waits for the current
+   * threads to complete the pending requests.
+   * It must not be called from an `ItemDataCallback`.
+   *
+   * Default is the number of hardware threads.
+   *
+   * @param threadCount The maximum number of threads (at least 1).
+   */
+  void LIBZIM_API setAsyncThreadCount(unsigned threadCount);
+
+  /** A callback receiving the result of an asynchronous item data request.
+   *
+   * `error` is null on success. Else `data` is empty and `error` holds the
+   * exception thrown by the request.
+   * The callback is called from a libzim thread and must not throw.
+   */
+  typedef std::function<void(const Blob& data, std::exception_ptr error)> ItemDataCallback;
+
 
   /**
    * The Archive class to access content in a zim file.
@@ -483,6 +639,68 @@ namespace zim
        */
       Entry getRandomEntry() const;
 
+      /** Get the data of an entry asynchronously.
+       *
+       * Redirections are resolved and the data of the targeted item is
+       * returned. The cluster is loaded (and decompressed) by a libzim thread
+       * (see `setAsyncThreadCount`) and stored in the cluster cache as with
+       * `Item::getData()`. Concurrent requests on the same cluster wait for the
+       * same load.
+       *
+       * @param entry The entry.
+       * @return A future on the data.
+       */
+      std::future<Blob> getItemDataAsync(const Entry& entry) const;
+
+      /** Get the data of an entry asynchronously and pass it to a callback.
+       *
+       * Same as `getItemDataAsync(entry)`, but `callback` is called (from a
+       * libzim thread) with the result instead of returning a future.
+       *
+       * @param entry The entry.
+       * @param callback The callback to call once the data is available.
+       */
+      void getItemDataAsync(const Entry& entry, ItemDataCallback callback) const;
+
+      /** Get the data of an entry, given its path, asynchronously.
+       *
+       * The entry is searched as with `getEntryByPath(path)`, by a libzim
+       * thread. The future holds an `EntryNotFound` exception if there is no
+       * entry with this path.
+       *
+       * @param path The entry's path.
+       * @return A future on the data.
+       */
+      std::future<Blob> getItemDataByPathAsync(const std::string& path) const;
+
+      /** Get the data of an entry, given its path, and pass it to a callback.
+       *
+       * @param path The entry's path.
+       * @param callback The callback to call once the data is available.
+       */
+      void getItemDataByPathAsync(const std::string& path, ItemDataCallback callback) const;
+
+      /** Get the data of an entry only if it is available without blocking.
+       *
+       * The data is available if the cluster containing it (and, for a
+       * redirection, the dirents of the redirection chain) are already in
+       * the caches and the item's blob is already decompressed. Else,
+       * nothing is read and the method returns false immediately.
+       * As items stored in uncompressed clusters are read from the file on
+       * access, their data is never available this way.
+       *
+       * This allows latency-critical threads to serve cached data inline and
+       * defer the other requests (to `getItemDataAsync()` for example).
+       *
+       * @param entry The entry. Redirections are resolved.
+       * @param data Set to the data of the item if available.
+       * @param loadInBackground If true and the data is not available, load
+       *        and decompress the needed cluster in the cache using the
+       *        asynchronous item data threads (see `setAsyncThreadCount`).
+       * @return true if the data is available, false if getting it would block.
+       */
+      bool tryGetItemData(const Entry& entry, Blob& data, bool loadInBackground = false) const;
+
       /** Check in an entry has path in the archive.
        *
        *  The path follows the same requirement than `getEntryByPath`.
@@ -588,6 +806,30 @@ namespace zim
        */
       EntryRange<EntryOrder::efficientOrder> iterEfficient() const;
 
+      /** Split the entries in efficient order in ranges aligned on clusters.
+       *
+       * Return `partCount` consecutive ranges which, together, cover
+       * `iterEfficient()`. All the entries stored in a cluster are in the same
+       * range, so processing each range in a different thread decompresses
+       * each cluster only once. The ranges are balanced on the compressed size
+       * of their clusters (not on their number of entries).
+       *
+       * Some ranges may be empty (if there are less clusters than ranges
+       * or if some clusters are very big).
+       *
+       *  ```c++
+       *  for(auto& range:archive.partitionByCluster(threadCount)) {
+       *     threads.emplace_back([range]() {
+       *       for(auto& entry:range) { ... }
+       *     });
+       *  }
+       *  ```
+       *
+       * @param partCount The number of ranges to return.
+       * @return A vector of `partCount` ranges.
+       */
+      std::vector<EntryRange<EntryOrder::efficientOrder>> partitionByCluster(size_t partCount) const;
+
       /** Find a range of entries starting with path.
        *
        * When using new namespace scheme, path must not contain the namespace (`foo.html`).
@@ -660,6 +902,43 @@ namespace zim
        */
       bool checkIntegrity(IntegrityCheck checkType);
 
+      /** Check the integrity of the zim file using several threads.
+       *
+       * Same as `checkIntegrity(checkType)`, but the entries (or clusters)
+       * to check are split between `threadCount` threads.
+       *
+       * @param checkType The check to run.
+       * @param threadCount The number of threads to use (0 means one per
+       *                    hardware thread).
+       * @param progress Optional callback, regularly called from the calling
+       *                 thread. The check is cancelled if it returns false.
+       * @return True if the file is valid. False if it is not or if the
+       *         check has been cancelled.
+       */
+      bool checkIntegrity(IntegrityCheck checkType, unsigned threadCount,
+                          const IntegrityCheckProgress& progress = IntegrityCheckProgress());
+
+      /** Check if the archive stores a checksum for its clusters.
+       *
+       * Such checksums allow to verify only the part of the archive being
+       * used (see `verifyItemData()`) and to run the
+       * `IntegrityCheck::CLUSTER_CHECKSUMS` check in parallel.
+       *
+       * @return True if the archive has cluster checksums.
+       */
+      bool hasClusterChecksums() const;
+
+      /** Verify the cluster containing the data of an item.
+       *
+       * The raw content of the cluster is read from the file and its
+       * checksum compared with the one stored in the archive.
+       *
+       * @param item The item to verify.
+       * @return False if the checksum doesn't match. True if it matches or if
+       *         the archive has no checksum for this cluster.
+       */
+      bool verifyItemData(const Item& item) const;
+
       /** Check if the file is split in the filesystem.
        *
        *  @return True if the archive is split in different file (foo.zimaa, foo.zimbb).
@@ -906,6 +1185,23 @@ private:
    * @return False if any check fails, true otherwise.
    */
   bool LIBZIM_API validate(const std::string& zimPath, IntegrityCheckList checksToRun);
+
+  /** Check the integrity of the zim file using several threads.
+   *
+   * Same as `validate(zimPath, checksToRun)` but each check is run with
+   * `Archive::checkIntegrity(checkType, threadCount, progress)`.
+   *
+   * @param zimPath The path of the ZIM archive to be checked.
+   * @param checksToRun The set of checks to perform.
+   * @param threadCount The number of threads to use (0 means one per
+   *                    hardware thread).
+   * @param progress Optional progress callback, see `IntegrityCheckProgress`.
+   * @return False if any check fails or has been cancelled, true otherwise.
+   */
+  bool LIBZIM_API validate(const std::string& zimPath,
+                           IntegrityCheckList checksToRun,
+                           unsigned threadCount,
+                           const IntegrityCheckProgress& progress = IntegrityCheckProgress());
 }
 
 #endif // ZIM_ARCHIVE_H
@@ -83,6 +83,11 @@ namespace zim
 
       entry_index_type getIndex() const   { return m_idx; }
 
+#ifdef ZIM_PRIVATE
+      std::shared_ptr<const FileImpl> getFileImpl() const { return m_file; }
+      std::shared_ptr<const Dirent> getDirent() const     { return m_dirent; }
+#endif
+
     protected: // so that Item can be implemented as a wrapper over Entry
       std::shared_ptr<const FileImpl> m_file;
       entry_index_type m_idx;
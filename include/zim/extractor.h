@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_EXTRACTOR_H
+#define ZIM_EXTRACTOR_H
+
+#include "archive.h"
+#include "blob.h"
+
+#include <functional>
+#include <iosfwd>
+#include <set>
+#include <string>
+
+namespace zim
+{
+  /**
+   * The destination of the data exported by an `Extractor`.
+   *
+   * All the methods of a sink are called from the thread calling
+   * `Extractor::extract()`, one at a time. A sink doesn't have to be
+   * threadsafe.
+   *
+   * Entries are given in no specific order.
+   */
+  class LIBZIM_API ExtractSink
+  {
+    public:
+      virtual ~ExtractSink();
+
+      /** Called for each item of the archive.
+       *
+       * @param item The item.
+       * @param data The (uncompressed) data of the item.
+       */
+      virtual void addItem(const Item& item, const Blob& data) = 0;
+
+      /** Called for each redirect entry of the archive.
+       *
+       * Redirects are ignored by default.
+       *
+       * @param entry The redirect entry.
+       */
+      virtual void addRedirect(const Entry& entry);
+
+      /** Called once all the entries have been given to the sink.
+       *
+       * It is not called if the extraction fails.
+       */
+      virtual void finish();
+  };
+
+  /**
+   * A sink writing each item to a file in a directory.
+   *
+   * The item's path is used as the file path relative to the directory.
+   * Intermediate directories are created as needed.
+   * Redirects are ignored.
+   *
+   * An exception is thrown if a path cannot be safely mapped in the directory
+   * (empty, `.` or `..` components) or if a file cannot be written
+   * (for example if a path is used both as an item and as a directory).
+   */
+  class LIBZIM_API DirectoryExtractSink : public ExtractSink
+  {
+    public:
+      /** DirectoryExtractSink constructor.
+       *
+       * @param directory The root directory. It is created if needed.
+       */
+      explicit DirectoryExtractSink(const std::string& directory);
+
+      void addItem(const Item& item, const Blob& data) override;
+
+    private:
+      void makeDirectories(const std::string& path);
+
+      std::string m_directory;
+      std::set<std::string> m_createdDirectories;
+  };
+
+  /**
+   * A sink writing the items in a tar stream.
+   *
+   * Items are stored as regular files and redirects as symbolic links to
+   * their (relative) target. Paths longer than the ustar limit are stored
+   * using the GNU long name extension.
+   */
+  class LIBZIM_API TarExtractSink : public ExtractSink
+  {
+    public:
+      /** TarExtractSink constructor.
+       *
+       * @param out The stream to write the tar to. It must outlive the sink.
+       */
+      explicit TarExtractSink(std::ostream& out);
+
+      void addItem(const Item& item, const Blob& data) override;
+      void addRedirect(const Entry& entry) override;
+
+      /** Write the end of archive marker. */
+      void finish() override;
+
+    private:
+      void writeHeader(const std::string& path, char type, size_type size, const std::string& linkTarget);
+      void writeLongName(char type, const std::string& name);
+      void writePadding(size_type size);
+
+      std::ostream& m_out;
+  };
+
+  /**
+   * A sink forwarding the items to a user function.
+   */
+  class LIBZIM_API CallbackExtractSink : public ExtractSink
+  {
+    public:
+      typedef std::function<void(const Item&, const Blob&)> Callback;
+
+      explicit CallbackExtractSink(Callback callback);
+
+      void addItem(const Item& item, const Blob& data) override;
+
+    private:
+      Callback m_callback;
+  };
+
+  /**
+   * Export all the items of an archive to a `ExtractSink`.
+   *
+   * The clusters of the archive are decompressed in parallel by a set of
+   * worker threads, each cluster being decompressed only once. The clusters
+   * are read without using (nor polluting) the cluster cache.
+   *
+   * The data waiting to be written by the sink is limited to
+   * `setMaxPendingSize()` bytes. When this limit is reached, the workers wait
+   * for the sink to catch up. On top of that, each worker holds at most one
+   * cluster.
+   *
+   * ```c++
+   *  std::ofstream out("archive.tar", std::ios::binary);
+   *  zim::TarExtractSink sink(out);
+   *  zim::Extractor(archive).setWorkerCount(4).extract(sink);
+   * ```
+   */
+  class LIBZIM_API Extractor
+  {
+    public:
+      /** Extractor constructor.
+       *
+       * @param archive The archive to extract.
+       */
+      explicit Extractor(const Archive& archive);
+
+      /** Set the number of worker threads decompressing the clusters.
+       *
+       * Default to the number of hardware threads.
+       *
+       * @param workerCount The number of workers (at least 1).
+       */
+      Extractor& setWorkerCount(unsigned workerCount);
+
+      /** Set the maximum size of data waiting to be written by the sink.
+       *
+       * An item bigger than this limit is still extracted, alone.
+       * Default to 64MiB.
+       *
+       * @param maxSize The maximum size in bytes.
+       */
+      Extractor& setMaxPendingSize(size_type maxSize);
+
+      /** Extract all the entries of the archive to `sink`.
+       *
+       * The method returns once all entries have been given to the sink and
+       * `sink.finish()` has been called.
+       * If the sink or a worker throws an exception, the extraction is stopped
+       * and the exception is rethrown.
+       *
+       * @param sink The sink to write the entries to.
+       */
+      void extract(ExtractSink& sink) const;
+
+    private:
+      Archive m_archive;
+      unsigned m_workerCount;
+      size_type m_maxPendingSize;
+  };
+}
+
+#endif // ZIM_EXTRACTOR_H
@@ -24,10 +24,63 @@
 #include "zim.h"
 #include "blob.h"
 #include "entry.h"
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace zim
 {
+  class IStreamReader;
+
+  /**
+   * A reader streaming the data of an `Item`.
+   *
+   * The only way to obtain an `ItemReader` is via `Item::getDataReader()`.
+   *
+   * Contrary to `Item::getData()`, the data is decompressed progressively
+   * while it is read, using a small bounded amount of memory, and the cluster
+   * containing the item is not stored in the cluster cache.
+   * This is useful to read big compressed items without loading them
+   * entirely in memory.
+   *
+   * The data of the items stored before the item in the same cluster still
+   * has to be decompressed (and dropped) when the reader is created.
+   *
+   * An `ItemReader` is not threadsafe.
+   */
+  class LIBZIM_API ItemReader
+  {
+    public: // functions
+      ItemReader(ItemReader&&);
+      ItemReader& operator=(ItemReader&&);
+      ~ItemReader();
+
+      /** Read the next bytes of the data.
+       *
+       * @param dest The buffer to write the data to.
+       * @param size The maximum number of bytes to read (size of `dest`).
+       * @return The number of bytes read. 0 if all the data has been read.
+       */
+      size_type read(char* dest, size_type size);
+
+      /** The size (in byte) of the data accessible through the reader.
+       */
+      size_type getSize() const { return m_size; }
+
+      /** The number of bytes remaining to read.
+       */
+      size_type getRemainingSize() const { return m_size - m_position; }
+
+    private: // functions
+      ItemReader(std::unique_ptr<IStreamReader> stream, size_type size);
+      friend class Item;
+
+    private: // data
+      std::unique_ptr<IStreamReader> mp_stream;
+      size_type m_size;
+      size_type m_position;
+  };
+
   /**
    * An `Item` in an `Archive`
    *
@@ -62,6 +115,43 @@ namespace zim
        */
       Blob getData(offset_type offset, size_type size) const;
 
+      /** Get the data associated to the item as a list of chunks
+       *
+       * Get the data of the item, starting at offset, as a list of blobs.
+       * Concatenated, the blobs give the same data as `getData(offset)`.
+       *
+       * Contrary to `getData()`, the data is never copied to be made
+       * contiguous (for example when the item is stored across several
+       * parts of a split archive). Each blob keeps its data valid as long as
+       * it lives. This is useful to write the data without copy
+       * (with `writev` for example).
+       *
+       * @param offset The number of byte to skip at beginning of the data.
+       * @return The blobs corresponding to the data (empty if there is no data).
+       */
+      std::vector<Blob> getDataChunks(offset_type offset=0) const;
+
+      /** Get the data associated to the item as a list of chunks
+       *
+       * Get the `size` bytes of data of the item, starting at offset,
+       * as a list of blobs.
+       *
+       * @param offset The number of byte to skip at beginning of the data.
+       * @param size The number of byte to read.
+       * @return The blobs corresponding to the data (empty if there is no data).
+       */
+      std::vector<Blob> getDataChunks(offset_type offset, size_type size) const;
+
+      /** Get a reader streaming the data associated to the item
+       *
+       * The data is read from the archive (and decompressed) progressively,
+       * without storing the whole data (nor its cluster) in memory.
+       *
+       * @param offset The number of byte to skip at beginning of the data.
+       * @return A reader on the data, starting at offset.
+       */
+      ItemReader getDataReader(offset_type offset=0) const;
+
       /** The size of the item.
        *
        * @return The size (in byte) of the item.
@@ -83,6 +173,20 @@ namespace zim
        */
       zim::ItemDataDirectAccessInfo getDirectAccessInformation() const;
 
+      /** Direct access information through an opened file descriptor.
+       *
+       * Same as `getDirectAccessInformation()` but give the (already opened)
+       * file descriptor instead of the filename. This avoids to reopen the
+       * file and allows to send the content with `sendfile`/`splice`.
+       *
+       * This is not available on Windows.
+       *
+       * @return The file descriptor, offset and size of the content.
+       *         If it is not possible to have direct access for this item,
+       *         return an invalid `ItemDataDirectFdAccessInfo`.
+       */
+      zim::ItemDataDirectFdAccessInfo getDirectFdAccessInformation() const;
+
       entry_index_type getIndex() const   { return Entry::getIndex(); }
 
 #ifdef ZIM_PRIVATE
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_SCRUBBER_H
+#define ZIM_SCRUBBER_H
+
+#include "archive.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace zim
+{
+  /**
+   * A background service reading a whole archive to detect corruptions.
+   *
+   * The scrubber walks the directory entries and then all the clusters of
+   * an archive in a background thread, at a limited pace, so that it can
+   * run on archives being served without disturbing them:
+   * - the reading rate is limited to a number of bytes per second,
+   * - the scrubbing thread uses the idle I/O scheduling class (Linux only),
+   * - optionally, the pages read only for the scrubbing are dropped from
+   *   the system page cache once checked (POSIX only).
+   *
+   * The directory entries and clusters read by the scrubber are not put in
+   * the libzim caches.
+   *
+   * Clusters having a checksum stored in the archive are checked against
+   * it. The other ones are parsed and decompressed.
+   *
+   * Errors do not stop the scrubbing, they are reported to the error
+   * callback.
+   */
+  class LIBZIM_API Scrubber
+  {
+    public:
+      /** Called with the number of bytes scrubbed so far and the total. */
+      typedef std::function<void(size_type scrubbedSize, size_type totalSize)> ProgressCallback;
+
+      /** Called with a description of each corruption found. */
+      typedef std::function<void(const std::string& error)> ErrorCallback;
+
+      /** Scrubber constructor.
+       *
+       * @param archive The archive to scrub.
+       */
+      explicit Scrubber(const Archive& archive);
+
+      /** Stop the scrubbing (if running) and wait for it. */
+      ~Scrubber();
+
+      Scrubber(const Scrubber&) = delete;
+      Scrubber& operator=(const Scrubber&) = delete;
+
+      /** Set the maximum reading rate (default 16MiB/s).
+       *
+       * 0 means no limit.
+       */
+      Scrubber& setBytesPerSecond(size_type bytesPerSecond);
+
+      /** Use the idle I/O scheduling class (default true). */
+      Scrubber& setLowIoPriority(bool lowIoPriority);
+
+      /** Drop the scrubbed clusters from the page cache (default false).
+       *
+       * Only the pages which were not already in the page cache before being
+       * scrubbed are dropped, so the pages used by the readers stay cached.
+       */
+      Scrubber& setDropPageCache(bool dropPageCache);
+
+      /** Set the progress callback, called from the scrubbing thread. */
+      Scrubber& setProgressCallback(ProgressCallback callback);
+
+      /** Set the error callback, called from the scrubbing thread. */
+      Scrubber& setErrorCallback(ErrorCallback callback);
+
+      /** Start scrubbing the archive in a background thread.
+       *
+       * The settings cannot be changed while scrubbing.
+       * Throws `std::logic_error` if the scrubber is already running.
+       */
+      void start();
+
+      /** Interrupt the scrubbing and wait for the thread to finish. */
+      void stop();
+
+      /** Wait for the scrubbing to finish. */
+      void wait();
+
+      /** Check if the scrubbing thread is running. */
+      bool isRunning() const;
+
+      /** The number of errors found by the last (or current) scrubbing. */
+      size_type getErrorCount() const;
+
+    private:
+      struct State;
+
+      Archive m_archive;
+      size_type m_bytesPerSecond;
+      bool m_lowIoPriority;
+      bool m_dropPageCache;
+      ProgressCallback m_progressCallback;
+      ErrorCallback m_errorCallback;
+      std::unique_ptr<State> mp_state;
+  };
+}
+
+#endif // ZIM_SCRUBBER_H
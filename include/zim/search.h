@@ -29,7 +29,7 @@
 
 namespace Xapian {
   class Enquire;
-  class MSet;
+  class Query;
 };
 
 namespace zim
@@ -40,6 +40,42 @@ class InternalDataBase;
 class Query;
 class Search;
 class SearchResultSet;
+struct SearchResults;
+class SnippetHighlighter;
+class ThreadPool;
+
+/** Get the maximum size of the search result cache.
+ *
+ * The search result cache is shared by all the searchers. It keeps the
+ * results of the recent searches (for a given query, set of archives and
+ * range of results) so that repeated searches don't run the query again.
+ *
+ * @return The maximum memory size used by the search result cache.
+ */
+size_t LIBZIM_API getSearchResultCacheMaxSize();
+
+/** Get the current size of the search result cache.
+ *
+ * @return The current memory size used by the search result cache.
+ */
+size_t LIBZIM_API getSearchResultCacheCurrentSize();
+
+/** Set the size of the search result cache.
+ *
+ * If the new size is lower than the size of the currently stored results
+ * some results will be dropped from cache to respect the new size.
+ * A size of 0 disables the cache.
+ *
+ * @param sizeInB The memory limit (in bytes) for the search result cache.
+ */
+void LIBZIM_API setSearchResultCacheMaxSize(size_t sizeInB);
+
+#ifdef ZIM_PRIVATE
+/** Get the current size of the cache of the texts used to generate the
+ * snippets of the search results.
+ */
+size_t LIBZIM_API getSnippetSourceCacheCurrentSize();
+#endif
 
 /**
  * A Searcher is a object fulltext searching a set of Archives
@@ -97,6 +133,33 @@ class LIBZIM_API Searcher
      */
     void setVerbose(bool verbose);
 
+    /** Search the archives separately and in parallel.
+     *
+     * By default, all the archives are searched at once through a combined
+     * database, in the calling thread. In parallel mode, each archive is
+     * searched on its own by a pool of threads and the best results of all
+     * archives are merged by relevance.
+     *
+     * The relevance of a result is computed with the statistics of its own
+     * archive only, so the order of the results may differ from the
+     * default mode.
+     *
+     * Already created searches are not affected.
+     *
+     * @param nbThreads The number of threads to use (0 for the default mode).
+     */
+    void setParallelSearch(unsigned nbThreads);
+
+    /** Set the time limit of the search of one archive in parallel mode.
+     *
+     * When an archive is not searched within the limit, it only contributes
+     * the results found so far and the result set is marked as incomplete
+     * (see `SearchResultSet::isComplete()`).
+     *
+     * @param milliseconds The time limit (0 for no limit).
+     */
+    void setArchiveTimeout(unsigned milliseconds);
+
   private: // methods
     void initDatabase();
 
@@ -104,6 +167,10 @@ class LIBZIM_API Searcher
     std::shared_ptr<InternalDataBase> mp_internalDb;
     std::vector<Archive> m_archives;
     bool m_verbose;
+    // The pool searching the archives in parallel mode (shared with the
+    // searches created by this searcher).
+    std::shared_ptr<ThreadPool> mp_searchPool;
+    unsigned m_archiveTimeout;
 };
 
 /**
@@ -169,20 +236,45 @@ class LIBZIM_API Search
          */
         const SearchResultSet getResults(int start, int maxResults) const;
 
+        /** Get a set of results for this search.
+         *
+         * The estimation of the number of results (see
+         * `SearchResultSet::getEstimatedMatches()`) is computed in the same
+         * pass. Checking more documents makes it more accurate but slower.
+         *
+         * @param start The beginning of the range to get
+         *              (offset of the first result).
+         * @param maxResults The maximum number of results to return
+         *                   (offset of last result from the start of range).
+         * @param checkAtLeast The minimum number of documents to check
+         *                     (at least `start + maxResults` are checked).
+         */
+        const SearchResultSet getResults(int start, int maxResults, int checkAtLeast) const;
+
         /** Get the number of estimated results for this search.
          *
          * As the name suggest, it is a estimation of the number of results.
+         *
+         * If results covering at least 10 documents have already been
+         * fetched from this search, their estimation is returned without
+         * running the search again.
          */
         int getEstimatedMatches() const;
 
     private: // methods
-        Search(std::shared_ptr<InternalDataBase> p_internalDb, const Query& query);
+        Search(std::shared_ptr<InternalDataBase> p_internalDb, const Query& query,
+               std::shared_ptr<ThreadPool> p_searchPool = nullptr, unsigned archiveTimeout = 0);
         Xapian::Enquire& getEnquire() const;
+        std::shared_ptr<const SearchResults> getCachedResults(int start, int maxResults, int checkAtLeast) const;
+        std::shared_ptr<const SearchResults> runParallelSearch(int start, int maxResults, int checkAtLeast) const;
 
     private: // data
          std::shared_ptr<InternalDataBase> mp_internalDb;
          mutable std::unique_ptr<Xapian::Enquire> mp_enquire;
          Query m_query;
+         std::shared_ptr<ThreadPool> mp_searchPool;
+         unsigned m_archiveTimeout;
+         mutable std::shared_ptr<const SearchResults> mp_lastResults;
 
   friend class Searcher;
 };
@@ -206,13 +298,31 @@ class LIBZIM_API SearchResultSet
     /** The size of the SearchResult (end()-begin()) */
     int size() const;
 
+    /** The number of estimated results of the search.
+     *
+     * This is the estimation made while fetching this set of results.
+     */
+    int getEstimatedMatches() const;
+
+    /** Whether all the archives have been fully searched.
+     *
+     * A parallel search (see `Searcher::setParallelSearch()`) returns
+     * partial results when the search of some archives failed or timed
+     * out.
+     */
+    bool isComplete() const;
+
   private:
-    SearchResultSet(std::shared_ptr<InternalDataBase> p_internalDb, Xapian::MSet&& mset);
+    SearchResultSet(std::shared_ptr<InternalDataBase> p_internalDb,
+                    std::shared_ptr<const SearchResults> p_results,
+                    const Xapian::Query& query);
     SearchResultSet(std::shared_ptr<InternalDataBase> p_internalDb);
 
   private: // data
     std::shared_ptr<InternalDataBase> mp_internalDb;
-    std::shared_ptr<Xapian::MSet> mp_mset;
+    std::shared_ptr<const SearchResults> mp_results;
+    // Shared by the iterators of the result set.
+    std::shared_ptr<SnippetHighlighter> mp_highlighter;
   friend class Search;
 };
 
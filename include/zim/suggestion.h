@@ -52,8 +52,14 @@ class SuggestionDataBase;
  * `SuggestionSearch` Internally. This is a wrapper around a
  * SuggestionDataBase which may or may not include a Xapian title
  * index (it is optional in the ZIM specification). If the underlying
- * index does not exist, then it will fallback on
- * `zim::Archive::findByTitle` (with all its limitations).
+ * index does not exist, then it will fallback on a case and accent
+ * insensitive match of the title prefix if the archive contains a
+ * folded title listing, or on `zim::Archive::findByTitle` (with all
+ * its limitations) for older archives.
+ *
+ * If the archive contains precomputed suggestions for short title
+ * prefixes (see `zim::writer::Creator::configPrefixSuggestions`),
+ * those prefixes are answered with a single lookup in them.
  *
  * The underlying Xapian index includes the very same entry titles
  * like for `zim::Archive::findByTitle`, ie. the one declared as
@@ -95,6 +101,21 @@ class LIBZIM_API SuggestionSearcher
      */
     void setVerbose(bool verbose);
 
+    /** Suggest with an in-memory index of the title prefixes.
+     *
+     * Instead of the xapian title index (or `Archive::findByTitle`), the
+     * suggestions are the titles starting with the query (ignoring case and
+     * accents), shortest titles first. Short queries are answered as fast
+     * as long ones.
+     *
+     * The index is built from all the titles of the archive on first use
+     * (and shared by all the SuggestionSearchers of the archive), so it
+     * takes some time and memory for big archives.
+     *
+     * @param usePrefixIndex Whether to use the index.
+     */
+    void setUsePrefixIndex(bool usePrefixIndex);
+
   private: // methods
     void initDatabase();
 
@@ -102,6 +123,7 @@ class LIBZIM_API SuggestionSearcher
     std::shared_ptr<SuggestionDataBase> mp_internalDb;
     Archive m_archive;
     bool m_verbose;
+    bool m_usePrefixIndex;
 };
 
 /**
@@ -159,8 +181,8 @@ class LIBZIM_API SuggestionSearch
  * `SuggestionSearch`.
  *
  * Its purpose is to provide uniform interface for iterating over the suggestion
- * results for various sources of suggestion data (Xapian title index or title
- * ordered listing in the absence of the former).
+ * results for various sources of suggestion data (Xapian title index, title
+ * prefix index or title ordered listing in the absence of the former).
  */
 class LIBZIM_API SuggestionResultSet
 {
@@ -183,10 +205,13 @@ class LIBZIM_API SuggestionResultSet
 
   private: // functions
     explicit SuggestionResultSet(EntryRange entryRange);
+    SuggestionResultSet(SuggestionDBPtr p_internalDb, std::vector<entry_index_type>&& entries);
 
   private: // data
     SuggestionDBPtr mp_internalDb;
     std::shared_ptr<EntryRange> mp_entryRange;
+    // Results of the title prefix index
+    std::shared_ptr<const std::vector<entry_index_type>> mp_entries;
 
   friend class SuggestionSearch;
 
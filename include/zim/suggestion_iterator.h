@@ -100,8 +100,8 @@ class LIBZIM_API SuggestionIterator
 
         class Impl;
 
-        // Main (xapian-based) implementation; is null if no title index is
-        // available or libzim is built without Xapian
+        // Main (xapian or title prefix index based) implementation; is null
+        // if no such index is available or libzim is built without Xapian
         std::unique_ptr<Impl> mp_impl;
 
     private: // methods
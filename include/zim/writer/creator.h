@@ -133,6 +133,44 @@ namespace zim
          */
         Creator& configIndexing(bool indexing, const std::string& language);
 
+        /**
+         * Configure the storage of search snippets in the fulltext index.
+         *
+         * If enabled, an excerpt of the indexed text of each item is stored
+         * in the fulltext index. Search snippets are then generated from this
+         * excerpt, without reading (and decompressing) the item content.
+         *
+         * @param maxSize The maximum size (in bytes) of the stored excerpts.
+         *                0 (the default) disables the feature.
+         * @return a reference to itself.
+         */
+        Creator& configSearchSnippets(zim::size_type maxSize);
+
+        /**
+         * Configure the precomputed suggestions of short title prefixes.
+         *
+         * If enabled, the first suggestions of the xapian title index for
+         * the prefixes of one to three characters of the title words (as
+         * written and case folded) are stored in the archive. Readers using
+         * the title index answer these queries, the most common and expensive
+         * ones, with a single lookup as long as the requested results are
+         * stored. They search the index for the next ones, which are ranked
+         * the same way. The stored suggestions have no snippet.
+         *
+         * The prefixes are kept by length, then by number of matching titles,
+         * until the listing reaches `maxSize`.
+         *
+         * This needs the xapian title index and an indexing language (see
+         * `configIndexing`): no suggestions are stored without them.
+         *
+         * @param nbSuggestions The number of titles stored per prefix
+         *                      (at most 255). 0 (the default) disables the
+         *                      feature.
+         * @param maxSize The maximum size (in bytes) of the stored listing.
+         * @return a reference to itself.
+         */
+        Creator& configPrefixSuggestions(unsigned nbSuggestions, zim::size_type maxSize);
+
         /**
          * Set the number of thread to use for the internal worker.
          *
@@ -315,6 +353,9 @@ namespace zim
         bool m_withIndex = false;
         size_t m_clusterSize;
         std::string m_indexingLanguage;
+        zim::size_type m_snippetSize = 0;
+        unsigned m_nbPrefixSuggestions = 0;
+        zim::size_type m_prefixSuggestionsSize = 0;
         unsigned m_nbWorkers = 4;
 
         // zim data
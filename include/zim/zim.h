@@ -23,6 +23,8 @@
 #define ZIM_ZIM_H
 
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 
 #ifdef __GNUC__
@@ -78,6 +80,7 @@ namespace zim
       *
       * - Dirent ranges is activated.
       * - Xapian preloading is activated.
+      * - Lazy opening is deactivated.
       */
      OpenConfig();
 
@@ -127,8 +130,37 @@ namespace zim
        return OpenConfig(*this).preloadDirentRanges(nbRanges);
      }
 
+     /**
+      * Configure lazy opening.
+      *
+      * In lazy mode, only the header of the archive is read and validated
+      * when the archive is opened. Everything else (dirent and cluster
+      * pointer tables, title index, mime types, dirent ranges, xapian
+      * database) is loaded on first access to the archive content.
+      *
+      * This makes opening a large number of archives cheap, at the price
+      * of reporting a corrupted archive only at first use.
+      * Xapian preloading is ignored in lazy mode.
+      *
+      * This method modifies the configuration and returns itself.
+      */
+     OpenConfig& lazyOpen(bool lazy) {
+       m_lazyOpen = lazy;
+       return *this;
+     }
+
+     /**
+      * Configure lazy opening.
+      *
+      * This method creates a new configuration with the new value.
+      */
+     OpenConfig lazyOpen(bool lazy) const {
+       return OpenConfig(*this).lazyOpen(lazy);
+     }
+
      bool m_preloadXapianDb;
      int  m_preloadDirentRanges;
+     bool m_lazyOpen;
   };
 
   struct FdInput {
@@ -197,6 +229,12 @@ namespace zim
      */
     DIRENT_MIMETYPES,
 
+    /**
+     * Checks the clusters against the checksums stored in the archive
+     * (if any).
+     */
+    CLUSTER_CHECKSUMS,
+
     ////////////////////////////////////////////////////////////////////////////
     // End of integrity check types.
     // COUNT must be the last one and denotes the count of all checks
@@ -209,6 +247,15 @@ namespace zim
     COUNT
   };
 
+  /**
+   * Progress callback of the integrity checks.
+   *
+   * It is called with the check being run, the number of items (entries,
+   * clusters, ...) already checked and the total number of items to check.
+   * Returning false cancels the check.
+   */
+  typedef std::function<bool(IntegrityCheck check, size_type checked, size_type total)> IntegrityCheckProgress;
+
   /**
    * Information needed to directly access to an item data, bypassing libzim library.
    *
@@ -245,6 +292,56 @@ namespace zim
       return !filename.empty();
      }
   };
+
+  /**
+   * Information needed to directly access to an item data through an already
+   * opened file descriptor.
+   *
+   * Contrary to `ItemDataDirectAccessInfo`, there is no need to reopen the
+   * file. The file descriptor can be directly used with `sendfile`, `splice`
+   * or `pread` to send the item data without copy.
+   *
+   * The file descriptor is owned by libzim and must not be closed by the user.
+   * It stays opened as long as `fd` (or one of its copies) is alive, even if
+   * the archive is destroyed. As the file descriptor is shared, only
+   * positional functions (taking an offset) must be used on it.
+   */
+  struct ItemDataDirectFdAccessInfo {
+
+     /**
+      * The (shared) opened file descriptor.
+      */
+     std::shared_ptr<const int> fd;
+
+     /**
+      * The offset of the data in the file.
+      */
+     offset_type offset;
+
+     /**
+      * The size of the data.
+      */
+     size_type size;
+
+     explicit ItemDataDirectFdAccessInfo()
+       : fd(),
+         offset(),
+         size()
+     {}
+
+     ItemDataDirectFdAccessInfo(std::shared_ptr<const int> fd, offset_type offset, size_type size)
+       : fd(fd),
+         offset(offset),
+         size(size)
+     {}
+
+     /**
+      * Return if the ItemDataDirectFdAccessInfo is valid
+      */
+     bool isValid() const {
+      return bool(fd);
+     }
+  };
 }
 
 #endif // ZIM_ZIM_H
@@ -26,6 +26,11 @@
 #include <zim/error.h>
 #include <zim/tools.h>
 #include "fileimpl.h"
+#include "_dirent.h"
+#include "cluster.h"
+#include "fd_pool.h"
+#include "buffer_arena.h"
+#include "thread_pool.h"
 #include "tools.h"
 #include "log.h"
 
@@ -36,7 +41,8 @@ namespace zim
   OpenConfig::OpenConfig()
     :
         m_preloadXapianDb(true),
-        m_preloadDirentRanges(DIRENT_LOOKUP_CACHE_SIZE)
+        m_preloadDirentRanges(DIRENT_LOOKUP_CACHE_SIZE),
+        m_lazyOpen(false)
     { }
 
   Archive::Archive(const std::string& fname)
@@ -383,6 +389,112 @@ namespace zim
     }
   }
 
+  namespace
+  {
+    // The request is destroyed before the result is made available, so the
+    // archive is not kept alive by the pool once the caller gets the data.
+    template<class F>
+    Blob runRequest(std::shared_ptr<F>& request)
+    {
+      const auto localRequest = std::move(request);
+      return (*localRequest)();
+    }
+
+    template<class F>
+    std::future<Blob> runAsync(F f)
+    {
+      auto promise = std::make_shared<std::promise<Blob>>();
+      auto future = promise->get_future();
+      auto request = std::make_shared<F>(std::move(f));
+      ThreadPool::asyncPool().submit([promise, request]() mutable {
+        try {
+          promise->set_value(runRequest(request));
+        } catch (...) {
+          promise->set_exception(std::current_exception());
+        }
+      });
+      return future;
+    }
+
+    template<class F>
+    void runAsync(F f, ItemDataCallback callback)
+    {
+      auto request = std::make_shared<F>(std::move(f));
+      ThreadPool::asyncPool().submit([request, callback]() mutable {
+        Blob data;
+        std::exception_ptr error;
+        try {
+          data = runRequest(request);
+        } catch (...) {
+          error = std::current_exception();
+        }
+        try {
+          callback(data, error);
+        } catch (...) {
+          log_error("Item data callback has thrown an exception");
+        }
+      });
+    }
+  }
+
+  std::future<Blob> Archive::getItemDataAsync(const Entry& entry) const
+  {
+    return runAsync([entry]() { return entry.getItem(true).getData(); });
+  }
+
+  void Archive::getItemDataAsync(const Entry& entry, ItemDataCallback callback) const
+  {
+    runAsync([entry]() { return entry.getItem(true).getData(); }, std::move(callback));
+  }
+
+  std::future<Blob> Archive::getItemDataByPathAsync(const std::string& path) const
+  {
+    const Archive archive(*this);
+    return runAsync([archive, path]() { return archive.getEntryByPath(path).getItem(true).getData(); });
+  }
+
+  void Archive::getItemDataByPathAsync(const std::string& path, ItemDataCallback callback) const
+  {
+    const Archive archive(*this);
+    runAsync([archive, path]() { return archive.getEntryByPath(path).getItem(true).getData(); }, std::move(callback));
+  }
+
+  bool Archive::tryGetItemData(const Entry& entry, Blob& data, bool loadInBackground) const
+  {
+    const auto file = entry.getFileImpl();
+    auto dirent = entry.getDirent();
+    auto watchdog = 50U;
+    while (dirent && dirent->isRedirect() && --watchdog) {
+      dirent = file->getCachedDirent(dirent->getRedirectIndex());
+    }
+    if (!watchdog) {
+      // Too long chain of redirections. There is nothing to load: a
+      // blocking access will report the error.
+      return false;
+    }
+
+    const auto cluster = dirent ? file->getCachedCluster(dirent->getClusterNumber()) : nullptr;
+    if (cluster && cluster->tryGetBlob(dirent->getBlobNumber(), data)) {
+      return true;
+    }
+
+    if (loadInBackground && (!cluster || cluster->isCompressed())) {
+      ThreadPool::asyncPool().submit([entry]() {
+        try {
+          const auto item = entry.getItem(true);
+          const auto cluster = entry.getFileImpl()->getCluster(cluster_index_t(item.getClusterIndex()));
+          if (cluster->isCompressed()) {
+            // Decompress the blob now so that the next call finds it ready.
+            cluster->getBlob(blob_index_t(item.getBlobIndex()));
+          }
+        } catch (...) {
+          // The error will be reported to the next blocking access.
+        }
+      });
+    }
+    return false;
+  }
+
   bool Archive::hasFulltextIndex() const {
     auto r = m_impl->findx('X', "fulltext/xapian");
     if (!r.first) {
@@ -445,6 +557,19 @@ namespace zim
     return EntryRange<EntryOrder::efficientOrder>(m_impl, 0, getEntryCount());
   }
 
+  std::vector<Archive::EntryRange<EntryOrder::efficientOrder>> Archive::partitionByCluster(size_t partCount) const
+  {
+    std::vector<EntryRange<EntryOrder::efficientOrder>> ranges;
+    if (partCount == 0) {
+      return ranges;
+    }
+    const auto boundaries = m_impl->getClusterOrderPartitions(partCount);
+    for (size_t i = 0; i < partCount; ++i) {
+      ranges.emplace_back(m_impl, boundaries[i], boundaries[i+1]);
+    }
+    return ranges;
+  }
+
   Archive::EntryRange<EntryOrder::pathOrder> Archive::findByPath(std::string path) const
   {
     // "url order" means that the entries are stored by long url ("NS/url)".
@@ -579,6 +704,66 @@ namespace zim
     getClusterCache().setMaxCost(sizeInB);
   }
 
+  unsigned getAsyncThreadCount()
+  {
+    return ThreadPool::asyncPool().getThreadCount();
+  }
+
+  void setAsyncThreadCount(unsigned threadCount)
+  {
+    ThreadPool::asyncPool().setThreadCount(threadCount);
+  }
+
+  size_t getFdPoolMaxSize()
+  {
+    return FdPool::instance().getMaxSize();
+  }
+
+  size_t getFdPoolCurrentSize()
+  {
+    return FdPool::instance().getCurrentSize();
+  }
+
+  void setFdPoolMaxSize(size_t maxSize)
+  {
+    FdPool::instance().setMaxSize(maxSize);
+  }
+
+  size_t getFdPoolHitCount()
+  {
+    return FdPool::instance().getHitCount();
+  }
+
+  size_t getFdPoolMissCount()
+  {
+    return FdPool::instance().getMissCount();
+  }
+
+  void setClusterBufferAllocator(std::shared_ptr<ClusterBufferAllocator> allocator)
+  {
+    setClusterDataAllocator(allocator);
+  }
+
+  ClusterBufferArenaStats getClusterBufferArenaStats()
+  {
+    return getDefaultBufferArena().getStats();
+  }
+
+  size_t getClusterBufferArenaMaxCachedSize()
+  {
+    return getDefaultBufferArena().getMaxCachedSize();
+  }
+
+  void setClusterBufferArenaMaxCachedSize(size_t sizeInB)
+  {
+    getDefaultBufferArena().setMaxCachedSize(sizeInB);
+  }
+
+  void setClusterBufferArenaUseHugePages(bool useHugePages)
+  {
+    getDefaultBufferArena().setUseHugePages(useHugePages);
+  }
+
   size_t Archive::getDirentCacheMaxSize() const
   {
     return m_impl->getDirentCacheMaxSize();
@@ -635,14 +820,34 @@ namespace zim
     return m_impl->checkIntegrity(checkType);
   }
 
+  bool Archive::checkIntegrity(IntegrityCheck checkType, unsigned threadCount, const IntegrityCheckProgress& progress)
+  {
+    return m_impl->checkIntegrity(checkType, threadCount, progress);
+  }
+
+  bool Archive::hasClusterChecksums() const
+  {
+    return m_impl->getChecksummedClusterCount().v != 0;
+  }
+
+  bool Archive::verifyItemData(const Item& item) const
+  {
+    return m_impl->checkClusterChecksum(cluster_index_t(item.getClusterIndex()));
+  }
+
   bool validate(const std::string& zimPath, IntegrityCheckList checksToRun)
+  {
+    return validate(zimPath, checksToRun, 1);
+  }
+
+  bool validate(const std::string& zimPath, IntegrityCheckList checksToRun, unsigned threadCount, const IntegrityCheckProgress& progress)
   {
     try
     {
       Archive a(zimPath);
       for ( size_t i = 0; i < checksToRun.size(); ++i )
       {
-        if ( checksToRun.test(i) && !a.checkIntegrity(IntegrityCheck(i)) )
+        if ( checksToRun.test(i) && !a.checkIntegrity(IntegrityCheck(i), threadCount, progress) )
           return false;
       }
     }
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include "buffer_arena.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#  include <sys/mman.h>
+#endif
+
+namespace zim {
+
+namespace
+{
+
+// Keep 32MiB of freed buffers for reuse by default.
+const size_t DEFAULT_MAX_CACHED_SIZE = 32*1024*1024;
+
+bool isMmapped(size_t roundedSize)
+{
+#ifdef __linux__
+  return roundedSize >= BufferArena::MIN_MMAPPED_SIZE;
+#else
+  return false;
+#endif
+}
+
+bool isRecycled(size_t roundedSize)
+{
+  return roundedSize >= BufferArena::MIN_RECYCLED_SIZE
+      && roundedSize <= BufferArena::MAX_RECYCLED_SIZE;
+}
+
+std::shared_ptr<BufferArena> defaultArena()
+{
+  static const auto arena = std::make_shared<BufferArena>(DEFAULT_MAX_CACHED_SIZE);
+  return arena;
+}
+
+// The allocator of the cluster data. Always accessed with the atomic
+// shared_ptr functions, as it is read at each cluster load.
+std::shared_ptr<ClusterBufferAllocator>& allocatorSlot()
+{
+  static std::shared_ptr<ClusterBufferAllocator> allocator = defaultArena();
+  return allocator;
+}
+
+std::shared_ptr<ClusterBufferAllocator> currentAllocator()
+{
+  return std::atomic_load_explicit(&allocatorSlot(), std::memory_order_acquire);
+}
+
+} // unnamed namespace
+
+BufferArena::BufferArena(size_t maxCachedSize)
+  : m_maxCachedSize(maxCachedSize),
+    m_useHugePages(false),
+    m_stats()
+{}
+
+BufferArena::~BufferArena()
+{
+  for (auto& sizeClass : m_freeBlocks) {
+    for (auto data : sizeClass.second) {
+      release(data, sizeClass.first);
+    }
+  }
+}
+
+size_t BufferArena::roundSize(size_t size)
+{
+  if (size <= MIN_RECYCLED_SIZE || size > MAX_RECYCLED_SIZE) {
+    return size;
+  }
+  // Round up to a quarter of the power of two just below size.
+  size_t powerOfTwo = MIN_RECYCLED_SIZE;
+  while (powerOfTwo*2 < size) {
+    powerOfTwo *= 2;
+  }
+  const size_t quarter = powerOfTwo / 4;
+  return (size + quarter - 1) / quarter * quarter;
+}
+
+char* BufferArena::allocate(size_t size)
+{
+  const auto roundedSize = roundSize(size);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.allocationCount++;
+    m_stats.usedSize += roundedSize;
+    auto it = m_freeBlocks.find(roundedSize);
+    if (it != m_freeBlocks.end() && !it->second.empty()) {
+      auto data = it->second.back();
+      it->second.pop_back();
+      m_stats.cachedSize -= roundedSize;
+      m_stats.reuseCount++;
+      return data;
+    }
+  }
+  try {
+    return allocateNew(roundedSize);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.usedSize -= roundedSize;
+    throw;
+  }
+}
+
+void BufferArena::deallocate(char* data, size_t size)
+{
+  const auto roundedSize = roundSize(size);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.usedSize -= roundedSize;
+    if (isRecycled(roundedSize) && m_stats.cachedSize + roundedSize <= m_maxCachedSize) {
+      try {
+        m_freeBlocks[roundedSize].push_back(data);
+        m_stats.cachedSize += roundedSize;
+        return;
+      } catch (...) {
+        // We are called from a destructor, we cannot throw.
+        // Simply don't keep the block.
+      }
+    }
+  }
+  release(data, roundedSize);
+}
+
+char* BufferArena::allocateNew(size_t roundedSize)
+{
+#ifdef __linux__
+  if (isMmapped(roundedSize)) {
+    void* data = mmap(nullptr, roundedSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    bool useHugePages;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      useHugePages = m_useHugePages;
+    }
+    if (useHugePages) {
+      // This is only an advice. We don't care if it fails.
+      madvise(data, roundedSize, MADV_HUGEPAGE);
+    }
+#endif
+    return static_cast<char*>(data);
+  }
+#endif
+  return new char[roundedSize];
+}
+
+void BufferArena::release(char* data, size_t roundedSize)
+{
+#ifdef __linux__
+  if (isMmapped(roundedSize)) {
+    munmap(data, roundedSize);
+    return;
+  }
+#endif
+  delete[] data;
+}
+
+ClusterBufferArenaStats BufferArena::getStats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+size_t BufferArena::getMaxCachedSize() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_maxCachedSize;
+}
+
+void BufferArena::setMaxCachedSize(size_t maxCachedSize)
+{
+  std::vector<std::pair<char*, size_t>> toRelease;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxCachedSize = maxCachedSize;
+    // Drop the biggest blocks first, they are the less likely to be reused.
+    std::vector<size_t> sizes;
+    for (const auto& sizeClass : m_freeBlocks) {
+      sizes.push_back(sizeClass.first);
+    }
+    std::sort(sizes.rbegin(), sizes.rend());
+    for (auto size : sizes) {
+      auto& blocks = m_freeBlocks[size];
+      while (m_stats.cachedSize > m_maxCachedSize && !blocks.empty()) {
+        toRelease.emplace_back(blocks.back(), size);
+        blocks.pop_back();
+        m_stats.cachedSize -= size;
+      }
+    }
+  }
+  for (const auto& block : toRelease) {
+    release(block.first, block.second);
+  }
+}
+
+void BufferArena::setUseHugePages(bool useHugePages)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_useHugePages = useHugePages;
+}
+
+BufferArena& getDefaultBufferArena()
+{
+  return *defaultArena();
+}
+
+void setClusterDataAllocator(std::shared_ptr<ClusterBufferAllocator> allocator)
+{
+  if (!allocator) {
+    allocator = defaultArena();
+  }
+  std::atomic_store_explicit(&allocatorSlot(), allocator, std::memory_order_release);
+}
+
+Buffer makeClusterDataBuffer(zsize_t size)
+{
+  if (size.v == 0) {
+    return Buffer::makeBuffer(size);
+  }
+  // The buffer keeps the allocator alive, as it may be changed in between.
+  const auto allocator = currentAllocator();
+  const size_t dataSize = size.v;
+  char* data = allocator->allocate(dataSize);
+  const auto deleter = [allocator, dataSize](const char* p) {
+    allocator->deallocate(const_cast<char*>(p), dataSize);
+  };
+  return Buffer::makeBuffer(Buffer::DataPtr(data, deleter), size);
+}
+
+};
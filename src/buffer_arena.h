@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_BUFFER_ARENA_H_
+#define ZIM_BUFFER_ARENA_H_
+
+#include <zim/archive.h>
+
+#include "buffer.h"
+#include "config.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace zim {
+
+/** The default allocator of the decompressed cluster data.
+ *
+ * Freed buffers are kept (up to a maximum total size) in free lists by size
+ * class and are reused by the next allocations of the same class. This avoids
+ * going through malloc/free for each cluster load and eviction.
+ *
+ * Sizes are rounded up to a quarter of their power of two (so at most 25% is
+ * wasted). Small buffers are not recycled. Big buffers are directly mmapped
+ * (on Linux), optionally advising the kernel to back them with huge pages.
+ */
+class LIBZIM_PRIVATE_API BufferArena : public ClusterBufferAllocator {
+  public: // constants
+    static const size_t MIN_RECYCLED_SIZE = 4*1024;
+    static const size_t MAX_RECYCLED_SIZE = 256*1024*1024;
+    static const size_t MIN_MMAPPED_SIZE = 2*1024*1024;
+
+  public: // functions
+    explicit BufferArena(size_t maxCachedSize);
+    ~BufferArena();
+
+    char* allocate(size_t size) override;
+    void deallocate(char* data, size_t size) override;
+
+    ClusterBufferArenaStats getStats() const;
+    size_t getMaxCachedSize() const;
+    void setMaxCachedSize(size_t maxCachedSize);
+    void setUseHugePages(bool useHugePages);
+
+    static size_t roundSize(size_t size);
+
+  private: // functions
+    char* allocateNew(size_t roundedSize);
+    void release(char* data, size_t roundedSize);
+
+  private: // data
+    mutable std::mutex m_mutex;
+    std::unordered_map<size_t, std::vector<char*>> m_freeBlocks;
+    size_t m_maxCachedSize;
+    bool m_useHugePages;
+    ClusterBufferArenaStats m_stats;
+};
+
+// The arena used when no custom allocator is set.
+BufferArena& getDefaultBufferArena();
+
+// Set the allocator used for decompressed cluster data.
+// nullptr restores the default arena.
+void setClusterDataAllocator(std::shared_ptr<ClusterBufferAllocator> allocator);
+
+// Allocate a buffer for decompressed cluster data with the current allocator.
+Buffer makeClusterDataBuffer(zsize_t size);
+
+};
+
+#endif // ZIM_BUFFER_ARENA_H_
@@ -95,13 +95,14 @@ getClusterReader(const Reader& zimReader, offset_t offset, Cluster::Compression*
 
   Cluster::~Cluster() = default;
 
-  /* This return the number of char read */
-  template<typename OFFSET_TYPE>
-  void Cluster::read_header(size_t maxBlobCount)
-  {
-    // read first offset, which specifies, how many offsets we need to read
-    OFFSET_TYPE offset = m_reader->read<OFFSET_TYPE>();
+namespace
+{
 
+// Check the first offset of a cluster header and return the number of offsets
+// in the header.
+template<typename OFFSET_TYPE>
+size_t checkFirstBlobOffset(OFFSET_TYPE offset, size_t maxBlobCount)
+{
     if ( offset != sizeof(OFFSET_TYPE) && offset < 2 * sizeof(OFFSET_TYPE) ) {
         throw zim::ZimFileFormatError("Error parsing cluster. Offset of the first blob is too small.");
     }
@@ -115,6 +116,63 @@ getClusterReader(const Reader& zimReader, offset_t offset, Cluster::Compression*
     if ( maxBlobCount + 1 != 0 && n_offset > maxBlobCount + 1 ) {
         throw zim::ZimFileFormatError("Error parsing cluster. Offset of the first blob is too large.");
     }
+    return n_offset;
+}
+
+// Read the cluster header up to the offsets of the blob `n` and skip the
+// data of the preceding blobs. Return the size of the blob `n`.
+template<typename OFFSET_TYPE>
+zsize_t seekToBlob(IStreamReader& reader, blob_index_t n, size_t maxBlobCount)
+{
+    const OFFSET_TYPE firstOffset = reader.read<OFFSET_TYPE>();
+    const size_t n_offset = checkFirstBlobOffset(firstOffset, maxBlobCount);
+    if (blob_index_type(n)+1 >= n_offset) {
+        throw ZimFileFormatError("blob index out of range");
+    }
+
+    OFFSET_TYPE blobStart = firstOffset;
+    for (blob_index_type i = 0; i < blob_index_type(n); ++i) {
+      const OFFSET_TYPE offset = reader.read<OFFSET_TYPE>();
+      if (offset < blobStart) {
+        throw zim::ZimFileFormatError("Error parsing cluster. Offsets are not ordered.");
+      }
+      blobStart = offset;
+    }
+    const OFFSET_TYPE blobEnd = reader.read<OFFSET_TYPE>();
+    if (blobEnd < blobStart) {
+      throw zim::ZimFileFormatError("Error parsing cluster. Offsets are not ordered.");
+    }
+
+    // We have read n+2 offsets. Skip the remaining ones and the data of the
+    // previous blobs.
+    const offset_type headerBytesRead = (offset_type(blob_index_type(n)) + 2) * sizeof(OFFSET_TYPE);
+    reader.skip(zsize_t(blobStart - headerBytesRead));
+    return zsize_t(blobEnd - blobStart);
+}
+
+} // unnamed namespace
+
+  std::unique_ptr<IStreamReader> Cluster::openBlobStream(const Reader& zimReader, offset_t clusterOffset, blob_index_t n, size_t maxBlobCount, zsize_t* blobSize)
+  {
+    Compression comp;
+    bool extended;
+    auto reader = getClusterReader(zimReader, clusterOffset, &comp, &extended);
+    if (extended) {
+      *blobSize = seekToBlob<uint64_t>(*reader, n, maxBlobCount);
+    } else {
+      *blobSize = seekToBlob<uint32_t>(*reader, n, maxBlobCount);
+    }
+    return reader;
+  }
+
+  /* This return the number of char read */
+  template<typename OFFSET_TYPE>
+  void Cluster::read_header(size_t maxBlobCount)
+  {
+    // read first offset, which specifies, how many offsets we need to read
+    OFFSET_TYPE offset = m_reader->read<OFFSET_TYPE>();
+
+    size_t n_offset = checkFirstBlobOffset(offset, maxBlobCount);
 
     // read offsets
     m_blobOffsets.clear();
@@ -170,6 +228,26 @@ getClusterReader(const Reader& zimReader, offset_t offset, Cluster::Compression*
     return *m_blobReaders[blob_index_type(n)];
   }
 
+  bool Cluster::tryGetBlob(blob_index_t n, Blob& blob) const
+  {
+    if (!isCompressed()) {
+      return false;
+    }
+    if (n >= count()) {
+      blob = Blob();
+      return true;
+    }
+    std::unique_lock<std::mutex> lock(m_readerAccessMutex, std::try_to_lock);
+    if (!lock.owns_lock() || blob_index_type(n) >= m_blobReaders.size()) {
+      return false;
+    }
+    const auto blobSize = getBlobSize(n);
+    blob = blobSize.v > SIZE_MAX
+         ? Blob()
+         : m_blobReaders[blob_index_type(n)]->get_buffer(offset_t(0), blobSize);
+    return true;
+  }
+
   Blob Cluster::getBlob(blob_index_t n) const
   {
     if (n < count()) {
@@ -200,6 +278,25 @@ getClusterReader(const Reader& zimReader, offset_t offset, Cluster::Compression*
     }
   }
 
+  std::vector<Blob> Cluster::getBlobChunks(blob_index_t n, offset_t offset, zsize_t size) const
+  {
+    std::vector<Blob> chunks;
+    if (n < count()) {
+      const auto blobSize = getBlobSize(n);
+      if ( offset.v > blobSize.v ) {
+        return chunks;
+      }
+      size = std::min(size, zsize_t(blobSize.v-offset.v));
+      if (size.v > SIZE_MAX) {
+        return chunks;
+      }
+      for (const auto& buffer : getReader(n).get_buffers(offset, size)) {
+        chunks.push_back(buffer);
+      }
+    }
+    return chunks;
+  }
+
   // This function must return the memory consumption for a given cluster so
   // that it can be used as a cost estimate during caching.
   // However, because of partial (incremental) decompression, this size depends
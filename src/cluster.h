@@ -90,12 +90,25 @@ namespace zim
 
       offset_t getBlobOffset(blob_index_t n) const;
 
+      // Get the data of blob `n` only if it is already decompressed in
+      // memory. This never blocks: if another thread is decompressing the
+      // cluster, the blob is reported as not available. Blobs of
+      // uncompressed clusters are read from the file on access and so are
+      // never available.
+      bool tryGetBlob(blob_index_t n, Blob& blob) const;
+
       Blob getBlob(blob_index_t n) const;
       Blob getBlob(blob_index_t n, offset_t offset, zsize_t size) const;
+      std::vector<Blob> getBlobChunks(blob_index_t n, offset_t offset, zsize_t size) const;
 
       size_t getMemorySize() const;
 
       static std::shared_ptr<Cluster> read(const Reader& zimReader, offset_t clusterOffset, size_t maxBlobCount = size_t(-1));
+
+      // Open a stream on the data of the blob `n` of the cluster at
+      // `clusterOffset`, without reading the whole cluster.
+      // The data of the preceding blobs is decoded and dropped.
+      static std::unique_ptr<IStreamReader> openBlobStream(const Reader& zimReader, offset_t clusterOffset, blob_index_t n, size_t maxBlobCount, zsize_t* blobSize);
   };
 
   struct ClusterMemorySize {
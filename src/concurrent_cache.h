@@ -105,6 +105,21 @@ public: // functions
     return log_debug_return_value(cacheEntry.value.get());
   }
 
+  // Gets the entry corresponding to the given key, without blocking.
+  // Returns false if the entry is not in the cache or if it is still being
+  // obtained (by a concurrent getOrPut()).
+  bool getIfReady(const Key& key, Value& value)
+  {
+    log_debug_func_call("ConcurrentCache::getIfReady", key);
+    log_debug_raii_sync_statement(std::unique_lock<std::mutex> l(lock_));
+    const auto x = impl_.get(key);
+    if ( x.miss() || !x.value().ready() ) {
+      return false;
+    }
+    value = x.value().value.get();
+    return true;
+  }
+
   bool drop(const Key& key)
   {
     log_debug_func_call("ConcurrentCache::drop", key);
@@ -57,6 +57,18 @@ std::shared_ptr<const Dirent> DirectDirentAccessor::getDirent(entry_index_t idx)
   return dirent;
 }
 
+std::shared_ptr<const Dirent> DirectDirentAccessor::getCachedDirent(entry_index_t idx) const
+{
+  std::lock_guard<std::mutex> l(m_direntCacheLock);
+  auto v = m_direntCache.get(idx.v);
+  return v.hit() ? v.value() : nullptr;
+}
+
+std::shared_ptr<const Dirent> DirectDirentAccessor::getUncachedDirent(entry_index_t idx) const
+{
+  return readDirent(getOffset(idx));
+}
+
 offset_t DirectDirentAccessor::getOffset(entry_index_t idx) const
 {
   if (idx >= m_direntCount) {
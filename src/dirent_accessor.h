@@ -53,6 +53,10 @@ public: // functions
 
   offset_t    getOffset(entry_index_t idx) const;
   std::shared_ptr<const Dirent> getDirent(entry_index_t idx) const;
+  // Return the dirent if it is in the cache, else nullptr.
+  std::shared_ptr<const Dirent> getCachedDirent(entry_index_t idx) const;
+  // Read the dirent without using (nor filling) the cache.
+  std::shared_ptr<const Dirent> getUncachedDirent(entry_index_t idx) const;
   entry_index_t getDirentCount() const  {  return m_direntCount; }
 
   size_t getMaxCacheSize() const { return m_direntCache.getMaxCost(); }
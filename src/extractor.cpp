@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#define ZIM_PRIVATE
+#include <zim/extractor.h>
+#include <zim/entry.h>
+#include <zim/item.h>
+#include "fileimpl.h"
+#include "cluster.h"
+#include "namedthread.h"
+#include "fs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace zim
+{
+
+namespace
+{
+
+std::vector<std::string> splitPath(const std::string& path)
+{
+  std::vector<std::string> parts;
+  std::string::size_type start = 0;
+  while (true) {
+    const auto end = path.find('/', start);
+    parts.push_back(path.substr(start, end - start));
+    if (end == std::string::npos) {
+      return parts;
+    }
+    start = end + 1;
+  }
+}
+
+// The path of `target` relative to the directory containing `path`.
+std::string getRelativePath(const std::string& path, const std::string& target)
+{
+  auto dirParts = splitPath(path);
+  dirParts.pop_back();
+  const auto targetParts = splitPath(target);
+
+  size_t common = 0;
+  while (common < dirParts.size()
+      && common + 1 < targetParts.size()
+      && dirParts[common] == targetParts[common]) {
+    common++;
+  }
+
+  std::string relativePath;
+  for (auto i = common; i < dirParts.size(); i++) {
+    relativePath += "../";
+  }
+  for (auto i = common; i < targetParts.size(); i++) {
+    if (i != common) {
+      relativePath += '/';
+    }
+    relativePath += targetParts[i];
+  }
+  return relativePath;
+}
+
+// Tar numeric fields are octal strings. Values too big for the field are
+// stored in base-256 (GNU extension).
+void writeTarNumber(char* field, size_t fieldSize, uint64_t value)
+{
+  const auto digitCount = fieldSize - 1;
+  if (digitCount * 3 >= 64 || value < (uint64_t(1) << (digitCount * 3))) {
+    field[digitCount] = '\0';
+    for (auto i = digitCount; i > 0; i--) {
+      field[i-1] = '0' + (value & 7);
+      value >>= 3;
+    }
+    return;
+  }
+
+  for (auto i = fieldSize; i > 1; i--) {
+    field[i-1] = char(value & 0xff);
+    value >>= 8;
+  }
+  field[0] = char(0x80);
+}
+
+struct ExtractTask
+{
+  Entry entry;
+  Blob data;
+};
+
+// The queue of entries decompressed by the workers and waiting to be given
+// to the sink. The size of the pending data is bounded.
+class ExtractQueue
+{
+  public:
+    ExtractQueue(size_type maxPendingSize, unsigned workerCount)
+      : m_maxPendingSize(maxPendingSize),
+        m_pendingSize(0),
+        m_runningWorkers(workerCount),
+        m_stopped(false)
+    {}
+
+    // Return false if the extraction has been stopped.
+    bool push(ExtractTask task)
+    {
+      const auto size = task.data.size();
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_canPush.wait(lock, [&]() {
+        return m_stopped
+            || m_pendingSize == 0
+            || m_pendingSize + size <= m_maxPendingSize;
+      });
+      if (m_stopped) {
+        return false;
+      }
+      m_pendingSize += size;
+      m_tasks.push_back(std::move(task));
+      m_canPop.notify_one();
+      return true;
+    }
+
+    // Move all the pending tasks in `tasks`.
+    // Return false once all workers are done and no task is pending,
+    // or if the extraction has been stopped.
+    bool popAll(std::deque<ExtractTask>& tasks)
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_canPop.wait(lock, [&]() {
+        return m_stopped || !m_tasks.empty() || m_runningWorkers == 0;
+      });
+      if (m_stopped || m_tasks.empty()) {
+        return false;
+      }
+      tasks.swap(m_tasks);
+      return true;
+    }
+
+    // Mark `size` bytes of data as written by the sink.
+    void release(size_type size)
+    {
+      if (size == 0) {
+        return;
+      }
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pendingSize -= size;
+      m_canPush.notify_all();
+    }
+
+    void workerDone()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_runningWorkers--;
+      m_canPop.notify_one();
+    }
+
+    void stop(std::exception_ptr error)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_error) {
+        m_error = error;
+      }
+      m_stopped = true;
+      m_canPush.notify_all();
+      m_canPop.notify_all();
+    }
+
+    bool isStopped() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_stopped;
+    }
+
+    void rethrowError() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_error) {
+        std::rethrow_exception(m_error);
+      }
+    }
+
+  private:
+    const size_type m_maxPendingSize;
+    size_type m_pendingSize;
+    unsigned m_runningWorkers;
+    bool m_stopped;
+    std::exception_ptr m_error;
+    std::deque<ExtractTask> m_tasks;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_canPush;
+    std::condition_variable m_canPop;
+};
+
+void extractRange(const FileImpl& file, const Archive::EntryRange<EntryOrder::efficientOrder>& range, ExtractQueue& queue)
+{
+  std::shared_ptr<const Cluster> cluster;
+  cluster_index_type clusterIdx = 0;
+  for (const auto& entry : range) {
+    if (entry.isRedirect()) {
+      if (!queue.push(ExtractTask{entry, Blob()})) {
+        return;
+      }
+      continue;
+    }
+    const auto item = entry.getItem();
+    // Entries are in cluster order, each cluster is read only once.
+    if (!cluster || item.getClusterIndex() != clusterIdx) {
+      clusterIdx = item.getClusterIndex();
+      cluster.reset();
+      cluster = file.getUncachedCluster(cluster_index_t(clusterIdx));
+    }
+    auto data = cluster->getBlob(blob_index_t(item.getBlobIndex()));
+    if (!queue.push(ExtractTask{entry, std::move(data)})) {
+      return;
+    }
+  }
+}
+
+} // unnamed namespace
+
+ExtractSink::~ExtractSink() = default;
+
+void ExtractSink::addRedirect(const Entry& /*entry*/)
+{}
+
+void ExtractSink::finish()
+{}
+
+DirectoryExtractSink::DirectoryExtractSink(const std::string& directory)
+  : m_directory(directory)
+{
+  DEFAULTFS::makeDirectory(m_directory);
+}
+
+void DirectoryExtractSink::makeDirectories(const std::string& path)
+{
+  const auto pos = path.rfind('/');
+  if (pos == std::string::npos) {
+    return;
+  }
+  const auto dirPath = path.substr(0, pos);
+  if (m_createdDirectories.count(dirPath)) {
+    return;
+  }
+  makeDirectories(dirPath);
+  DEFAULTFS::makeDirectory(DEFAULTFS::join(m_directory, dirPath));
+  m_createdDirectories.insert(dirPath);
+}
+
+void DirectoryExtractSink::addItem(const Item& item, const Blob& data)
+{
+  const auto path = item.getPath();
+  for (const auto& part : splitPath(path)) {
+    if (part.empty() || part == "." || part == "..") {
+      throw std::runtime_error("Cannot extract item with path \"" + path + "\"");
+    }
+  }
+  makeDirectories(path);
+
+  const auto filepath = DEFAULTFS::join(m_directory, path);
+  std::ofstream out(filepath, std::ios::binary | std::ios::trunc);
+  out.write(data.data(), data.size());
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Cannot write file " + filepath);
+  }
+}
+
+TarExtractSink::TarExtractSink(std::ostream& out)
+  : m_out(out)
+{}
+
+void TarExtractSink::writePadding(size_type size)
+{
+  static const char zeros[512] = {};
+  const auto rest = size % 512;
+  if (rest) {
+    m_out.write(zeros, 512 - rest);
+  }
+}
+
+void TarExtractSink::writeLongName(char type, const std::string& name)
+{
+  writeHeader("././@LongLink", type, name.size() + 1, "");
+  m_out.write(name.c_str(), name.size() + 1);
+  writePadding(name.size() + 1);
+}
+
+void TarExtractSink::writeHeader(const std::string& path, char type, size_type size, const std::string& linkTarget)
+{
+  if (linkTarget.size() > 100) {
+    writeLongName('K', linkTarget);
+  }
+  if (path.size() > 100) {
+    writeLongName('L', path);
+  }
+
+  char header[512] = {};
+  memcpy(header, path.data(), std::min(path.size(), size_t(100)));
+  writeTarNumber(header + 100, 8, type == '2' ? 0777 : 0644);
+  writeTarNumber(header + 108, 8, 0);
+  writeTarNumber(header + 116, 8, 0);
+  writeTarNumber(header + 124, 12, size);
+  writeTarNumber(header + 136, 12, 0);
+  header[156] = type;
+  memcpy(header + 157, linkTarget.data(), std::min(linkTarget.size(), size_t(100)));
+  // GNU tar magic, needed for the long name extension.
+  memcpy(header + 257, "ustar  ", 8);
+
+  memset(header + 148, ' ', 8);
+  unsigned checksum = 0;
+  for (auto c : header) {
+    checksum += static_cast<unsigned char>(c);
+  }
+  writeTarNumber(header + 148, 7, checksum);
+
+  m_out.write(header, 512);
+}
+
+void TarExtractSink::addItem(const Item& item, const Blob& data)
+{
+  writeHeader(item.getPath(), '0', data.size(), "");
+  m_out.write(data.data(), data.size());
+  writePadding(data.size());
+  if (!m_out) {
+    throw std::runtime_error("Cannot write tar stream");
+  }
+}
+
+void TarExtractSink::addRedirect(const Entry& entry)
+{
+  const auto path = entry.getPath();
+  const auto target = entry.getRedirectEntry().getPath();
+  writeHeader(path, '2', 0, getRelativePath(path, target));
+  if (!m_out) {
+    throw std::runtime_error("Cannot write tar stream");
+  }
+}
+
+void TarExtractSink::finish()
+{
+  static const char zeros[1024] = {};
+  m_out.write(zeros, 1024);
+  m_out.flush();
+  if (!m_out) {
+    throw std::runtime_error("Cannot write tar stream");
+  }
+}
+
+CallbackExtractSink::CallbackExtractSink(Callback callback)
+  : m_callback(std::move(callback))
+{}
+
+void CallbackExtractSink::addItem(const Item& item, const Blob& data)
+{
+  m_callback(item, data);
+}
+
+Extractor::Extractor(const Archive& archive)
+  : m_archive(archive),
+    m_workerCount(std::max(1U, std::thread::hardware_concurrency())),
+    m_maxPendingSize(64*1024*1024)
+{}
+
+Extractor& Extractor::setWorkerCount(unsigned workerCount)
+{
+  m_workerCount = std::max(1U, workerCount);
+  return *this;
+}
+
+Extractor& Extractor::setMaxPendingSize(size_type maxSize)
+{
+  m_maxPendingSize = maxSize;
+  return *this;
+}
+
+void Extractor::extract(ExtractSink& sink) const
+{
+  // More ranges than workers, so a worker finishing early can help others.
+  const auto ranges = m_archive.partitionByCluster(m_workerCount * 4);
+  const auto file = m_archive.getImpl();
+  ExtractQueue queue(m_maxPendingSize, m_workerCount);
+  std::atomic<size_t> nextRange(0);
+
+  std::vector<std::unique_ptr<NamedThread>> workers;
+  for (unsigned i = 0; i < m_workerCount; i++) {
+    std::ostringstream name;
+    name << "extractor" << i;
+    workers.emplace_back(new NamedThread(name.str(), [&]() {
+      try {
+        size_t rangeIdx;
+        while (!queue.isStopped() && (rangeIdx = nextRange++) < ranges.size()) {
+          extractRange(*file, ranges[rangeIdx], queue);
+        }
+      } catch (...) {
+        queue.stop(std::current_exception());
+      }
+      queue.workerDone();
+    }));
+  }
+
+  try {
+    std::deque<ExtractTask> tasks;
+    while (queue.popAll(tasks)) {
+      for (const auto& task : tasks) {
+        if (task.entry.isRedirect()) {
+          sink.addRedirect(task.entry);
+        } else {
+          sink.addItem(task.entry.getItem(), task.data);
+        }
+        queue.release(task.data.size());
+      }
+      tasks.clear();
+    }
+  } catch (...) {
+    queue.stop(std::current_exception());
+  }
+
+  for (auto& worker : workers) {
+    worker->join();
+  }
+  queue.rethrowError();
+  sink.finish();
+}
+
+} // namespace zim
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include "fd_pool.h"
+
+namespace zim {
+
+PooledFD::PooledFD(const std::string& path)
+  : m_path(path),
+    m_fd(std::make_shared<const FD>(DEFAULTFS::openFile(path))),
+    m_lastUse(0),
+    m_inPool(false)
+{
+  FdPool::instance().opened(this);
+}
+
+PooledFD::PooledFD(FDSharedPtr fd)
+  : m_path(),
+    m_fd(fd),
+    m_lastUse(0),
+    m_inPool(false)
+{}
+
+PooledFD::~PooledFD()
+{
+  if (isReopenable()) {
+    FdPool::instance().removed(this);
+  }
+}
+
+PooledFD::FDSharedPtr PooledFD::get() const
+{
+  auto& pool = FdPool::instance();
+  FDSharedPtr fd = std::atomic_load_explicit(&m_fd, std::memory_order_acquire);
+  if (fd) {
+    if (isReopenable() && pool.getMaxSize() != 0) {
+      pool.m_hitCount.fetch_add(1, std::memory_order_relaxed);
+      pool.used(this);
+    }
+    return fd;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    fd = std::atomic_load_explicit(&m_fd, std::memory_order_acquire);
+    if (fd) {
+      // Reopened by another thread.
+      return fd;
+    }
+    // Only a reopenable fd can have been closed by the pool.
+    fd = std::make_shared<const FD>(DEFAULTFS::openFile(m_path));
+    std::atomic_store_explicit(&m_fd, fd, std::memory_order_release);
+  }
+
+  // The pool is notified without holding our lock, as the pool may close
+  // other fds (and so lock them) while holding its own lock.
+  pool.m_missCount.fetch_add(1, std::memory_order_relaxed);
+  pool.opened(this);
+  return fd;
+}
+
+void PooledFD::close() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // Readers currently using the fd still own it. It will be really closed
+  // when they release it.
+  std::atomic_store_explicit(&m_fd, FDSharedPtr(), std::memory_order_release);
+}
+
+
+FdPool& FdPool::instance()
+{
+  static FdPool pool;
+  return pool;
+}
+
+FdPool::FdPool()
+  : m_maxSize(0),
+    m_clock(0),
+    m_hitCount(0),
+    m_missCount(0)
+{}
+
+void FdPool::setMaxSize(size_t maxSize)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxSize.store(maxSize, std::memory_order_relaxed);
+  closeExtraFds(nullptr);
+}
+
+size_t FdPool::getCurrentSize() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_lruList.size();
+}
+
+void FdPool::opened(const PooledFD* fd)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  {
+    // The fd may have been closed again by another thread since it has been
+    // (re)opened. Nothing to track then.
+    std::lock_guard<std::mutex> fdLock(fd->m_mutex);
+    if (!std::atomic_load(&fd->m_fd)) {
+      return;
+    }
+  }
+  if (!fd->m_inPool) {
+    m_lruList.push_front(fd);
+    fd->m_poolPosition = m_lruList.begin();
+    fd->m_inPool = true;
+  }
+  moveToFront(fd);
+  closeExtraFds(fd);
+}
+
+void FdPool::used(const PooledFD* fd)
+{
+  // Less than half of the pool has been moved before the fd since its last
+  // move: it is still in the front half of the LRU list, far from being
+  // closed, and there is no need to lock the pool.
+  const auto lastUse = fd->m_lastUse.load(std::memory_order_relaxed);
+  const auto clock = m_clock.load(std::memory_order_relaxed);
+  if ((clock - lastUse) * 2 < m_maxSize.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (fd->m_inPool) {
+    moveToFront(fd);
+  }
+}
+
+void FdPool::moveToFront(const PooledFD* fd)
+{
+  m_lruList.splice(m_lruList.begin(), m_lruList, fd->m_poolPosition);
+  fd->m_lastUse.store(m_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void FdPool::removed(const PooledFD* fd)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (fd->m_inPool) {
+    m_lruList.erase(fd->m_poolPosition);
+    fd->m_inPool = false;
+  }
+}
+
+// Must be called with m_mutex locked.
+void FdPool::closeExtraFds(const PooledFD* keep)
+{
+  const auto maxSize = m_maxSize.load(std::memory_order_relaxed);
+  if (maxSize == 0) {
+    return;
+  }
+  auto it = m_lruList.end();
+  while (m_lruList.size() > maxSize && it != m_lruList.begin()) {
+    --it;
+    const PooledFD* fd = *it;
+    if (fd == keep) {
+      continue;
+    }
+    fd->close();
+    fd->m_inPool = false;
+    it = m_lruList.erase(it);
+  }
+}
+
+};
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_FD_POOL_H_
+#define ZIM_FD_POOL_H_
+
+#include "fs.h"
+#include "config.h"
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace zim {
+
+class FdPool;
+
+/** A file descriptor managed by the process-wide `FdPool`.
+ *
+ * A `PooledFD` created from a path may be closed by the pool when too many
+ * descriptors are open. It is then transparently reopened (using the same
+ * path) at next use.
+ *
+ * A `PooledFD` created from an already opened descriptor cannot be reopened
+ * and so is never closed by the pool.
+ */
+class LIBZIM_PRIVATE_API PooledFD {
+  public: // types
+    typedef DEFAULTFS::FD FD;
+    typedef std::shared_ptr<const FD> FDSharedPtr;
+
+  public: // functions
+    explicit PooledFD(const std::string& path);
+    explicit PooledFD(FDSharedPtr fd);
+    PooledFD(const PooledFD&) = delete;
+    PooledFD& operator=(const PooledFD&) = delete;
+    ~PooledFD();
+
+    // Returns the opened descriptor, reopening it if needed.
+    // The descriptor is kept open as long as the returned pointer is alive,
+    // even if the pool closes it in the meantime.
+    // This is lock free if the descriptor is opened and is (nearly) the most
+    // recently used one of the pool.
+    FDSharedPtr get() const;
+
+    bool isReopenable() const { return !m_path.empty(); }
+
+  private: // functions
+    void close() const;
+
+  private: // data
+    friend class FdPool;
+
+    const std::string m_path;
+    // Serializes the reopening and the closing of the fd.
+    mutable std::mutex m_mutex;
+    // Always accessed with the atomic shared_ptr functions.
+    mutable FDSharedPtr m_fd;
+    // The pool clock when the fd was last moved to the front of the LRU list.
+    mutable std::atomic<uint64_t> m_lastUse;
+
+    // Protected by the FdPool mutex.
+    mutable bool m_inPool;
+    mutable std::list<const PooledFD*>::iterator m_poolPosition;
+};
+
+/** The process-wide pool of reopenable file descriptors.
+ *
+ * The pool keeps track of the opened reopenable descriptors in a LRU list.
+ * If a limit is set, the least recently used descriptors are closed to
+ * respect it. Without limit (the default), descriptors are never closed and
+ * no bookkeeping (nor hit counting) is done when a descriptor is used.
+ */
+class LIBZIM_PRIVATE_API FdPool {
+  public: // functions
+    static FdPool& instance();
+
+    size_t getMaxSize() const { return m_maxSize.load(std::memory_order_relaxed); }
+    void setMaxSize(size_t maxSize);
+    size_t getCurrentSize() const;
+
+    size_t getHitCount() const { return m_hitCount.load(std::memory_order_relaxed); }
+    size_t getMissCount() const { return m_missCount.load(std::memory_order_relaxed); }
+
+  private: // functions
+    friend class PooledFD;
+
+    FdPool();
+
+    void opened(const PooledFD* fd);
+    void used(const PooledFD* fd);
+    void removed(const PooledFD* fd);
+
+    void closeExtraFds(const PooledFD* keep);
+    // Move the fd to the front of the LRU list. Must be called with m_mutex
+    // locked.
+    void moveToFront(const PooledFD* fd);
+
+  private: // data
+    mutable std::mutex m_mutex;
+    // Most recently used first.
+    std::list<const PooledFD*> m_lruList;
+    std::atomic<size_t> m_maxSize;
+    // Incremented each time a fd is moved to the front of the LRU list.
+    std::atomic<uint64_t> m_clock;
+    std::atomic<size_t> m_hitCount;
+    std::atomic<size_t> m_missCount;
+};
+
+};
+
+#endif // ZIM_FD_POOL_H_
@@ -28,6 +28,7 @@
 
 #include "zim_types.h"
 #include "fs.h"
+#include "fd_pool.h"
 
 namespace zim {
 
@@ -43,29 +44,37 @@ class FilePart {
   typedef DEFAULTFS FS;
 
   public:
-    using FDSharedPtr = std::shared_ptr<FS::FD>;
+    using FDSharedPtr = std::shared_ptr<const PooledFD>;
 
   public:
     explicit FilePart(const std::string& filename) :
         m_filename(filename),
-        m_fhandle(std::make_shared<FS::FD>(FS::openFile(filename))),
+        m_fhandle(std::make_shared<PooledFD>(filename)),
         m_offset(0),
-        m_size(m_fhandle->getSize()) {}
+        m_size(m_fhandle->get()->getSize()) {}
 
 #ifndef _WIN32
+    // The path of a part opened from a fd is only valid as long as the user
+    // keeps its fd opened. So we cannot reopen it later and the pool must not
+    // close it.
     explicit FilePart(int fd) :
-        FilePart(getFilePathFromFD(fd)) {}
+        m_filename(getFilePathFromFD(fd)),
+        m_fhandle(openPinned(m_filename)),
+        m_offset(0),
+        m_size(m_fhandle->get()->getSize()) {}
 
     explicit FilePart(FdInput fdInput):
         m_filename(getFilePathFromFD(fdInput.fd)),
-        m_fhandle(std::make_shared<FS::FD>(FS::openFile(m_filename))),
+        m_fhandle(openPinned(m_filename)),
         m_offset(fdInput.offset),
         m_size(fdInput.size) {}
 #endif
 
     ~FilePart() = default;
     const std::string& filename() const { return m_filename; };
-    const FS::FD& fhandle() const { return *m_fhandle; };
+    // The returned fd stays opened as long as it is hold, even if the
+    // fd pool closes it in the meantime.
+    PooledFD::FDSharedPtr fhandle() const { return m_fhandle->get(); };
     const FDSharedPtr& shareable_fhandle() const { return m_fhandle; };
 
     zsize_t size() const { return m_size; };
@@ -74,6 +83,11 @@ class FilePart {
     bool good() const { return bool(m_size); };
 
   private:
+    static FDSharedPtr openPinned(const std::string& filename) {
+      return std::make_shared<PooledFD>(
+        std::make_shared<const FS::FD>(FS::openFile(filename)));
+    }
+
     const std::string m_filename;
     FDSharedPtr m_fhandle;
     offset_t m_offset;
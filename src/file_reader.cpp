@@ -77,13 +77,13 @@ MultiPartFileReader::MultiPartFileReader(std::shared_ptr<const FileCompound> sou
 char MultiPartFileReader::readImpl(offset_t offset) const {
   offset += _offset;
   auto part_pair = source->locate(offset);
-  auto& fhandle = part_pair->second->fhandle();
+  auto fhandle = part_pair->second->fhandle();
   offset_t logical_local_offset = offset - part_pair->first.min;
   ASSERT(logical_local_offset, <=, part_pair->first.max);
   offset_t physical_local_offset = logical_local_offset + part_pair->second->offset();
   char ret;
   try {
-    fhandle.readAt(&ret, zsize_t(1), physical_local_offset);
+    fhandle->readAt(&ret, zsize_t(1), physical_local_offset);
   } catch (std::runtime_error& e) {
     //Error while reading.
     Formatter fmt;
@@ -111,7 +111,7 @@ void MultiPartFileReader::readImpl(char* dest, offset_t offset, zsize_t size) co
     zsize_t size_to_get = zsize_t(std::min(size.v, part->size().v-logical_local_offset.v));
     offset_t physical_local_offset = logical_local_offset + part->offset();
     try {
-      part->fhandle().readAt(dest, size_to_get, physical_local_offset);
+      part->fhandle()->readAt(dest, size_to_get, physical_local_offset);
     } catch (std::runtime_error& e) {
       Formatter fmt;
       fmt << "Cannot read chars.\n";
@@ -219,7 +219,9 @@ const Buffer MultiPartFileReader::get_mmap_buffer(offset_t offset, zsize_t size)
   auto part = found_range.first->second;
   auto logical_local_offset = offset + _offset - range.min;
   ASSERT(size, <=, part->size());
-  int fd = part->fhandle().getNativeHandle();
+  // Keep the fd opened (even if the pool closes it) until the mapping is done.
+  auto fhandle = part->fhandle();
+  int fd = fhandle->getNativeHandle();
   auto physical_local_offset = logical_local_offset + part->offset();
   return Buffer::makeBuffer(makeMmappedBuffer(fd, physical_local_offset, size), size);
 #else
@@ -227,6 +229,28 @@ const Buffer MultiPartFileReader::get_mmap_buffer(offset_t offset, zsize_t size)
 #endif
 }
 
+std::vector<Buffer> MultiPartFileReader::get_buffers(offset_t offset, zsize_t size) const
+{
+  ASSERT(offset.v+size.v, <=, _size.v);
+  std::vector<Buffer> buffers;
+  if (!size) {
+    return buffers;
+  }
+  // One buffer per part, so that each of them can be mmapped instead of
+  // copying the whole range in a new buffer.
+  auto found_range = source->locate(_offset + offset, size);
+  for(auto current = found_range.first; current!=found_range.second; current++){
+    auto part = current->second;
+    offset_t logical_local_offset = _offset + offset - current->first.min;
+    zsize_t size_to_get = zsize_t(std::min(size.v, part->size().v-logical_local_offset.v));
+    buffers.push_back(get_buffer(offset, size_to_get));
+    size -= size_to_get;
+    offset += size_to_get;
+  }
+  ASSERT(size.v, ==, 0U);
+  return buffers;
+}
+
 bool Reader::can_read(offset_t offset, zsize_t size) const
 {
     return (offset.v <= this->size().v && (offset.v+size.v) <= this->size().v);
@@ -255,7 +279,7 @@ char FileReader::readImpl(offset_t offset) const
   offset += _offset;
   char ret;
   try {
-    _fhandle->readAt(&ret, zsize_t(1), offset);
+    _fhandle->get()->readAt(&ret, zsize_t(1), offset);
   } catch (std::runtime_error& e) {
     //Error while reading.
     Formatter fmt;
@@ -271,7 +295,7 @@ void FileReader::readImpl(char* dest, offset_t offset, zsize_t size) const
 {
   offset += _offset;
   try {
-    _fhandle->readAt(dest, size, offset);
+    _fhandle->get()->readAt(dest, size, offset);
   } catch (std::runtime_error& e) {
     Formatter fmt;
     fmt << "Cannot read chars.\n";
@@ -285,7 +309,9 @@ void FileReader::readImpl(char* dest, offset_t offset, zsize_t size) const
 const Buffer FileReader::get_mmap_buffer(offset_t offset, zsize_t size) const {
 #ifdef ENABLE_USE_MMAP
   auto local_offset = offset + _offset;
-  int fd = _fhandle->getNativeHandle();
+  // Keep the fd opened (even if the pool closes it) until the mapping is done.
+  auto fhandle = _fhandle->get();
+  int fd = fhandle->getNativeHandle();
   return Buffer::makeBuffer(makeMmappedBuffer(fd, local_offset, size), size);
 #else
   return Buffer::makeBuffer(size); // unreachable
@@ -23,6 +23,7 @@
 
 #include "reader.h"
 #include "fs.h"
+#include "fd_pool.h"
 
 namespace zim {
 
@@ -67,7 +68,7 @@ class LIBZIM_PRIVATE_API BaseFileReader : public Reader {
 
 class LIBZIM_PRIVATE_API FileReader : public BaseFileReader {
   public: // types
-    typedef std::shared_ptr<const DEFAULTFS::FD> FileHandle;
+    typedef std::shared_ptr<const PooledFD> FileHandle;
 
   public: // functions
     FileReader(FileHandle fh, offset_t offset, zsize_t size);
@@ -93,6 +94,7 @@ class LIBZIM_PRIVATE_API MultiPartFileReader : public BaseFileReader {
     ~MultiPartFileReader() {};
 
     const Buffer get_mmap_buffer(offset_t offset, zsize_t size) const override;
+    std::vector<Buffer> get_buffers(offset_t offset, zsize_t size) const override;
     std::unique_ptr<const Reader> sub_reader(offset_t offset, zsize_t size) const override;
 
   private: // functions
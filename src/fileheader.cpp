@@ -35,7 +35,7 @@ namespace zim
   const uint32_t Fileheader::zimMagic = 0x044d495a; // ="ZIM^d"
   const uint16_t Fileheader::zimOldMajorVersion = 5;
   const uint16_t Fileheader::zimMajorVersion = 6;
-  const uint16_t Fileheader::zimMinorVersion = 3;
+  const uint16_t Fileheader::zimMinorVersion = 4;
   const offset_type Fileheader::size = 80; // This is also mimeListPos (so an offset)
 
   Fileheader::Fileheader()
@@ -115,6 +115,13 @@ namespace zim
 
       bool        useNewNamespaceScheme() const    { return minorVersion >= 1; }
 
+      // Since 6.4, the checksum is the MD5 of the bytes before the first
+      // cluster followed by the MD5 of the bytes from the first cluster to the
+      // checksum. The creator can then hash the clusters as they are written,
+      // before the header is known.
+      bool        useSplitChecksum() const
+      { return majorVersion == zimMajorVersion && minorVersion >= 4; }
+
   };
 
 }
@@ -36,15 +36,26 @@
 #include "_dirent.h"
 #include "file_compound.h"
 #include "buffer_reader.h"
+#include "istreamreader.h"
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include <cstring>
 #include <fstream>
 #include <numeric>
+#include <algorithm>
+#include <exception>
+#include <thread>
 #include "config.h"
 #include "log.h"
 #include "md5.h"
+#include "endian_tools.h"
 #include "tools.h"
+#include "title_prefix_index.h"
 #include "fileheader.h"
 
 log_define("zim.file.impl")
@@ -55,6 +66,24 @@ namespace zim
 namespace
 {
 
+// Size of a MD5 digest, as stored in the cluster checksum listing.
+const size_type CLUSTER_CHECKSUM_SIZE = 16;
+// Size of the reads done when checksumming a part of the file.
+const size_type CHECKSUM_READ_SIZE = 1024 * 1024;
+
+// Feed the bytes of the reader from `offset` to `end` (excluded) into the MD5
+// context.
+void hashRange(const Reader& reader, offset_t offset, offset_t end, struct zim_MD5_CTX* md5ctx)
+{
+  std::vector<char> buffer(std::min<size_type>(CHECKSUM_READ_SIZE, end.v - offset.v));
+  while (offset < end) {
+    const zsize_t size(std::min<size_type>(buffer.size(), end.v - offset.v));
+    reader.read(buffer.data(), offset, size);
+    zim_MD5Update(md5ctx, reinterpret_cast<const unsigned char*>(buffer.data()), unsigned(size.v));
+    offset += size;
+  }
+}
+
 offset_t readOffset(const Reader& reader, entry_index_type idx)
 {
   offset_t offset(reader.read_uint<offset_type>(offset_t(sizeof(offset_type)*idx)));
@@ -102,6 +131,7 @@ class Grouping
 {
 public: // types
   typedef std::vector<ObjectId> GroupedObjectIds;
+  typedef std::vector<GroupId> GroupIds;
 
 public: // functions
   explicit Grouping(ObjectId objectIdBegin, ObjectId objectIdEnd)
@@ -112,6 +142,19 @@ public: // functions
     groupIds_.reserve(objectIdEnd - objectIdBegin);
   }
 
+  // groupIds[i] is the group-id of the object with id (objectIdBegin+i)
+  Grouping(ObjectId objectIdBegin, GroupIds groupIds)
+    : firstObjectId_(objectIdBegin)
+    , groupIds_(std::move(groupIds))
+    , minGroupId_(std::numeric_limits<GroupId>::max())
+    , maxGroupId_(std::numeric_limits<GroupId>::min())
+  {
+    for ( const auto groupId : groupIds_ ) {
+      minGroupId_ = std::min(minGroupId_, groupId);
+      maxGroupId_ = std::max(maxGroupId_, groupId);
+    }
+  }
+
   // i'th call of add() is assumed to refer to the object
   // with id (firstObjectId_+i)
   void add(GroupId groupId)
@@ -156,9 +199,6 @@ private: // functions
     return groupBoundaries;
   }
 
-private: // types
-  typedef std::vector<GroupId> GroupIds;
-
 private: // data
   const ObjectId firstObjectId_;
   GroupIds groupIds_;
@@ -166,6 +206,26 @@ private: // data
   GroupId maxGroupId_;
 };
 
+// Marks the current thread as the one loading the indexes of a FileImpl
+// for the lifetime of the object.
+class LoadingThreadMark
+{
+public:
+  explicit LoadingThreadMark(std::atomic<std::thread::id>& loadingThread)
+    : loadingThread_(loadingThread)
+  {
+    loadingThread_.store(std::this_thread::get_id());
+  }
+
+  ~LoadingThreadMark()
+  {
+    loadingThread_.store(std::thread::id());
+  }
+
+private:
+  std::atomic<std::thread::id>& loadingThread_;
+};
+
 } //unnamed namespace
 
   ClusterCache& getClusterCache() {
@@ -198,9 +258,14 @@ private: // data
     : zimFile(_zimFile),
       zimReader(makeFileReader(zimFile)),
       direntReader(new DirentReader(zimReader)),
+      m_openConfig(openConfig),
+      m_indexesLoaded(false),
+      m_indexesLoadingThread(std::thread::id()),
       m_hasFrontArticlesIndex(true),
       m_startUserEntry(0),
-      m_endUserEntry(0)
+      m_endUserEntry(0),
+      m_articleListByClusterReady(false),
+      m_clusterChecksumListingReady(false)
 #ifdef ENABLE_XAPIAN
       ,m_xapianDbCreated(false)
 #endif
@@ -231,6 +296,16 @@ private: // data
       throw ZimFileFormatError("Zim file(s) is of bad size or corrupted.");
     }
 
+    if (!openConfig.m_lazyOpen) {
+      loadIndexes();
+    }
+  }
+
+  void FileImpl::loadIndexes()
+  {
+    // Accessors called while loading must not wait for the loading to end.
+    LoadingThreadMark loadingThreadMark(m_indexesLoadingThread);
+
     auto pathPtrReader = sectionSubReader(*zimReader,
                                           "Dirent pointer table",
                                           offset_t(header.getPathPtrPos()),
@@ -246,10 +321,10 @@ private: // data
 
     quickCheckForCorruptFile();
 
-    if (openConfig.m_preloadDirentRanges == 0) {
+    if (m_openConfig.m_preloadDirentRanges == 0) {
       m_direntLookup = std::make_unique<DirentLookup>(mp_pathDirentAccessor.get());
     } else {
-      m_direntLookup = std::make_unique<FastDirentLookup>(mp_pathDirentAccessor.get(), openConfig.m_preloadDirentRanges);
+      m_direntLookup = std::make_unique<FastDirentLookup>(mp_pathDirentAccessor.get(), m_openConfig.m_preloadDirentRanges);
     }
 
     if (header.useNewNamespaceScheme()) {
@@ -278,8 +353,13 @@ private: // data
       }
       m_byTitleDirentLookup.reset(new ByTitleDirentLookup(mp_titleDirentAccessor.get()));
 
+      result = m_direntLookup->find('X', "listing/foldedTitleOrdered/v1");
+      if (result.first) {
+        mp_foldedTitleDirentAccessor = getTitleAccessorV1(result.second);
+      }
+
 #ifdef ENABLE_XAPIAN
-      if (openConfig.m_preloadXapianDb) {
+      if (m_openConfig.m_preloadXapianDb && !m_openConfig.m_lazyOpen) {
         mp_xapianDb = loadXapianDb();
         m_xapianDbCreated.store(true, std::memory_order_release);
       }
@@ -290,6 +370,25 @@ private: // data
       dropCachedClusters();
       throw;
     }
+    m_indexesLoaded.store(true, std::memory_order_release);
+  }
+
+  void FileImpl::ensureIndexesLoaded() const
+  {
+    if (m_indexesLoaded.load(std::memory_order_acquire)) {
+      return;
+    }
+    if (m_indexesLoadingThread.load() == std::this_thread::get_id()) {
+      // We are called by loadIndexes() itself.
+      return;
+    }
+    // Not using std::call_once because it is buggy (and it wouldn't allow us
+    // to retry the loading if a previous attempt has thrown).
+    std::lock_guard<std::mutex> lock(m_indexesLoadingMutex);
+    if (!m_indexesLoaded.load(std::memory_order_acquire)) {
+      log_debug("lazy loading of the indexes of \"" << zimFile->filename() << '"');
+      const_cast<FileImpl*>(this)->loadIndexes();
+    }
   }
 
   FileImpl::~FileImpl() {
@@ -384,6 +483,7 @@ private: // data
     auto buffer = zimReader->get_buffer(offset_t(header.getMimeListPos()), size);
     const char* const bufferEnd = buffer.data() + size.v;
     const char* p = buffer.data();
+    mimeTypes.clear();
     while (*p != '\0') {
       const char* zp = std::find(p, bufferEnd, '\0');
 
@@ -400,6 +500,7 @@ private: // data
 
   FileImpl::FindxResult FileImpl::findx(char ns, const std::string& path) const
   {
+    ensureIndexesLoaded();
     return m_direntLookup->find(ns, path);
   }
 
@@ -416,6 +517,7 @@ private: // data
 
   FileImpl::FindxTitleResult FileImpl::findxByTitle(char ns, const std::string& title)
   {
+    ensureIndexesLoaded();
     return m_byTitleDirentLookup->find(ns, title);
   }
 
@@ -427,9 +529,18 @@ private: // data
 
   std::shared_ptr<const Dirent> FileImpl::getDirent(entry_index_t idx) const
   {
+    ensureIndexesLoaded();
     return mp_pathDirentAccessor->getDirent(idx);
   }
 
+  std::shared_ptr<const Dirent> FileImpl::getCachedDirent(entry_index_t idx) const
+  {
+    if (!m_indexesLoaded.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return mp_pathDirentAccessor->getCachedDirent(idx);
+  }
+
   FileImpl::FindxResult FileImpl::findxMetadata(const std::string& name) const {
     auto r = findx('M', name);
     if (!r.first) {
@@ -450,54 +561,415 @@ private: // data
 
   std::shared_ptr<const Dirent> FileImpl::getDirentByTitle(title_index_t idx) const
   {
+    ensureIndexesLoaded();
     return mp_titleDirentAccessor->getDirent(idx);
   }
 
   entry_index_t FileImpl::getIndexByTitle(title_index_t idx) const
   {
+    ensureIndexesLoaded();
     return mp_titleDirentAccessor->getDirectIndex(idx);
   }
 
+  std::pair<title_index_t, title_index_t> FileImpl::findFoldedTitleRange(const std::string& foldedPrefix) const
+  {
+    ensureIndexesLoaded();
+    if (!mp_foldedTitleDirentAccessor) {
+      return {title_index_t(0), title_index_t(0)};
+    }
+    const auto& accessor = *mp_foldedTitleDirentAccessor;
+
+    // First position for which `isBefore(foldedTitle)` is false.
+    const auto partitionPoint = [&](entry_index_type lo, entry_index_type hi, auto isBefore) {
+      while (lo < hi) {
+        const entry_index_type mid = lo + (hi - lo) / 2;
+        if (isBefore(foldTitle(accessor.getDirent(title_index_t(mid))->getTitle()))) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return lo;
+    };
+
+    const auto begin = partitionPoint(0, accessor.getDirentCount().v,
+      [&](const std::string& folded) { return folded < foldedPrefix; });
+    const auto end = partitionPoint(begin, accessor.getDirentCount().v,
+      [&](const std::string& folded) { return folded.compare(0, foldedPrefix.size(), foldedPrefix) == 0; });
+    return {title_index_t(begin), title_index_t(end)};
+  }
+
+  entry_index_t FileImpl::getIndexByFoldedTitle(title_index_t idx) const
+  {
+    ensureIndexesLoaded();
+    return mp_foldedTitleDirentAccessor->getDirectIndex(idx);
+  }
+
   entry_index_t FileImpl::getFrontEntryCount() const
   {
+    ensureIndexesLoaded();
     return entry_index_t(mp_titleDirentAccessor->getDirentCount().v);
   }
 
-  void FileImpl::prepareArticleListByCluster() const
+  cluster_index_type FileImpl::getClusterOrderKey(entry_index_t idx) const
+  {
+    // This is the offset of the dirent in the zimFile
+    auto indexOffset = mp_pathDirentAccessor->getOffset(idx);
+    // Get the mimeType of the dirent (offset 0) to know the type of the dirent
+    uint16_t mimeType = zimReader->read_uint<uint16_t>(indexOffset);
+    if (mimeType==Dirent::redirectMimeType || mimeType==Dirent::linktargetMimeType || mimeType == Dirent::deletedMimeType) {
+      return 0;
+    }
+    // If it is a classic article, get the clusterNumber (at offset 8)
+    return zimReader->read_uint<zim::cluster_index_type>(indexOffset+offset_t(8));
+  }
+
+  std::vector<entry_index_type> FileImpl::sortEntriesByCluster() const
   {
     const auto endIdx = getEndUserEntry().v;
     const auto startIdx = getStartUserEntry().v;
-    Grouping<entry_index_type, cluster_index_type> g(startIdx, endIdx);
-    for(auto i = startIdx; i < endIdx; i++)
-    {
-      // This is the offset of the dirent in the zimFile
-      auto indexOffset = mp_pathDirentAccessor->getOffset(entry_index_t(i));
-      // Get the mimeType of the dirent (offset 0) to know the type of the dirent
-      uint16_t mimeType = zimReader->read_uint<uint16_t>(indexOffset);
-      if (mimeType==Dirent::redirectMimeType || mimeType==Dirent::linktargetMimeType || mimeType == Dirent::deletedMimeType) {
-        g.add(0);
-      } else {
-        // If it is a classic article, get the clusterNumber (at offset 8)
-        auto clusterNumber = zimReader->read_uint<zim::cluster_index_type>(indexOffset+offset_t(8));
-        g.add(clusterNumber);
+    const entry_index_type entryCount = endIdx - startIdx;
+
+    // Reading the cluster number of all dirents is the costly part.
+    // Do it in parallel on slices of the entries.
+    const entry_index_type minSliceSize = 64*1024;
+    const unsigned threadCount = std::max(1U, std::min({std::thread::hardware_concurrency(), 16U, unsigned(entryCount / minSliceSize)}));
+    std::vector<cluster_index_type> clusterNumbers(entryCount);
+    std::vector<std::exception_ptr> errors(threadCount);
+    const auto readSlice = [&](unsigned slice) {
+      const entry_index_type begin = uint64_t(entryCount) * slice / threadCount;
+      const entry_index_type end = uint64_t(entryCount) * (slice+1) / threadCount;
+      try {
+        for ( auto i = begin; i < end; ++i ) {
+          clusterNumbers[i] = getClusterOrderKey(entry_index_t(startIdx + i));
+        }
+      } catch (...) {
+        errors[slice] = std::current_exception();
       }
+    };
+    std::vector<std::thread> threads;
+    for ( unsigned slice = 1; slice < threadCount; ++slice ) {
+      threads.emplace_back(readSlice, slice);
     }
-    m_articleListByCluster = g.getGroupedObjectIds();
+    readSlice(0);
+    for ( auto& thread : threads ) {
+      thread.join();
+    }
+    for ( const auto& error : errors ) {
+      if ( error ) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    Grouping<entry_index_type, cluster_index_type> g(startIdx, std::move(clusterNumbers));
+    return g.getGroupedObjectIds();
   }
 
-  entry_index_t FileImpl::getIndexByClusterOrder(entry_index_t idx) const
+  std::unique_ptr<const Reader> FileImpl::getClusterOrderListing() const
+  {
+    auto result = m_direntLookup->find('X', "listing/clusterOrdered/v1");
+    if (!result.first) {
+      return nullptr;
+    }
+    auto dirent = mp_pathDirentAccessor->getDirent(result.second);
+    if (dirent->isRedirect()) {
+      return nullptr;
+    }
+    auto cluster = getCluster(dirent->getClusterNumber());
+    const auto size = cluster->getBlobSize(dirent->getBlobNumber());
+    if (cluster->isCompressed()
+     || size.v != getUserEntryCount().v * sizeof(entry_index_type)) {
+      // This is a ZimFileFormatError.
+      // Let's be tolerant and sort the entries ourselves.
+      log_warn("Ignoring invalid cluster order listing");
+      return nullptr;
+    }
+    auto offset = getClusterOffset(dirent->getClusterNumber()) + cluster->getBlobOffset(dirent->getBlobNumber());
+    return sectionSubReader(*zimReader, "Cluster order listing", offset, size);
+  }
+
+  void FileImpl::prepareArticleListByCluster() const
   {
+    const auto listing = getClusterOrderListing();
+    if (listing && listing->size().v) {
+      // Mapped if possible, else read at once.
+      mp_clusterOrderListing.reset(new Buffer(listing->get_buffer(offset_t(0))));
+    } else {
+      m_articleListByCluster = sortEntriesByCluster();
+    }
+  }
+
+  void FileImpl::ensureArticleListByCluster() const
+  {
+    ensureIndexesLoaded();
     // Not using std::call_once because it is buggy. See the comment
     // in FileImpl::direntLookup().
-    if ( m_articleListByCluster.empty() ) {
+    if ( !m_articleListByClusterReady.load(std::memory_order_acquire) ) {
       std::lock_guard<std::mutex> lock(m_articleListByClusterMutex);
-      if ( m_articleListByCluster.empty() ) {
+      if ( !m_articleListByClusterReady.load(std::memory_order_acquire) ) {
         prepareArticleListByCluster();
+        m_articleListByClusterReady.store(true, std::memory_order_release);
       }
     }
-    if (idx.v >= m_articleListByCluster.size())
+  }
+
+  entry_index_t FileImpl::getIndexByClusterOrder(entry_index_t idx) const
+  {
+    ensureArticleListByCluster();
+    if (idx >= getUserEntryCount())
       throw std::out_of_range("entry index out of range");
-    return entry_index_t(m_articleListByCluster[idx.v]);
+    if (!mp_clusterOrderListing) {
+      return entry_index_t(m_articleListByCluster[idx.v]);
+    }
+    const entry_index_t entryIdx(fromLittleEndian<entry_index_type>(mp_clusterOrderListing->data(offset_t(idx.v * sizeof(entry_index_type)))));
+    if (entryIdx < getStartUserEntry() || entryIdx >= getEndUserEntry()) {
+      throw ZimFileFormatError("Invalid entry index in cluster order listing");
+    }
+    return entryIdx;
+  }
+
+  size_t FileImpl::lowerBoundInClusterOrder(cluster_index_type clusterIdx) const
+  {
+    // The cluster order key of the entries is sorted in the listing.
+    size_t first = 0;
+    size_t count = getUserEntryCount().v;
+    while ( count > 0 ) {
+      const auto step = count / 2;
+      const auto it = first + step;
+      if ( getClusterOrderKey(getIndexByClusterOrder(entry_index_t(it))) < clusterIdx ) {
+        first = it + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  std::unique_ptr<const Reader> FileImpl::getClusterChecksumListing() const
+  {
+    auto result = m_direntLookup->find('X', "listing/clusterChecksums/v1");
+    if (!result.first) {
+      return nullptr;
+    }
+    auto dirent = mp_pathDirentAccessor->getDirent(result.second);
+    if (dirent->isRedirect()) {
+      return nullptr;
+    }
+    auto cluster = getCluster(dirent->getClusterNumber());
+    const auto size = cluster->getBlobSize(dirent->getBlobNumber());
+    // The last cluster (containing the listing) cannot have a checksum.
+    if (cluster->isCompressed()
+     || size.v % CLUSTER_CHECKSUM_SIZE != 0
+     || size.v / CLUSTER_CHECKSUM_SIZE >= getCountClusters().v) {
+      log_warn("Ignoring invalid cluster checksum listing");
+      return nullptr;
+    }
+    auto offset = getClusterOffset(dirent->getClusterNumber()) + cluster->getBlobOffset(dirent->getBlobNumber());
+    return sectionSubReader(*zimReader, "Cluster checksum listing", offset, size);
+  }
+
+  const Reader* FileImpl::ensureClusterChecksumListing() const
+  {
+    ensureIndexesLoaded();
+    // Not using std::call_once because it is buggy. See the comment
+    // in FileImpl::direntLookup().
+    if ( !m_clusterChecksumListingReady.load(std::memory_order_acquire) ) {
+      std::lock_guard<std::mutex> lock(m_clusterChecksumListingMutex);
+      if ( !m_clusterChecksumListingReady.load(std::memory_order_acquire) ) {
+        mp_clusterChecksumListing = getClusterChecksumListing();
+        m_clusterChecksumListingReady.store(true, std::memory_order_release);
+      }
+    }
+    return mp_clusterChecksumListing.get();
+  }
+
+  cluster_index_t FileImpl::getChecksummedClusterCount() const
+  {
+    const auto listing = ensureClusterChecksumListing();
+    if (!listing) {
+      return cluster_index_t(0);
+    }
+    return cluster_index_t(cluster_index_type(listing->size().v / CLUSTER_CHECKSUM_SIZE));
+  }
+
+  bool FileImpl::checkClusterChecksum(cluster_index_t idx) const
+  {
+    if (idx >= getChecksummedClusterCount()) {
+      return true;
+    }
+
+    unsigned char expected[CLUSTER_CHECKSUM_SIZE];
+    mp_clusterChecksumListing->read(reinterpret_cast<char*>(expected),
+                                    offset_t(idx.v * CLUSTER_CHECKSUM_SIZE),
+                                    zsize_t(CLUSTER_CHECKSUM_SIZE));
+
+    // Checksummed clusters are written one after the other by the creator,
+    // so a cluster ends where the next one starts.
+    offset_t offset = getClusterOffset(idx);
+    const offset_t end = getClusterOffset(cluster_index_t(idx.v + 1));
+    if (end < offset || end.v > zimReader->size().v) {
+      return false;
+    }
+
+    struct zim_MD5_CTX md5ctx;
+    zim_MD5Init(&md5ctx);
+    hashRange(*zimReader, offset, end, &md5ctx);
+    unsigned char digest[CLUSTER_CHECKSUM_SIZE];
+    zim_MD5Final(digest, &md5ctx);
+    return std::equal(digest, digest + CLUSTER_CHECKSUM_SIZE, expected);
+  }
+
+  std::vector<zsize_t> FileImpl::getClusterSizes() const
+  {
+    // Clusters may not be stored in index order. The (compressed) size of a
+    // cluster is the distance to the next cluster in the file.
+    const cluster_index_type clusterCount = getCountClusters().v;
+    std::vector<std::pair<offset_t, cluster_index_type>> offsets;
+    offsets.reserve(clusterCount);
+    for ( cluster_index_type i = 0; i < clusterCount; ++i ) {
+      offsets.emplace_back(getClusterOffset(cluster_index_t(i)), i);
+    }
+    std::sort(offsets.begin(), offsets.end());
+
+    // The last cluster ends where the next part of the file starts. The
+    // creator writes the dirents just after the clusters, followed by the
+    // path and cluster pointer lists and the checksum.
+    ensureIndexesLoaded();
+    std::vector<offset_t> nextParts = {
+      offset_t(header.getPathPtrPos()),
+      offset_t(header.getClusterPtrPos()),
+      header.hasChecksum() ? offset_t(header.getChecksumPos()) : offset_t(zimReader->size().v)
+    };
+    if ( getCountArticles().v ) {
+      nextParts.push_back(mp_pathDirentAccessor->getOffset(entry_index_t(0)));
+    }
+    offset_t clustersEnd(zimReader->size().v);
+    if ( !offsets.empty() ) {
+      for ( const auto part : nextParts ) {
+        if ( part > offsets.back().first && part < clustersEnd ) {
+          clustersEnd = part;
+        }
+      }
+    }
+
+    std::vector<zsize_t> sizes(clusterCount);
+    for ( size_t i = 0; i < offsets.size(); ++i ) {
+      const auto end = (i+1 < offsets.size()) ? offsets[i+1].first : clustersEnd;
+      const auto begin = offsets[i].first;
+      sizes[offsets[i].second] = zsize_t(end > begin ? end.v - begin.v : 0);
+    }
+    return sizes;
+  }
+
+  std::vector<std::pair<offset_t, zsize_t>> FileImpl::getUncachedRanges(offset_t offset, zsize_t size) const
+  {
+    std::vector<std::pair<offset_t, zsize_t>> ranges;
+#ifndef _WIN32
+    const offset_type pageSize = sysconf(_SC_PAGESIZE);
+    const auto parts = getFileParts(offset, size);
+    for ( auto it = parts.first; it != parts.second; ++it ) {
+      const auto& range = it->first;
+      const FilePart* part = it->second;
+      const offset_t begin = std::max(offset, range.min);
+      const offset_t end = std::min(offset + size, range.max);
+      if ( begin >= end ) {
+        continue;
+      }
+      const offset_type localBegin = (begin - range.min + part->offset()).v;
+      const offset_type localEnd = localBegin + (end - begin).v;
+      const offset_type mapBegin = localBegin - localBegin % pageSize;
+      const size_t mapSize = localEnd - mapBegin;
+      const auto fd = part->fhandle();
+      void* const addr = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd->getNativeHandle(), mapBegin);
+      if ( addr == MAP_FAILED ) {
+        return {};
+      }
+      std::vector<unsigned char> residency((mapSize + pageSize - 1) / pageSize);
+#if defined(__linux__)
+      const auto ret = mincore(addr, mapSize, residency.data());
+#else
+      const auto ret = mincore(addr, mapSize, reinterpret_cast<char*>(residency.data()));
+#endif
+      munmap(addr, mapSize);
+      if ( ret != 0 ) {
+        return {};
+      }
+
+      for ( size_t i = 0; i < residency.size(); ++i ) {
+        if ( residency[i] & 1 ) {
+          continue;
+        }
+        const offset_type pageBegin = std::max(localBegin, mapBegin + i * pageSize);
+        const offset_type pageEnd = std::min(localEnd, mapBegin + (i+1) * pageSize);
+        const offset_t rangeBegin = offset_t(pageBegin) - part->offset() + range.min;
+        if ( !ranges.empty() && ranges.back().first + ranges.back().second == rangeBegin ) {
+          ranges.back().second += zsize_t(pageEnd - pageBegin);
+        } else {
+          ranges.emplace_back(rangeBegin, zsize_t(pageEnd - pageBegin));
+        }
+      }
+    }
+#endif
+    return ranges;
+  }
+
+  void FileImpl::dropFromPageCache(offset_t offset, zsize_t size) const
+  {
+#ifndef _WIN32
+    const auto parts = getFileParts(offset, size);
+    for ( auto it = parts.first; it != parts.second; ++it ) {
+      const auto& range = it->first;
+      const FilePart* part = it->second;
+      const offset_t begin = std::max(offset, range.min);
+      const offset_t end = std::min(offset + size, range.max);
+      if ( begin >= end ) {
+        continue;
+      }
+      const offset_t localOffset = begin - range.min + part->offset();
+      const auto fd = part->fhandle();
+      posix_fadvise(fd->getNativeHandle(), localOffset.v, (end - begin).v, POSIX_FADV_DONTNEED);
+    }
+#endif
+  }
+
+  std::vector<entry_index_type> FileImpl::getClusterOrderPartitions(size_t partCount) const
+  {
+    ensureArticleListByCluster();
+    const entry_index_type entryCount = getUserEntryCount().v;
+    std::vector<entry_index_type> partitions(1, 0);
+    if ( entryCount == 0 ) {
+      partitions.resize(partCount+1, 0);
+      return partitions;
+    }
+
+    // The entries are sorted by cluster (redirects being grouped with
+    // cluster 0). Balance the parts on the compressed size of the clusters
+    // between the first and the last entry.
+    const auto firstCluster = getClusterOrderKey(getIndexByClusterOrder(entry_index_t(0)));
+    const auto lastCluster = getClusterOrderKey(getIndexByClusterOrder(entry_index_t(entryCount-1)));
+    const auto clusterSizes = getClusterSizes();
+    std::vector<size_type> weights;
+    for ( auto c = firstCluster; c <= lastCluster && c < clusterSizes.size(); ++c ) {
+      weights.push_back(clusterSizes[c].v);
+    }
+    if ( std::accumulate(weights.begin(), weights.end(), size_type(0)) == 0 ) {
+      std::fill(weights.begin(), weights.end(), 1);
+    }
+
+    // cumulatedWeights[g] is the weight of the clusters before firstCluster+g.
+    std::vector<size_type> cumulatedWeights(1, 0);
+    std::partial_sum(weights.begin(), weights.end(), std::back_inserter(cumulatedWeights));
+    const long double totalWeight = cumulatedWeights.back();
+
+    for ( size_t k = 1; k < partCount; ++k ) {
+      const auto target = size_type(totalWeight * k / partCount);
+      const auto it = std::lower_bound(cumulatedWeights.begin(), cumulatedWeights.end(), target);
+      const cluster_index_type clusterIdx = firstCluster + std::distance(cumulatedWeights.begin(), it);
+      partitions.push_back(clusterIdx == firstCluster ? 0 : lowerBoundInClusterOrder(clusterIdx));
+    }
+    partitions.push_back(entryCount);
+    return partitions;
   }
 
   size_t FileImpl::getMaxBlobCountInCluster(cluster_index_t idx) const
@@ -513,8 +985,32 @@ private: // data
     return Cluster::read(*zimReader, clusterOffset, maxBlobCountInCluster);
   }
 
+  std::shared_ptr<const Dirent> FileImpl::getUncachedDirent(entry_index_t idx) const
+  {
+    ensureIndexesLoaded();
+    return mp_pathDirentAccessor->getUncachedDirent(idx);
+  }
+
+  ClusterHandle FileImpl::getCachedCluster(cluster_index_t idx) const
+  {
+    ClusterHandle cluster;
+    const cluster_index_type clusterIndex = idx.v;
+    getClusterCache().getIfReady(std::make_tuple(this, clusterIndex), cluster);
+    return cluster;
+  }
+
+  ClusterHandle FileImpl::getUncachedCluster(cluster_index_t idx) const
+  {
+    ensureIndexesLoaded();
+    if (idx >= getCountClusters())
+      throw ZimFileFormatError("cluster index out of range");
+
+    return readCluster(idx);
+  }
+
   ClusterHandle FileImpl::getCluster(cluster_index_t idx) const
   {
+    ensureIndexesLoaded();
     if (idx >= getCountClusters())
       throw ZimFileFormatError("cluster index out of range");
 
@@ -542,8 +1038,20 @@ private: // data
     return cluster;
   }
 
+  std::unique_ptr<IStreamReader> FileImpl::getBlobStream(cluster_index_t clusterIdx, blob_index_t blobIdx, zsize_t* blobSize) const
+  {
+    ensureIndexesLoaded();
+    if (clusterIdx >= getCountClusters())
+      throw ZimFileFormatError("cluster index out of range");
+
+    const offset_t clusterOffset(getClusterOffset(clusterIdx));
+    const auto maxBlobCountInCluster = getMaxBlobCountInCluster(clusterIdx);
+    return Cluster::openBlobStream(*zimReader, clusterOffset, blobIdx, maxBlobCountInCluster, blobSize);
+  }
+
   offset_t FileImpl::getClusterOffset(cluster_index_t idx) const
   {
+    ensureIndexesLoaded();
     return readOffset(*clusterOffsetReader, idx.v);
   }
 
@@ -557,18 +1065,21 @@ private: // data
 
   entry_index_t FileImpl::getNamespaceBeginOffset(char ch) const
   {
+    ensureIndexesLoaded();
     log_trace("getNamespaceBeginOffset(" << ch << ')');
     return m_direntLookup->getNamespaceRangeBegin(ch);
   }
 
   entry_index_t FileImpl::getNamespaceEndOffset(char ch) const
   {
+    ensureIndexesLoaded();
     log_trace("getNamespaceEndOffset(" << ch << ')');
     return m_direntLookup->getNamespaceRangeEnd(ch);
   }
 
   const std::string& FileImpl::getMimeType(uint16_t idx) const
   {
+    ensureIndexesLoaded();
     if (idx >= mimeTypes.size())
       throw ZimFileFormatError(Formatter() << "unknown mime type code " << idx);
 
@@ -602,11 +1113,43 @@ private: // data
     }
   }
 
+  bool FileImpl::verifySplitChecksum()
+  {
+    const offset_t checksumPos(header.getChecksumPos());
+    unsigned char chksumCalc[16];
+    try {
+      offset_t clustersPos(checksumPos);
+      if (getCountClusters().v) {
+        clustersPos = std::min(getClusterOffset(cluster_index_t(0)), checksumPos);
+      }
+
+      struct zim_MD5_CTX md5ctx;
+      zim_MD5Init(&md5ctx);
+      hashRange(*zimReader, clustersPos, checksumPos, &md5ctx);
+      unsigned char clustersDigest[16];
+      zim_MD5Final(clustersDigest, &md5ctx);
+
+      zim_MD5Init(&md5ctx);
+      hashRange(*zimReader, offset_t(0), clustersPos, &md5ctx);
+      zim_MD5Update(&md5ctx, clustersDigest, 16);
+      zim_MD5Final(chksumCalc, &md5ctx);
+    } catch (std::exception& e) {
+      log_warn("error while reading file: " << e.what());
+      return false;
+    }
+
+    auto chksumFile = zimReader->get_buffer(checksumPos, zsize_t(16));
+    return std::memcmp(chksumFile.data(), chksumCalc, 16) == 0;
+  }
+
   bool FileImpl::verify()
   {
     if (!header.hasChecksum())
       return false;
 
+    if (header.useSplitChecksum())
+      return verifySplitChecksum();
+
     struct zim_MD5_CTX md5ctx;
     zim_MD5Init(&md5ctx);
 
@@ -674,15 +1217,126 @@ private: // data
     return zimFile->is_multiPart();
   }
 
-  bool FileImpl::checkIntegrity(IntegrityCheck checkType) {
+namespace
+{
+
+// Number of dirents (resp. clusters) checked in one go by a worker.
+const size_t DIRENT_CHECK_CHUNK_SIZE = 4096;
+const size_t CLUSTER_CHECK_CHUNK_SIZE = 8;
+
+typedef std::function<bool(size_t begin, size_t end)> RangeCheck;
+
+// Runs `checkRange` over [0, count) split in chunks of `chunkSize` items
+// shared between `threadCount` threads (the calling one included, 0 means one
+// thread per core). The check stops at the first failing chunk or as soon as
+// `progress` returns false. `progress` is only called from the calling thread.
+bool runRangeCheck(IntegrityCheck checkType,
+                   unsigned threadCount,
+                   const IntegrityCheckProgress& progress,
+                   size_t count,
+                   size_t chunkSize,
+                   const RangeCheck& checkRange)
+{
+  const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+  if ( threadCount == 0 ) {
+    threadCount = std::thread::hardware_concurrency();
+  }
+  threadCount = unsigned(std::max<size_t>(1, std::min<size_t>(threadCount, chunkCount)));
+
+  std::atomic<size_t> nextChunk(0);
+  std::atomic<size_t> checkedCount(0);
+  std::atomic<bool> stop(false);
+  std::atomic<bool> failed(false);
+  std::mutex errorMutex;
+  std::exception_ptr error;
+
+  // Checks the next chunk, returns false if there is nothing left to do.
+  const auto checkNextChunk = [&]() {
+    const size_t chunk = nextChunk++;
+    if ( stop || chunk >= chunkCount ) {
+      return false;
+    }
+    const size_t begin = chunk * chunkSize;
+    const size_t end = std::min(count, begin + chunkSize);
+    try {
+      if ( !checkRange(begin, end) ) {
+        failed = true;
+        stop = true;
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if ( !error ) {
+        error = std::current_exception();
+      }
+      stop = true;
+    }
+    checkedCount += end - begin;
+    return true;
+  };
+
+  std::vector<std::thread> threads;
+  for ( unsigned i = 1; i < threadCount; ++i ) {
+    threads.emplace_back([&]() { while ( checkNextChunk() ) {} });
+  }
+
+  bool cancelled = false;
+  while ( checkNextChunk() ) {
+    if ( progress && !progress(checkType, checkedCount, count) ) {
+      cancelled = true;
+      stop = true;
+    }
+  }
+  for ( auto& thread : threads ) {
+    thread.join();
+  }
+
+  if ( error ) {
+    std::rethrow_exception(error);
+  }
+  if ( !failed && !cancelled && progress ) {
+    cancelled = !progress(checkType, count, count);
+  }
+  return !failed && !cancelled;
+}
+
+} // unnamed namespace
+
+  bool FileImpl::checkIntegrity(IntegrityCheck checkType, unsigned threadCount, const IntegrityCheckProgress& progress) {
+    ensureIndexesLoaded();
+    const auto runCheck = [&](size_t count, size_t chunkSize, const RangeCheck& checkRange) {
+      return runRangeCheck(checkType, threadCount, progress, count, chunkSize, checkRange);
+    };
+    const size_t articleCount = getCountArticles().v;
+    const size_t clusterCount = getCountClusters().v;
     switch(checkType) {
-      case IntegrityCheck::CHECKSUM: return FileImpl::checkChecksum();
-      case IntegrityCheck::DIRENT_PTRS: return FileImpl::checkDirentPtrs();
-      case IntegrityCheck::DIRENT_ORDER: return FileImpl::checkDirentOrder();
-      case IntegrityCheck::TITLE_INDEX: return FileImpl::checkTitleIndex();
-      case IntegrityCheck::CLUSTER_PTRS: return FileImpl::checkClusterPtrs();
-      case IntegrityCheck::CLUSTERS_OFFSETS: return FileImpl::checkClusters();
-      case IntegrityCheck::DIRENT_MIMETYPES: return FileImpl::checkDirentMimeTypes();
+      case IntegrityCheck::CHECKSUM:
+        return runCheck(1, 1, [this](size_t, size_t) { return checkChecksum(); });
+      case IntegrityCheck::DIRENT_PTRS:
+        return runCheck(articleCount, DIRENT_CHECK_CHUNK_SIZE, [this](size_t begin, size_t end) {
+          return checkDirentPtrs(entry_index_type(begin), entry_index_type(end));
+        });
+      case IntegrityCheck::DIRENT_ORDER:
+        return runCheck(articleCount, DIRENT_CHECK_CHUNK_SIZE, [this](size_t begin, size_t end) {
+          return checkDirentOrder(entry_index_type(begin), entry_index_type(end));
+        });
+      case IntegrityCheck::TITLE_INDEX:
+        return checkTitleIndex(threadCount, progress);
+      case IntegrityCheck::CLUSTER_PTRS:
+        return runCheck(clusterCount, DIRENT_CHECK_CHUNK_SIZE, [this](size_t begin, size_t end) {
+          return checkClusterPtrs(cluster_index_type(begin), cluster_index_type(end));
+        });
+      case IntegrityCheck::CLUSTERS_OFFSETS:
+        return runCheck(clusterCount, CLUSTER_CHECK_CHUNK_SIZE, [this](size_t begin, size_t end) {
+          return checkClusters(cluster_index_type(begin), cluster_index_type(end));
+        });
+      case IntegrityCheck::DIRENT_MIMETYPES:
+        return runCheck(articleCount, DIRENT_CHECK_CHUNK_SIZE, [this](size_t begin, size_t end) {
+          return checkDirentMimeTypes(entry_index_type(begin), entry_index_type(end));
+        });
+      case IntegrityCheck::CLUSTER_CHECKSUMS:
+        return runCheck(getChecksummedClusterCount().v, CLUSTER_CHECK_CHUNK_SIZE, [this](size_t begin, size_t end) {
+          return checkClusterChecksums(cluster_index_type(begin), cluster_index_type(end));
+        });
       case IntegrityCheck::COUNT: ASSERT("shouldn't have reached here", ==, "");
     }
     return false;
@@ -696,14 +1350,13 @@ private: // data
     return true;
   }
 
-  bool FileImpl::checkDirentPtrs() {
-    const entry_index_type articleCount = getCountArticles().v;
+  bool FileImpl::checkDirentPtrs(entry_index_type begin, entry_index_type end) {
     const offset_t validDirentRangeStart(80); // XXX: really???
     const offset_t validDirentRangeEnd = header.hasChecksum()
                                        ? offset_t(header.getChecksumPos())
                                        : offset_t(zimReader->size().v);
     const zsize_t direntMinSize(11);
-    for ( entry_index_type i = 0; i < articleCount; ++i )
+    for ( entry_index_type i = begin; i < end; ++i )
     {
       const auto offset = mp_pathDirentAccessor->getOffset(entry_index_t(i));
       if ( offset < validDirentRangeStart ||
@@ -715,10 +1368,12 @@ private: // data
     return true;
   }
 
-  bool FileImpl::checkDirentOrder() {
-    const entry_index_type articleCount = getCountArticles().v;
+  bool FileImpl::checkDirentOrder(entry_index_type begin, entry_index_type end) {
     std::shared_ptr<const Dirent> prevDirent;
-    for ( entry_index_type i = 0; i < articleCount; ++i )
+    if ( begin > 0 ) {
+      prevDirent = mp_pathDirentAccessor->getDirent(entry_index_t(begin-1));
+    }
+    for ( entry_index_type i = begin; i < end; ++i )
     {
       const std::shared_ptr<const Dirent> dirent = mp_pathDirentAccessor->getDirent(entry_index_t(i));
       if ( prevDirent && !(prevDirent->getLongPath() < dirent->getLongPath()) )
@@ -733,9 +1388,8 @@ private: // data
     return true;
   }
 
-  bool FileImpl::checkClusters() {
-    const cluster_index_type clusterCount = getCountClusters().v;
-    for ( cluster_index_type i = 0; i < clusterCount; ++i )
+  bool FileImpl::checkClusters(cluster_index_type begin, cluster_index_type end) {
+    for ( cluster_index_type i = begin; i < end; ++i )
     {
       // Force a read of each clusters (which will throw ZimFileFormatError in case of error)
       try {
@@ -748,14 +1402,24 @@ private: // data
     return true;
   }
 
-  bool FileImpl::checkClusterPtrs() {
-    const cluster_index_type clusterCount = getCountClusters().v;
+  bool FileImpl::checkClusterChecksums(cluster_index_type begin, cluster_index_type end) {
+    for ( cluster_index_type i = begin; i < end; ++i )
+    {
+      if ( !checkClusterChecksum(cluster_index_t(i)) ) {
+        std::cerr << "Checksum of cluster " << i << " doesn't match" << std::endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool FileImpl::checkClusterPtrs(cluster_index_type begin, cluster_index_type end) {
     const offset_t validClusterRangeStart(80); // XXX: really???
     const offset_t validClusterRangeEnd = header.hasChecksum()
                                        ? offset_t(header.getChecksumPos())
                                        : offset_t(zimReader->size().v);
     const zsize_t clusterMinSize(1); // XXX
-    for ( cluster_index_type i = 0; i < clusterCount; ++i )
+    for ( cluster_index_type i = begin; i < end; ++i )
     {
       const auto offset = readOffset(*clusterOffsetReader, i);
       if ( offset < validClusterRangeStart ||
@@ -775,10 +1439,15 @@ std::string pseudoTitle(const Dirent& d)
   return std::string(1, d.getNamespace()) + '/' + d.getTitle();
 }
 
-bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type totalCount) {
-  const entry_index_type direntCount = accessor.getDirentCount().v;
+bool checkTitleListing(const IndirectDirentAccessor& accessor,
+                       entry_index_type totalCount,
+                       entry_index_type begin,
+                       entry_index_type end) {
   std::shared_ptr<const Dirent> prevDirent;
-  for ( entry_index_type i = 0; i < direntCount; ++i ) {
+  if ( begin > 0 ) {
+    prevDirent = accessor.getDirent(title_index_t(begin-1));
+  }
+  for ( entry_index_type i = begin; i < end; ++i ) {
     if (accessor.getDirectIndex(title_index_t(i)).v >= totalCount) {
       std::cerr << "Invalid title index entry." << std::endl;
       return false;
@@ -796,31 +1465,49 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
 
 } // unnamed namespace
 
-  bool FileImpl::checkTitleIndex() {
+  bool FileImpl::checkTitleIndex(unsigned threadCount, const IntegrityCheckProgress& progress) {
     const entry_index_type articleCount = getCountArticles().v;
 
-    auto ret = true;
+    std::vector<std::unique_ptr<IndirectDirentAccessor>> listings;
     if (header.hasTitleListingV0()) {
       offset_t titleOffset(header.getTitleIdxPos());
       zsize_t  titleSize(sizeof(entry_index_type)*header.getArticleCount());
-      auto titleDirentAccessor = getTitleAccessor(titleOffset, titleSize, "Full Title index table");
-      ret = checkTitleListing(*titleDirentAccessor, articleCount);
+      listings.push_back(getTitleAccessor(titleOffset, titleSize, "Full Title index table"));
     }
 
-    auto titleDirentAccessor = std::unique_ptr<IndirectDirentAccessor>();
     auto result = m_direntLookup->find('X', "listing/titleOrdered/v1");
     if (result.first) {
-      titleDirentAccessor = getTitleAccessorV1(result.second);
+      auto titleDirentAccessor = getTitleAccessorV1(result.second);
+      if (titleDirentAccessor) {
+        listings.push_back(std::move(titleDirentAccessor));
+      }
     }
-    if (titleDirentAccessor) {
-      ret &= checkTitleListing(*titleDirentAccessor, articleCount);
+
+    // All the listings are checked as one range of concatenated entries.
+    size_t totalSize = 0;
+    for ( const auto& listing : listings ) {
+      totalSize += listing->getDirentCount().v;
     }
-    return ret;
+    const auto checkRange = [&](size_t begin, size_t end) {
+      auto ret = true;
+      size_t listingStart = 0;
+      for ( const auto& listing : listings ) {
+        const size_t listingEnd = listingStart + listing->getDirentCount().v;
+        if ( begin < listingEnd && end > listingStart ) {
+          ret &= checkTitleListing(*listing, articleCount,
+                                   entry_index_type(std::max(begin, listingStart) - listingStart),
+                                   entry_index_type(std::min(end, listingEnd) - listingStart));
+        }
+        listingStart = listingEnd;
+      }
+      return ret;
+    };
+    return runRangeCheck(IntegrityCheck::TITLE_INDEX, threadCount, progress,
+                         totalSize, DIRENT_CHECK_CHUNK_SIZE, checkRange);
   }
 
-  bool FileImpl::checkDirentMimeTypes() {
-    const entry_index_type articleCount = getCountArticles().v;
-    for ( entry_index_type i = 0; i < articleCount; ++i )
+  bool FileImpl::checkDirentMimeTypes(entry_index_type begin, entry_index_type end) {
+    for ( entry_index_type i = begin; i < end; ++i )
     {
       const auto dirent = mp_pathDirentAccessor->getDirent(entry_index_t(i));
       if ( dirent->isArticle() && dirent->getMimeType() >= mimeTypes.size() ) {
@@ -834,20 +1521,23 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
   }
 
   size_t FileImpl::getDirentCacheMaxSize() const {
+    ensureIndexesLoaded();
     return mp_pathDirentAccessor->getMaxCacheSize();
   }
   size_t FileImpl::getDirentCacheCurrentSize() const {
+    ensureIndexesLoaded();
     return mp_pathDirentAccessor->getCurrentCacheSize();
   }
   void FileImpl::setDirentCacheMaxSize(size_t nbDirents) {
+    ensureIndexesLoaded();
     mp_pathDirentAccessor->setMaxCacheSize(nbDirents);
   }
 
-  ItemDataDirectAccessInfo FileImpl::getDirectAccessInformation(cluster_index_t clusterIdx, blob_index_t blobIdx) const
+  std::pair<const FilePart*, offset_t> FileImpl::locateRawBlob(cluster_index_t clusterIdx, blob_index_t blobIdx) const
   {
     auto cluster = getCluster(clusterIdx);
     if (cluster->isCompressed()) {
-      return ItemDataDirectAccessInfo();
+      return {nullptr, offset_t(0)};
     }
 
     auto full_offset = getBlobOffset(clusterIdx, blobIdx);
@@ -856,13 +1546,51 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
     auto first_part = part_its.first;
     if (++part_its.first != part_its.second) {
      // The content is split on two parts. We cannot have direct access
-      return ItemDataDirectAccessInfo();
+      return {nullptr, offset_t(0)};
     }
     auto range = first_part->first;
     auto part = first_part->second;
     const offset_type logical_local_offset(full_offset - range.min);
-    const auto physical_local_offset = logical_local_offset + part->offset().v;
-    return ItemDataDirectAccessInfo(part->filename(), physical_local_offset);
+    return {part, offset_t(logical_local_offset + part->offset().v)};
+  }
+
+  ItemDataDirectAccessInfo FileImpl::getDirectAccessInformation(cluster_index_t clusterIdx, blob_index_t blobIdx) const
+  {
+    const auto location = locateRawBlob(clusterIdx, blobIdx);
+    if (!location.first) {
+      return ItemDataDirectAccessInfo();
+    }
+    return ItemDataDirectAccessInfo(location.first->filename(), location.second.v);
+  }
+
+  namespace
+  {
+    // Keep the file descriptor opened (even if the fd pool closes it) as long
+    // as the user holds the native fd.
+    struct NativeFdHolder {
+      PooledFD::FDSharedPtr fd;
+      int nativeFd;
+    };
+  }
+
+  ItemDataDirectFdAccessInfo FileImpl::getDirectFdAccessInformation(cluster_index_t clusterIdx, blob_index_t blobIdx) const
+  {
+#ifdef _WIN32
+    // We don't expose native handles on Windows.
+    return ItemDataDirectFdAccessInfo();
+#else
+    const auto location = locateRawBlob(clusterIdx, blobIdx);
+    if (!location.first) {
+      return ItemDataDirectFdAccessInfo();
+    }
+    const auto fd = location.first->fhandle();
+    const auto holder = std::make_shared<NativeFdHolder>(NativeFdHolder{fd, fd->getNativeHandle()});
+    const auto blobSize = getCluster(clusterIdx)->getBlobSize(blobIdx);
+    return ItemDataDirectFdAccessInfo(
+      std::shared_ptr<const int>(holder, &holder->nativeFd),
+      location.second.v,
+      blobSize.v);
+#endif
   }
 
   Blob FileImpl::getBlob(const Dirent& dirent, offset_t offset) const
@@ -879,6 +1607,66 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
     return cluster->getBlob(dirent.getBlobNumber(), offset, size);
   }
 
+  std::vector<Blob> FileImpl::getBlobChunks(const Dirent& dirent, offset_t offset) const
+  {
+    auto cluster = getCluster(dirent.getClusterNumber());
+    auto blobIdx = dirent.getBlobNumber();
+    auto size = zsize_t(cluster->getBlobSize(blobIdx).v - offset.v);
+    return cluster->getBlobChunks(blobIdx, offset, size);
+  }
+
+  std::vector<Blob> FileImpl::getBlobChunks(const Dirent& dirent, offset_t offset, zsize_t size) const
+  {
+    auto cluster = getCluster(dirent.getClusterNumber());
+    return cluster->getBlobChunks(dirent.getBlobNumber(), offset, size);
+  }
+
+  std::shared_ptr<const TitlePrefixIndex> FileImpl::getTitlePrefixIndex()
+  {
+    std::lock_guard<std::mutex> lock(m_titlePrefixIndexMutex);
+    if (mp_titlePrefixIndex) {
+      return mp_titlePrefixIndex;
+    }
+
+    // Same range of titles as `Archive::iterByTitle()`.
+    entry_index_type begin, end;
+    if (hasFrontArticlesIndex()) {
+      begin = 0;
+      end = getFrontEntryCount().v;
+    } else if (!hasNewNamespaceScheme()) {
+      begin = getNamespaceBeginOffset('A').v;
+      end = getNamespaceEndOffset('A').v;
+    } else {
+      begin = getStartUserEntry().v;
+      end = getEndUserEntry().v;
+    }
+
+    std::vector<TitlePrefixIndex::Title> titles;
+    titles.reserve(end - begin);
+    for (auto idx = begin; idx < end; ++idx) {
+      const title_index_t titleIdx(idx);
+      titles.push_back({getDirentByTitle(titleIdx)->getTitle(), getIndexByTitle(titleIdx).v});
+    }
+    mp_titlePrefixIndex = std::make_shared<const TitlePrefixIndex>(std::move(titles));
+    return mp_titlePrefixIndex;
+  }
+
+  std::shared_ptr<const TitlePrefixListing> FileImpl::getTitlePrefixListing()
+  {
+    std::lock_guard<std::mutex> lock(m_titlePrefixListingMutex);
+    if (m_titlePrefixListingLoaded) {
+      return mp_titlePrefixListing;
+    }
+
+    const auto r = findx('X', "listing/titlePrefixes/v1");
+    if (r.first) {
+      const auto dirent = getDirent(r.second);
+      mp_titlePrefixListing = std::make_shared<const TitlePrefixListing>(getBlob(*dirent));
+    }
+    m_titlePrefixListingLoaded = true;
+    return mp_titlePrefixListing;
+  }
+
 #ifdef ENABLE_XAPIAN
   std::shared_ptr<XapianDb> FileImpl::loadXapianDb() {
     FileImpl::FindxResult r;
@@ -893,13 +1681,22 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
     if (xapianDirent->isRedirect()) {
       return nullptr;
     }
-    auto accessInfo = getDirectAccessInformation(xapianDirent->getClusterNumber(), xapianDirent->getBlobNumber());
-    if (!accessInfo.isValid()) {
+    const auto clusterIdx = xapianDirent->getClusterNumber();
+    const auto blobIdx = xapianDirent->getBlobNumber();
+    // Prefer the fd we already hold over reopening the file by its path.
+    // (Not available on Windows)
+    auto fdAccessInfo = getDirectFdAccessInformation(clusterIdx, blobIdx);
+    auto accessInfo = getDirectAccessInformation(clusterIdx, blobIdx);
+    if (!fdAccessInfo.isValid() && !accessInfo.isValid()) {
       return nullptr;
     }
 
     Xapian::Database xapianDatabase;
-    if (!getDbFromAccessInfo(accessInfo, xapianDatabase)) {
+    if (fdAccessInfo.isValid()) {
+      if (!getDbFromAccessInfo(fdAccessInfo, xapianDatabase)) {
+        return nullptr;
+      }
+    } else if (!getDbFromAccessInfo(accessInfo, xapianDatabase)) {
       return nullptr;
     }
 
@@ -918,7 +1715,7 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
         }
       } catch(...) {}
 
-      return std::make_shared<XapianDb>(xapianDatabase, defaultLanguage);
+      return std::make_shared<XapianDb>(xapianDatabase, defaultLanguage, fdAccessInfo, accessInfo);
     } catch (Xapian::DatabaseError& e) {
       // Do nothing
     }
@@ -926,10 +1723,11 @@ bool checkTitleListing(const IndirectDirentAccessor& accessor, entry_index_type
   }
 
   std::shared_ptr<XapianDb> FileImpl::getXapianDb() {
+    ensureIndexesLoaded();
     if (!m_xapianDbCreated.load(std::memory_order_acquire)) {
       std::lock_guard<std::mutex> lock(m_xapianDbCreationMutex);
       if (!m_xapianDbCreated.load(std::memory_order_acquire)) {
-        loadXapianDb();
+        mp_xapianDb = loadXapianDb();
         m_xapianDbCreated.store(true, std::memory_order_release);
       }
     }
@@ -29,6 +29,7 @@
 #include <memory>
 #include <zim/zim.h>
 #include <mutex>
+#include <thread>
 #include "concurrent_cache.h"
 #include "_dirent.h"
 #include "dirent_accessor.h"
@@ -47,6 +48,8 @@
 namespace zim
 {
   class FileImpl;
+  class TitlePrefixIndex;
+  class TitlePrefixListing;
   typedef std::shared_ptr<const Cluster> ClusterHandle;
   typedef std::tuple<const FileImpl*, cluster_index_type> ClusterRef;
   typedef ConcurrentCache<ClusterRef, ClusterHandle, ClusterMemorySize> ClusterCache;
@@ -58,11 +61,19 @@ namespace zim
       std::shared_ptr<Reader> zimReader;
       std::shared_ptr<DirentReader> direntReader;
       Fileheader header;
+      const OpenConfig m_openConfig;
+
+      // Everything below the header is loaded by loadIndexes(), either at
+      // construction or (in lazy open mode) on first access.
+      mutable std::atomic_bool m_indexesLoaded;
+      mutable std::mutex m_indexesLoadingMutex;
+      mutable std::atomic<std::thread::id> m_indexesLoadingThread;
 
       std::unique_ptr<const Reader> clusterOffsetReader;
 
       std::shared_ptr<const DirectDirentAccessor> mp_pathDirentAccessor;
       std::unique_ptr<const IndirectDirentAccessor> mp_titleDirentAccessor;
+      std::unique_ptr<const IndirectDirentAccessor> mp_foldedTitleDirentAccessor;
 
       const bool m_hasFrontArticlesIndex;
       const entry_index_t m_startUserEntry;
@@ -71,9 +82,20 @@ namespace zim
       typedef std::vector<std::string> MimeTypes;
       MimeTypes mimeTypes;
 
+      // The user entries in cluster order. Mapped (or loaded) from the
+      // `listing/clusterOrdered/v1` listing if the archive has one, else
+      // sorted in memory on first use.
+      mutable std::unique_ptr<const Buffer> mp_clusterOrderListing;
       mutable std::vector<entry_index_type> m_articleListByCluster;
+      mutable std::atomic_bool m_articleListByClusterReady;
       mutable std::mutex m_articleListByClusterMutex;
 
+      // The MD5 checksums of the first clusters, read from the
+      // `listing/clusterChecksums/v1` listing on first use.
+      mutable std::unique_ptr<const Reader> mp_clusterChecksumListing;
+      mutable std::atomic_bool m_clusterChecksumListingReady;
+      mutable std::mutex m_clusterChecksumListingMutex;
+
       struct DirentLookupConfig
       {
         typedef DirectDirentAccessor DirentAccessorType;
@@ -106,6 +128,13 @@ namespace zim
       mutable std::atomic_bool m_xapianDbCreated;
 #endif
 
+      std::shared_ptr<const TitlePrefixIndex> mp_titlePrefixIndex;
+      std::mutex m_titlePrefixIndexMutex;
+
+      std::shared_ptr<const TitlePrefixListing> mp_titlePrefixListing;
+      bool m_titlePrefixListingLoaded = false;
+      std::mutex m_titlePrefixListingMutex;
+
     public:
       using FindxResult = std::pair<bool, entry_index_t>;
       using FindxTitleResult = std::pair<bool, title_index_t>;
@@ -124,28 +153,69 @@ namespace zim
       const Fileheader& getFileheader() const  { return header; }
       zsize_t getFilesize() const;
       bool hasNewNamespaceScheme() const { return header.useNewNamespaceScheme(); }
-      bool hasFrontArticlesIndex() const { return m_hasFrontArticlesIndex; }
+      bool hasFrontArticlesIndex() const { ensureIndexesLoaded(); return m_hasFrontArticlesIndex; }
 
       FileCompound::PartRange getFileParts(offset_t offset, zsize_t size) const;
       std::shared_ptr<const Dirent> getDirent(entry_index_t idx) const;
+      // Non blocking versions of getDirent() and getCluster().
+      // Return nullptr if the dirent/cluster is not (yet) in the cache.
+      std::shared_ptr<const Dirent> getCachedDirent(entry_index_t idx) const;
+      std::shared_ptr<const Cluster> getCachedCluster(cluster_index_t idx) const;
+      // Read a dirent without going through (nor filling) the dirent cache.
+      std::shared_ptr<const Dirent> getUncachedDirent(entry_index_t idx) const;
       std::shared_ptr<const Dirent> getDirentByTitle(title_index_t idx) const;
       entry_index_t getIndexByTitle(title_index_t idx) const;
       entry_index_t getIndexByClusterOrder(entry_index_t idx) const;
+      // Sort the user entries by cluster, reading all dirents.
+      std::vector<entry_index_type> sortEntriesByCluster() const;
+      // Split the entries (in cluster order) in `partCount` ranges of whole
+      // clusters, balanced by compressed size.
+      // Return the boundaries of the ranges (partCount+1 positions).
+      std::vector<entry_index_type> getClusterOrderPartitions(size_t partCount) const;
+      // The number of clusters having a checksum stored in the archive.
+      // Those are always the first clusters.
+      cluster_index_t getChecksummedClusterCount() const;
+      // Compare the checksum of the (raw) cluster data with the stored one.
+      // Return true if they match or if there is no checksum for the cluster.
+      bool checkClusterChecksum(cluster_index_t idx) const;
       entry_index_t getCountArticles() const { return entry_index_t(header.getArticleCount()); }
 
       FindxResult findx(char ns, const std::string &path) const;
       FindxResult findx(const std::string &path) const;
       FindxResult findxMetadata(const std::string &name) const;
       FindxTitleResult findxByTitle(char ns, const std::string& title);
+      // The folded title listing (front articles sorted by `foldTitle()` of
+      // their title) is optional.
+      bool hasFoldedTitleIndex() const { ensureIndexesLoaded(); return bool(mp_foldedTitleDirentAccessor); }
+      // The range of the positions in the folded title listing of the entries
+      // whose folded title starts with `foldedPrefix`.
+      std::pair<title_index_t, title_index_t> findFoldedTitleRange(const std::string& foldedPrefix) const;
+      entry_index_t getIndexByFoldedTitle(title_index_t idx) const;
 
       Blob getBlob(const Dirent& dirent, offset_t offset = offset_t(0)) const;
       Blob getBlob(const Dirent& dirent, offset_t offset, zsize_t size) const;
+      std::vector<Blob> getBlobChunks(const Dirent& dirent, offset_t offset = offset_t(0)) const;
+      std::vector<Blob> getBlobChunks(const Dirent& dirent, offset_t offset, zsize_t size) const;
 
       std::shared_ptr<const Cluster> getCluster(cluster_index_t idx) const;
+      // Read a cluster without going through (nor filling) the cluster cache.
+      std::shared_ptr<const Cluster> getUncachedCluster(cluster_index_t idx) const;
+      // Open a stream on a blob data without loading (nor caching) its cluster.
+      std::unique_ptr<IStreamReader> getBlobStream(cluster_index_t clusterIdx, blob_index_t blobIdx, zsize_t* blobSize) const;
       cluster_index_t getCountClusters() const       { return cluster_index_t(header.getClusterCount()); }
+      // The (compressed) size of each cluster in the file.
+      std::vector<zsize_t> getClusterSizes() const;
+      // The parts of a region of the archive which are not in the page cache
+      // (page aligned, except at the region boundaries). Empty if it cannot
+      // be known (on Windows for example).
+      std::vector<std::pair<offset_t, zsize_t>> getUncachedRanges(offset_t offset, zsize_t size) const;
+      // Advise the system that a region of the archive will not be needed
+      // soon, so it can be dropped from the page cache. No-op on Windows.
+      void dropFromPageCache(offset_t offset, zsize_t size) const;
       offset_t getClusterOffset(cluster_index_t idx) const;
       offset_t getBlobOffset(cluster_index_t clusterIdx, blob_index_t blobIdx) const;
       ItemDataDirectAccessInfo getDirectAccessInformation(cluster_index_t clusterIdx, blob_index_t blobIdx) const;
+      ItemDataDirectFdAccessInfo getDirectFdAccessInformation(cluster_index_t clusterIdx, blob_index_t blobIdx) const;
 
       entry_index_t getNamespaceBeginOffset(char ch) const;
       entry_index_t getNamespaceEndOffset(char ch) const;
@@ -153,11 +223,11 @@ namespace zim
         return getNamespaceEndOffset(ch) - getNamespaceBeginOffset(ch);
       }
 
-      entry_index_t getStartUserEntry() const { return m_startUserEntry; }
-      entry_index_t getEndUserEntry() const { return m_endUserEntry; }
+      entry_index_t getStartUserEntry() const { ensureIndexesLoaded(); return m_startUserEntry; }
+      entry_index_t getEndUserEntry() const { ensureIndexesLoaded(); return m_endUserEntry; }
       // The number of entries added by the creator. (So excluding index, ...).
       // On new namespace scheme, number of entries in C namespace
-      entry_index_t getUserEntryCount() const { return m_endUserEntry - m_startUserEntry; }
+      entry_index_t getUserEntryCount() const { ensureIndexesLoaded(); return m_endUserEntry - m_startUserEntry; }
       // The number of enties that can be considered as front article (no resource)
       entry_index_t getFrontEntryCount() const;
 
@@ -167,7 +237,8 @@ namespace zim
       bool verify();
       bool is_multiPart() const;
 
-      bool checkIntegrity(IntegrityCheck checkType);
+      bool checkIntegrity(IntegrityCheck checkType, unsigned threadCount = 1,
+                          const IntegrityCheckProgress& progress = IntegrityCheckProgress());
 
       size_t getDirentCacheMaxSize() const;
       size_t getDirentCacheCurrentSize() const;
@@ -177,30 +248,57 @@ namespace zim
       std::shared_ptr<XapianDb> loadXapianDb();
       std::shared_ptr<XapianDb> getXapianDb();
 #endif
+
+      // The index of the prefixes of the titles listed by
+      // `Archive::iterByTitle()`. Built on first call.
+      std::shared_ptr<const TitlePrefixIndex> getTitlePrefixIndex();
+
+      // The suggestions of the short title prefixes precomputed by the
+      // creator, nullptr if the archive doesn't have them.
+      std::shared_ptr<const TitlePrefixListing> getTitlePrefixListing();
   private:
       FileImpl(std::shared_ptr<FileCompound> zimFile, OpenConfig openConfig);
       FileImpl(std::shared_ptr<FileCompound> zimFile, offset_t offset, zsize_t size, OpenConfig openConfig);
 
       void dropCachedClusters() const;
 
+      void loadIndexes();
+      void ensureIndexesLoaded() const;
+
+      // Locate an uncompressed blob stored in only one file part.
+      // Return the part and the physical offset of the blob in the part's file,
+      // or a nullptr part if the blob is compressed or split on several parts.
+      std::pair<const FilePart*, offset_t> locateRawBlob(cluster_index_t clusterIdx, blob_index_t blobIdx) const;
+
       std::unique_ptr<IndirectDirentAccessor> getTitleAccessorV1(const entry_index_t idx);
       std::unique_ptr<IndirectDirentAccessor> getTitleAccessor(const offset_t offset, const zsize_t size, const std::string& name);
 
       void prepareArticleListByCluster() const;
+      void ensureArticleListByCluster() const;
+      std::unique_ptr<const Reader> getClusterOrderListing() const;
+      std::unique_ptr<const Reader> getClusterChecksumListing() const;
+      const Reader* ensureClusterChecksumListing() const;
+      // The cluster of the entry, 0 for redirects.
+      cluster_index_type getClusterOrderKey(entry_index_t idx) const;
+      // The first position in cluster order of an entry in `clusterIdx` or after.
+      size_t lowerBoundInClusterOrder(cluster_index_type clusterIdx) const;
       DirentLookup& direntLookup() const;
       ClusterHandle readCluster(cluster_index_t idx) const;
       offset_type getMimeListEndUpperLimit() const;
       void readMimeTypes();
       void quickCheckForCorruptFile();
       size_t getMaxBlobCountInCluster(cluster_index_t idx) const;
+      bool verifySplitChecksum();
 
+      // Range checks work on [begin, end) and may run concurrently.
       bool checkChecksum();
-      bool checkDirentPtrs();
-      bool checkDirentOrder();
-      bool checkTitleIndex();
-      bool checkClusterPtrs();
-      bool checkClusters();
-      bool checkDirentMimeTypes();
+      bool checkDirentPtrs(entry_index_type begin, entry_index_type end);
+      bool checkDirentOrder(entry_index_type begin, entry_index_type end);
+      bool checkTitleIndex(unsigned threadCount, const IntegrityCheckProgress& progress);
+      bool checkClusterPtrs(cluster_index_type begin, cluster_index_type end);
+      bool checkClusters(cluster_index_type begin, cluster_index_type end);
+      bool checkClusterChecksums(cluster_index_type begin, cluster_index_type end);
+      bool checkDirentMimeTypes(entry_index_type begin, entry_index_type end);
   };
 
 }
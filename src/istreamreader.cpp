@@ -20,6 +20,10 @@
 
 #include "istreamreader.h"
 #include "buffer_reader.h"
+#include "buffer_arena.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace zim
 {
@@ -31,9 +35,21 @@ namespace zim
 std::unique_ptr<const Reader>
 IStreamReader::sub_reader(zsize_t size)
 {
-  auto buffer = Buffer::makeBuffer(size);
+  auto buffer = makeClusterDataBuffer(size);
   readImpl(const_cast<char*>(buffer.data()), size);
   return std::unique_ptr<Reader>(new BufferReader(buffer));
 }
 
+void
+IStreamReader::skip(zsize_t nbytes)
+{
+  const size_type SKIP_CHUNK_SIZE = 64*1024;
+  std::vector<char> chunk(std::min(nbytes.v, SKIP_CHUNK_SIZE));
+  while (nbytes.v > 0) {
+    const auto n = zsize_t(std::min(nbytes.v, SKIP_CHUNK_SIZE));
+    readImpl(chunk.data(), n);
+    nbytes -= n;
+  }
+}
+
 } // namespace zim
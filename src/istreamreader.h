@@ -56,9 +56,17 @@ public: // functions
   // unknown bit-width (int, unsigned, etc).
   template<typename T> T read();
 
+  // Reads exactly 'nbytes' bytes into the provided buffer 'buf'
+  void read(char* buf, zsize_t nbytes) { readImpl(buf, nbytes); }
+
   // Reads a blob of the specified size from the stream
   virtual std::unique_ptr<const Reader> sub_reader(zsize_t size);
 
+  // Skips the next 'nbytes' bytes of the stream
+  // The default implementation reads (and drops) the data by small chunks
+  // so the memory usage stays bounded whatever the skipped size.
+  virtual void skip(zsize_t nbytes);
+
   // Get the total memory consumption by the reader object
   virtual size_t getMemorySize() const = 0;
 
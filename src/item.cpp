@@ -23,8 +23,10 @@
 #include "cluster.h"
 #include "zim/zim.h"
 #include "fileimpl.h"
+#include "istreamreader.h"
 #include "log.h"
 
+#include <algorithm>
 #include <cassert>
 
 log_define("zim.item")
@@ -52,6 +54,25 @@ Blob Item::getData(offset_type offset, size_type size) const
   return m_file->getBlob(*m_dirent, offset_t(offset), zsize_t(size));
 }
 
+std::vector<Blob> Item::getDataChunks(offset_type offset) const
+{
+  return m_file->getBlobChunks(*m_dirent, offset_t(offset));
+}
+
+std::vector<Blob> Item::getDataChunks(offset_type offset, size_type size) const
+{
+  return m_file->getBlobChunks(*m_dirent, offset_t(offset), zsize_t(size));
+}
+
+ItemReader Item::getDataReader(offset_type offset) const
+{
+  zsize_t blobSize;
+  auto stream = m_file->getBlobStream(m_dirent->getClusterNumber(), m_dirent->getBlobNumber(), &blobSize);
+  offset = std::min(offset, blobSize.v);
+  stream->skip(zsize_t(offset));
+  return ItemReader(std::move(stream), blobSize.v - offset);
+}
+
 size_type Item::getSize() const
 {
   auto cluster = m_file->getCluster(m_dirent->getClusterNumber());
@@ -63,6 +84,11 @@ ItemDataDirectAccessInfo Item::getDirectAccessInformation() const
   return m_file->getDirectAccessInformation(m_dirent->getClusterNumber(), m_dirent->getBlobNumber());
 }
 
+ItemDataDirectFdAccessInfo Item::getDirectFdAccessInformation() const
+{
+  return m_file->getDirectFdAccessInformation(m_dirent->getClusterNumber(), m_dirent->getBlobNumber());
+}
+
 cluster_index_type Item::getClusterIndex() const
 {
   return m_dirent->getClusterNumber().v;
@@ -72,3 +98,24 @@ blob_index_type Item::getBlobIndex() const
 {
   return m_dirent->getBlobNumber().v;
 }
+
+ItemReader::ItemReader(std::unique_ptr<IStreamReader> stream, size_type size)
+  : mp_stream(std::move(stream)),
+    m_size(size),
+    m_position(0)
+{}
+
+ItemReader::ItemReader(ItemReader&&) = default;
+ItemReader& ItemReader::operator=(ItemReader&&) = default;
+ItemReader::~ItemReader() = default;
+
+size_type ItemReader::read(char* dest, size_type size)
+{
+  size = std::min(size, getRemainingSize());
+  if (size == 0) {
+    return 0;
+  }
+  mp_stream->read(dest, zsize_t(size));
+  m_position += size;
+  return size;
+}
@@ -52,6 +52,11 @@ public: // functions
     return reader;
   }
 
+  void skip(zsize_t nbytes) override
+  {
+    m_readerPos += nbytes;
+  }
+
 
 private: // data
   std::shared_ptr<const Reader> m_reader;
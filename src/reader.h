@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "zim_types.h"
 #include "endian_tools.h"
@@ -75,6 +76,16 @@ class LIBZIM_PRIVATE_API Reader {
     const Buffer get_buffer(offset_t offset) const {
       return get_buffer(offset, zsize_t(size().v-offset.v));
     }
+    // Get the data as a list of buffers, each of them referencing contiguous
+    // memory. Readers able to avoid a copy by splitting the data should
+    // override this. By default, the whole data is returned in one buffer.
+    virtual std::vector<Buffer> get_buffers(offset_t offset, zsize_t size) const {
+      std::vector<Buffer> buffers;
+      if (size) {
+        buffers.push_back(get_buffer(offset, size));
+      }
+      return buffers;
+    }
     virtual std::unique_ptr<const Reader> sub_reader(offset_t offset, zsize_t size) const = 0;
     std::unique_ptr<const Reader> sub_reader(offset_t offset) const {
       return sub_reader(offset, zsize_t(size().v-offset.v));
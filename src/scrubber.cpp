@@ -0,0 +1,336 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/scrubber.h>
+#include <zim/error.h>
+#include <zim/tools.h>
+#include "fileimpl.h"
+#include "_dirent.h"
+#include "cluster.h"
+#include "namedthread.h"
+#include "log.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+log_define("zim.scrubber")
+
+namespace zim
+{
+
+namespace
+{
+
+// Number of directory entries checked between two progress reports.
+const entry_index_type DIRENT_BATCH_SIZE = 1024;
+
+void setIdleIoPriority()
+{
+#if defined(__linux__) && defined(SYS_ioprio_set)
+  // From linux/ioprio.h, which is not always installed.
+  const int IOPRIO_WHO_PROCESS = 1;
+  const int IOPRIO_CLASS_IDLE = 3;
+  const int IOPRIO_CLASS_SHIFT = 13;
+  // For IOPRIO_WHO_PROCESS, 0 is the calling thread.
+  if ( syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0 ) {
+    log_warn("Cannot lower the I/O priority of the scrubbing thread");
+  }
+#endif
+}
+
+} // unnamed namespace
+
+struct Scrubber::State
+{
+  typedef std::chrono::steady_clock Clock;
+
+  State(std::shared_ptr<FileImpl> file,
+        size_type bytesPerSecond,
+        bool lowIoPriority,
+        bool dropPageCache,
+        ProgressCallback progressCallback,
+        ErrorCallback errorCallback)
+    : file(file),
+      bytesPerSecond(bytesPerSecond),
+      lowIoPriority(lowIoPriority),
+      dropPageCache(dropPageCache),
+      progressCallback(progressCallback),
+      errorCallback(errorCallback)
+  {}
+
+  void run();
+  bool scrubDirents();
+  bool scrubClusters();
+  void checkDirent(entry_index_type idx, const Dirent& dirent);
+  void reportError(const std::string& error);
+  void reportProgress();
+  bool throttle(size_type size);
+
+  const std::shared_ptr<FileImpl> file;
+  const size_type bytesPerSecond;
+  const bool lowIoPriority;
+  const bool dropPageCache;
+  const ProgressCallback progressCallback;
+  const ErrorCallback errorCallback;
+
+  std::mutex mutex;
+  std::condition_variable stopCondition;
+  bool stopRequested = false;
+  std::atomic<bool> running{true};
+  std::atomic<size_type> errorCount{0};
+  std::unique_ptr<NamedThread> thread;
+
+  // Only used by the scrubbing thread.
+  Clock::time_point startTime;
+  size_type readSize = 0;
+  size_type checkedCount = 0;
+  size_type totalCount = 0;
+  std::string prevLongPath;
+};
+
+void Scrubber::State::run()
+{
+  if ( lowIoPriority ) {
+    setIdleIoPriority();
+  }
+  try {
+    startTime = Clock::now();
+    totalCount = file->getCountArticles().v + file->getCountClusters().v;
+    if ( scrubDirents() ) {
+      scrubClusters();
+    }
+  } catch (const std::exception& e) {
+    reportError(e.what());
+  }
+  running = false;
+}
+
+bool Scrubber::State::scrubDirents()
+{
+  const entry_index_type direntCount = file->getCountArticles().v;
+  for ( entry_index_type begin = 0; begin < direntCount; begin += DIRENT_BATCH_SIZE ) {
+    const entry_index_type end = std::min(direntCount, begin + DIRENT_BATCH_SIZE);
+    size_type size = 0;
+    for ( entry_index_type i = begin; i < end; ++i ) {
+      size += sizeof(offset_type);
+      try {
+        const auto dirent = file->getUncachedDirent(entry_index_t(i));
+        size += dirent->getDirentSize();
+        checkDirent(i, *dirent);
+      } catch (const std::exception& e) {
+        reportError(Formatter() << "Entry #" << i << ": " << e.what());
+      }
+    }
+    checkedCount += end - begin;
+    reportProgress();
+    if ( !throttle(size) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Scrubber::State::checkDirent(entry_index_type idx, const Dirent& dirent)
+{
+  const auto longPath = dirent.getLongPath();
+  if ( idx > 0 && !(prevLongPath < longPath) ) {
+    reportError(Formatter() << "Entry #" << idx << ": not properly sorted");
+  }
+  prevLongPath = longPath;
+
+  if ( dirent.isRedirect() ) {
+    if ( dirent.getRedirectIndex() >= file->getCountArticles() ) {
+      reportError(Formatter() << "Entry #" << idx << ": invalid redirect index");
+    }
+  } else if ( dirent.isArticle() ) {
+    // Throws if the mime type is invalid
+    file->getMimeType(dirent.getMimeType());
+    if ( dirent.getClusterNumber() >= file->getCountClusters() ) {
+      reportError(Formatter() << "Entry #" << idx << ": invalid cluster number");
+    }
+  }
+}
+
+bool Scrubber::State::scrubClusters()
+{
+  const auto clusterSizes = file->getClusterSizes();
+  const cluster_index_t checksummedCount = file->getChecksummedClusterCount();
+  for ( cluster_index_type i = 0; i < clusterSizes.size(); ++i ) {
+    const cluster_index_t idx(i);
+    // Only the pages brought in by the scrubbing can be dropped afterwards.
+    const auto uncachedRanges = dropPageCache
+      ? file->getUncachedRanges(file->getClusterOffset(idx), clusterSizes[i])
+      : std::vector<std::pair<offset_t, zsize_t>>();
+    try {
+      if ( idx < checksummedCount ) {
+        if ( !file->checkClusterChecksum(idx) ) {
+          reportError(Formatter() << "Cluster #" << i << ": checksum doesn't match");
+        }
+      } else {
+        // Force the decompression of the whole cluster
+        const auto cluster = file->getUncachedCluster(idx);
+        for ( blob_index_type n = 0; n < cluster->count().v; ++n ) {
+          cluster->getBlob(blob_index_t(n));
+        }
+      }
+    } catch (const std::exception& e) {
+      reportError(Formatter() << "Cluster #" << i << ": " << e.what());
+    }
+
+    // Keep the page cache for the clusters being used.
+    if ( !file->getCachedCluster(idx) ) {
+      for ( const auto& range : uncachedRanges ) {
+        file->dropFromPageCache(range.first, range.second);
+      }
+    }
+
+    ++checkedCount;
+    reportProgress();
+    if ( !throttle(clusterSizes[i].v) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Scrubber::State::reportError(const std::string& error)
+{
+  log_warn("Scrubbing " << file->getFilename() << ": " << error);
+  ++errorCount;
+  if ( errorCallback ) {
+    errorCallback(error);
+  }
+}
+
+void Scrubber::State::reportProgress()
+{
+  if ( progressCallback ) {
+    progressCallback(checkedCount, totalCount);
+  }
+}
+
+bool Scrubber::State::throttle(size_type size)
+{
+  readSize += size;
+  std::unique_lock<std::mutex> lock(mutex);
+  if ( bytesPerSecond ) {
+    const auto deadline = startTime + std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(double(readSize) / bytesPerSecond));
+    stopCondition.wait_until(lock, deadline, [this]() { return stopRequested; });
+  }
+  return !stopRequested;
+}
+
+Scrubber::Scrubber(const Archive& archive)
+  : m_archive(archive),
+    m_bytesPerSecond(16 * 1024 * 1024),
+    m_lowIoPriority(true),
+    m_dropPageCache(false)
+{}
+
+Scrubber::~Scrubber()
+{
+  stop();
+}
+
+Scrubber& Scrubber::setBytesPerSecond(size_type bytesPerSecond)
+{
+  m_bytesPerSecond = bytesPerSecond;
+  return *this;
+}
+
+Scrubber& Scrubber::setLowIoPriority(bool lowIoPriority)
+{
+  m_lowIoPriority = lowIoPriority;
+  return *this;
+}
+
+Scrubber& Scrubber::setDropPageCache(bool dropPageCache)
+{
+  m_dropPageCache = dropPageCache;
+  return *this;
+}
+
+Scrubber& Scrubber::setProgressCallback(ProgressCallback callback)
+{
+  m_progressCallback = callback;
+  return *this;
+}
+
+Scrubber& Scrubber::setErrorCallback(ErrorCallback callback)
+{
+  m_errorCallback = callback;
+  return *this;
+}
+
+void Scrubber::start()
+{
+  if ( isRunning() ) {
+    throw std::logic_error("The scrubber is already running");
+  }
+  wait();
+  mp_state.reset(new State(m_archive.getImpl(), m_bytesPerSecond, m_lowIoPriority,
+                           m_dropPageCache, m_progressCallback, m_errorCallback));
+  State* const state = mp_state.get();
+  state->thread.reset(new NamedThread("scrubber", [state]() { state->run(); }));
+}
+
+void Scrubber::stop()
+{
+  if ( !mp_state ) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mp_state->mutex);
+    mp_state->stopRequested = true;
+  }
+  mp_state->stopCondition.notify_all();
+  wait();
+}
+
+void Scrubber::wait()
+{
+  if ( mp_state && mp_state->thread ) {
+    mp_state->thread->join();
+    mp_state->thread.reset();
+  }
+}
+
+bool Scrubber::isRunning() const
+{
+  return mp_state && mp_state->running;
+}
+
+size_type Scrubber::getErrorCount() const
+{
+  return mp_state ? mp_state->errorCount.load() : 0;
+}
+
+} // namespace zim
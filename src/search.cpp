@@ -27,12 +27,17 @@
 #include <zim/search.h>
 #include <zim/archive.h>
 #include <zim/item.h>
+#include "concurrent_cache.h"
 #include "fileimpl.h"
-#include "lock.h"
+#include "thread_pool.h"
 #include "search_internal.h"
 #include "tools.h"
 #include "zim/zim.h"
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iomanip>
 #include <sstream>
 
 #include <sys/types.h>
@@ -91,10 +96,51 @@ Xapian::Stopper* XapianDbMetadata::new_stopper() {
     return nullptr;
 }
 
-XapianDb::XapianDb(const Xapian::Database& db, std::string defaultLanguage)
+XapianDb::XapianDb(const Xapian::Database& db,
+                   std::string defaultLanguage,
+                   const ItemDataDirectFdAccessInfo& fdAccessInfo,
+                   const ItemDataDirectAccessInfo& accessInfo)
   : m_metadata(db, defaultLanguage),
-    m_db(db)
-{}
+    m_fdAccessInfo(fdAccessInfo),
+    m_accessInfo(accessInfo)
+{
+    m_pool.emplace_back(new Xapian::Database(db));
+}
+
+std::shared_ptr<Xapian::Database> XapianDb::acquireDatabase()
+{
+    std::unique_ptr<Xapian::Database> db;
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        if (!m_pool.empty()) {
+            db = std::move(m_pool.back());
+            m_pool.pop_back();
+        }
+    }
+
+    if (!db) {
+        db.reset(new Xapian::Database());
+        const bool opened = m_fdAccessInfo.isValid()
+                          ? getDbFromAccessInfo(m_fdAccessInfo, *db)
+                          : getDbFromAccessInfo(m_accessInfo, *db);
+        if (!opened) {
+            throw ZimFileFormatError("Cannot open the fulltext index of " + m_accessInfo.filename);
+        }
+    }
+
+    // The deleter keeps the XapianDb alive until all its handles are back.
+    const auto self = shared_from_this();
+    return std::shared_ptr<Xapian::Database>(
+      db.release(),
+      [self](Xapian::Database* handle) { self->releaseDatabase(handle); });
+}
+
+void XapianDb::releaseDatabase(Xapian::Database* db)
+{
+    std::unique_ptr<Xapian::Database> handle(db);
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    m_pool.push_back(std::move(handle));
+}
 
 InternalDataBase::InternalDataBase(const std::vector<Archive>& archives, bool verbose)
   : m_verbose(verbose)
@@ -102,7 +148,6 @@ InternalDataBase::InternalDataBase(const std::vector<Archive>& archives, bool ve
     bool first = true;
     m_queryParser.set_database(m_database);
     m_queryParser.set_default_op(Xapian::Query::op::OP_AND);
-    std::vector<std::recursive_mutex*> mutexes;
 
     for(auto& archive: archives) {
         auto database = archive.getImpl()->getXapianDb();
@@ -118,12 +163,10 @@ InternalDataBase::InternalDataBase(const std::vector<Archive>& archives, bool ve
             m_queryParser.set_stopper(m_metadata.new_stopper());
             first = false;
         }
-        m_database.add_database(database->m_db);
-        mutexes.push_back(&database->m_mutex);
+        m_databases.push_back(database->acquireDatabase());
+        m_database.add_database(*m_databases.back());
         m_archives.push_back(archive);
     }
-
-    m_mutexes = MultiMutex(mutexes);
 }
 
 bool InternalDataBase::hasDatabase() const
@@ -146,11 +189,12 @@ int InternalDataBase::valueSlot(const std::string& valueName) const
   return m_metadata.valueSlot(valueName);
 }
 
-std::lock_guard<MultiMutex> InternalDataBase::lock() {
+std::lock_guard<std::recursive_mutex> InternalDataBase::lock() {
   // Construct the guard with a list-initialization, so we don't have to move it
   // (which we can't do as lock_guard is not movable).
   // See https://stackoverflow.com/questions/22502606/why-is-stdlock-guard-not-movable
-  return { m_mutexes, std::adopt_lock };
+  m_mutex.lock();
+  return { m_mutex, std::adopt_lock };
 }
 
 Xapian::Query InternalDataBase::parseQuery(const Query& query)
@@ -177,7 +221,9 @@ Xapian::Query InternalDataBase::parseQuery(const Query& query)
 
 Searcher::Searcher(const std::vector<Archive>& archives) :
     mp_internalDb(nullptr),
-    m_verbose(false)
+    m_verbose(false),
+    mp_searchPool(nullptr),
+    m_archiveTimeout(0)
 {
     for ( const auto& a : archives ) {
         addArchive(a);
@@ -186,7 +232,9 @@ Searcher::Searcher(const std::vector<Archive>& archives) :
 
 Searcher::Searcher(const Archive& archive) :
     mp_internalDb(nullptr),
-    m_verbose(false)
+    m_verbose(false),
+    mp_searchPool(nullptr),
+    m_archiveTimeout(0)
 {
     addArchive(archive);
 }
@@ -235,7 +283,14 @@ Search Searcher::search(const Query& query)
     throw(std::runtime_error("Cannot create Search without FT Xapian index"));
   }
 
-  return Search(mp_internalDb, query);
+  // A database still used by a previous search (or its results) may be used
+  // concurrently from another thread. Give the new search its own database
+  // handles instead of serializing both searches.
+  if (mp_internalDb.use_count() > 1) {
+    return Search(std::make_shared<InternalDataBase>(m_archives, m_verbose), query,
+                  mp_searchPool, m_archiveTimeout);
+  }
+  return Search(mp_internalDb, query, mp_searchPool, m_archiveTimeout);
 }
 
 void Searcher::setVerbose(bool verbose)
@@ -243,15 +298,29 @@ void Searcher::setVerbose(bool verbose)
   m_verbose = verbose;
 }
 
+void Searcher::setParallelSearch(unsigned nbThreads)
+{
+  // The threads are started (and kept) as needed by the searches.
+  mp_searchPool = nbThreads ? std::make_shared<ThreadPool>("search", nbThreads) : nullptr;
+}
+
+void Searcher::setArchiveTimeout(unsigned milliseconds)
+{
+  m_archiveTimeout = milliseconds;
+}
+
 void Searcher::initDatabase()
 {
     mp_internalDb = std::make_shared<InternalDataBase>(m_archives, m_verbose);
 }
 
-Search::Search(std::shared_ptr<InternalDataBase> p_internalDb, const Query& query)
+Search::Search(std::shared_ptr<InternalDataBase> p_internalDb, const Query& query,
+               std::shared_ptr<ThreadPool> p_searchPool, unsigned archiveTimeout)
  : mp_internalDb(p_internalDb),
    mp_enquire(nullptr),
-   m_query(query)
+   m_query(query),
+   mp_searchPool(p_searchPool),
+   m_archiveTimeout(archiveTimeout)
 {
 }
 
@@ -276,15 +345,239 @@ Query& Query::setGeorange(float latitude, float longitude, float distance) {
     return *this;
 }
 
+std::string archiveContentKey(const Archive& archive)
+{
+  std::ostringstream key;
+  key << std::string(archive.getUuid()) << '/' << archive.getFilesize();
+  return key.str();
+}
+
+namespace
+{
+
+typedef ConcurrentCache<std::string, std::shared_ptr<const SearchResults>, SearchResultsMemorySize> SearchResultCache;
+
+SearchResultCache& getSearchResultCache()
+{
+  static SearchResultCache searchResultCache(SEARCH_RESULT_CACHE_SIZE);
+  return searchResultCache;
+}
+
+// Results only depend on the set of archives searched, on the parsed query
+// (which includes the effect of the language of the archives), on the
+// georange and on the requested range of results.
+std::string searchResultCacheKey(const InternalDataBase& internalDb,
+                                 const Xapian::Query& xquery,
+                                 const Query& query,
+                                 int start, int maxResults, int checkAtLeast,
+                                 bool parallel)
+{
+  std::ostringstream key;
+  for (const auto& archive: internalDb.m_archives) {
+    key << archiveContentKey(archive) << ' ';
+  }
+  key << '\n' << xquery.get_description() << '\n';
+  if (query.m_geoquery) {
+    key << std::setprecision(9)
+        << query.m_latitude << ' ' << query.m_longitude << ' ' << query.m_distance;
+  }
+  key << '\n' << start << ' ' << maxResults << ' ' << checkAtLeast;
+  // Parallel searches rank the results of each archive on its own.
+  if (parallel) {
+    key << " parallel";
+  }
+  return key.str();
+}
+
+std::shared_ptr<const SearchResults> runSearch(const Xapian::Enquire& enquire,
+                                               int start, int maxResults, int checkAtLeast)
+{
+  // Only std::exceptions release the slot of a failed computation in the
+  // cache, so xapian errors must be converted here.
+  try {
+    const auto mset = enquire.get_mset(start, maxResults, checkAtLeast);
+    auto results = std::make_shared<SearchResults>();
+    results->checkedAtLeast = checkAtLeast;
+    results->estimatedMatches = mset.get_matches_estimated();
+    results->matches.reserve(mset.size());
+    for (auto it = mset.begin(); it != mset.end(); ++it) {
+      results->matches.push_back({*it, it.get_percent()});
+    }
+    return results;
+  } catch(Xapian::DatabaseError& e) {
+    throw zim::ZimFileFormatError(e.get_description());
+  } catch(Xapian::Error& e) {
+    throw std::runtime_error(e.get_description());
+  }
+}
+
+struct WeightedMatch {
+  double weight;
+  SearchResults::Match match;
+};
+
+bool isMoreRelevant(const WeightedMatch& a, const WeightedMatch& b)
+{
+  if (a.weight != b.weight) {
+    return a.weight > b.weight;
+  }
+  return a.match.docid < b.match.docid;
+}
+
+} // unnamed namespace
+
+size_t getSearchResultCacheMaxSize()
+{
+  return getSearchResultCache().getMaxCost();
+}
+
+size_t getSearchResultCacheCurrentSize()
+{
+  return getSearchResultCache().getCurrentCost();
+}
+
+void setSearchResultCacheMaxSize(size_t sizeInB)
+{
+  getSearchResultCache().setMaxCost(sizeInB);
+}
+
+std::shared_ptr<const SearchResults> Search::getCachedResults(int start, int maxResults, int checkAtLeast) const
+{
+  // Xapian always checks the documents of the requested range.
+  checkAtLeast = std::max(checkAtLeast, start + maxResults);
+  const auto& enquire = getEnquire();
+  const bool parallel = mp_searchPool && mp_internalDb->m_archives.size() > 1;
+  const auto search = [&]() {
+    if (parallel) {
+      return runParallelSearch(start, maxResults, checkAtLeast);
+    }
+    return runSearch(enquire, start, maxResults, checkAtLeast);
+  };
+  auto& cache = getSearchResultCache();
+  if (cache.getMaxCost() == 0) {
+    return search();
+  }
+  const auto key = searchResultCacheKey(*mp_internalDb, enquire.get_query(), m_query,
+                                        start, maxResults, checkAtLeast, parallel);
+  auto results = cache.getOrPut(key, search);
+  // Don't serve partial results to the next searches.
+  if (!results->complete) {
+    cache.drop(key);
+  }
+  return results;
+}
+
+std::shared_ptr<const SearchResults> Search::runParallelSearch(int start, int maxResults, int checkAtLeast) const
+{
+  const auto& databases = mp_internalDb->m_databases;
+  const size_t nbDatabases = databases.size();
+
+  // Xapian queries are not thread safe (even to copy them), so each thread
+  // rebuilds its own query from the serialised one.
+  const auto serialisedQuery = getEnquire().get_query().serialise();
+
+  struct ArchiveResults {
+    std::vector<WeightedMatch> matches;
+    int estimatedMatches = 0;
+    bool complete = false;
+    std::exception_ptr error;
+  };
+  std::vector<ArchiveResults> archiveResults(nbDatabases);
+
+  const auto searchArchive = [&](size_t i) {
+    auto& archiveResult = archiveResults[i];
+    try {
+      Xapian::Enquire enquire(*databases[i]);
+      enquire.set_query(Xapian::Query::unserialise(serialisedQuery));
+      if (m_archiveTimeout) {
+        enquire.set_time_limit(m_archiveTimeout / 1000.0);
+      }
+      const auto startTime = std::chrono::steady_clock::now();
+      const auto mset = enquire.get_mset(0, start + maxResults, checkAtLeast);
+      const auto duration = std::chrono::steady_clock::now() - startTime;
+
+      archiveResult.estimatedMatches = mset.get_matches_estimated();
+      archiveResult.matches.reserve(mset.size());
+      for (auto it = mset.begin(); it != mset.end(); ++it) {
+        // The docid of the document in the combined database.
+        const Xapian::docid docid = (*it - 1) * nbDatabases + i + 1;
+        archiveResult.matches.push_back({it.get_weight(), {docid, it.get_percent()}});
+      }
+      // Xapian doesn't tell if the time limit stopped the match.
+      archiveResult.complete = !m_archiveTimeout
+        || duration < std::chrono::milliseconds(m_archiveTimeout);
+    } catch(Xapian::DatabaseError& e) {
+      archiveResult.error = std::make_exception_ptr(ZimFileFormatError(e.get_description()));
+    } catch(Xapian::Error& e) {
+      archiveResult.error = std::make_exception_ptr(std::runtime_error(e.get_description()));
+    } catch(...) {
+      archiveResult.error = std::current_exception();
+    }
+  };
+
+  std::vector<std::future<void>> archivesSearched;
+  for (size_t i = 0; i < nbDatabases; ++i) {
+    auto promise = std::make_shared<std::promise<void>>();
+    archivesSearched.push_back(promise->get_future());
+    mp_searchPool->submit([&searchArchive, i, promise]() {
+      searchArchive(i);
+      promise->set_value();
+    });
+  }
+  for (auto& archiveSearched : archivesSearched) {
+    archiveSearched.wait();
+  }
+
+  auto results = std::make_shared<SearchResults>();
+  results->checkedAtLeast = checkAtLeast;
+  std::vector<WeightedMatch> matches;
+  std::exception_ptr firstError;
+  size_t nbErrors = 0;
+  for (size_t i = 0; i < nbDatabases; ++i) {
+    auto& archiveResult = archiveResults[i];
+    if (archiveResult.error) {
+      if (mp_internalDb->m_verbose) {
+        std::cout << "Search of " << mp_internalDb->m_archives[i].getFilename() << " failed" << std::endl;
+      }
+      if (!firstError) {
+        firstError = archiveResult.error;
+      }
+      ++nbErrors;
+      results->complete = false;
+      continue;
+    }
+    results->complete = results->complete && archiveResult.complete;
+    results->estimatedMatches += archiveResult.estimatedMatches;
+    matches.insert(matches.end(), archiveResult.matches.begin(), archiveResult.matches.end());
+  }
+
+  // Partial results are better than none, but if no archive could be
+  // searched, there is nothing to return.
+  if (nbErrors == nbDatabases) {
+    std::rethrow_exception(firstError);
+  }
+
+  const size_t end = std::min<size_t>(start + maxResults, matches.size());
+  if (static_cast<size_t>(start) < end) {
+    std::partial_sort(matches.begin(), matches.begin() + end, matches.end(), isMoreRelevant);
+    results->matches.reserve(end - start);
+    for (size_t i = start; i < end; ++i) {
+      results->matches.push_back(matches[i].match);
+    }
+  }
+  return results;
+}
+
 int Search::getEstimatedMatches() const
 {
     LOCK_SEARCH(mp_internalDb);
     try {
-      auto enquire = getEnquire();
       // Force xapian to check at least 10 documents even if we ask for an empty mset.
       // Else, the get_matches_estimated may be wrong and return 0 even if we have results.
-      auto mset = enquire.get_mset(0, 0, 10);
-      return mset.get_matches_estimated();
+      if (!mp_lastResults || mp_lastResults->checkedAtLeast < 10) {
+        mp_lastResults = getCachedResults(0, 0, 10);
+      }
+      return mp_lastResults->estimatedMatches;
     } catch(Xapian::QueryParserError& e) {
       return 0;
     } catch(Xapian::DatabaseError& e) {
@@ -293,11 +586,21 @@ int Search::getEstimatedMatches() const
 }
 
 const SearchResultSet Search::getResults(int start, int maxResults) const {
+    return getResults(start, maxResults, 0);
+}
+
+const SearchResultSet Search::getResults(int start, int maxResults, int checkAtLeast) const {
     LOCK_SEARCH(mp_internalDb);
     try {
-      auto enquire = getEnquire();
-      auto mset = enquire.get_mset(start, maxResults);
-      return SearchResultSet(mp_internalDb, std::move(mset));
+      auto results = getCachedResults(start, maxResults, checkAtLeast);
+      // Keep the results checking the most documents for getEstimatedMatches().
+      if (!mp_lastResults || mp_lastResults->checkedAtLeast <= results->checkedAtLeast) {
+        mp_lastResults = results;
+      }
+      // The result set may outlive this search and is used from other
+      // threads, so it gets its own query rather than sharing the (not
+      // thread safe) one of the enquire.
+      return SearchResultSet(mp_internalDb, std::move(results), mp_internalDb->parseQuery(m_query));
     } catch(Xapian::QueryParserError& e) {
       return SearchResultSet(mp_internalDb);
     } catch(Xapian::DatabaseError& e) {
@@ -325,53 +628,58 @@ Xapian::Enquire& Search::getEnquire() const
 }
 
 
-SearchResultSet::SearchResultSet(std::shared_ptr<InternalDataBase> p_internalDb, Xapian::MSet&& mset) :
+SearchResultSet::SearchResultSet(std::shared_ptr<InternalDataBase> p_internalDb,
+                                 std::shared_ptr<const SearchResults> p_results,
+                                 const Xapian::Query& query) :
   mp_internalDb(p_internalDb),
-  mp_mset(std::make_shared<Xapian::MSet>(mset))
+  mp_results(p_results),
+  mp_highlighter(std::make_shared<SnippetHighlighter>(query))
 {}
 
 SearchResultSet::SearchResultSet(std::shared_ptr<InternalDataBase> p_internalDb) :
   mp_internalDb(p_internalDb),
-  mp_mset(nullptr)
+  mp_results(nullptr),
+  mp_highlighter(nullptr)
 {}
 
 int SearchResultSet::size() const
 {
-  if (! mp_mset) {
+  if (! mp_results) {
       return 0;
   }
-  LOCK_SEARCH(mp_internalDb);
-  try {
-      return mp_mset->size();
-  } catch(Xapian::DatabaseError& e) {
-    throw zim::ZimFileFormatError(e.get_description());
+  return mp_results->matches.size();
+}
+
+int SearchResultSet::getEstimatedMatches() const
+{
+  if (! mp_results) {
+      return 0;
   }
+  return mp_results->estimatedMatches;
+}
+
+bool SearchResultSet::isComplete() const
+{
+  if (! mp_results) {
+      return true;
+  }
+  return mp_results->complete;
 }
 
 SearchResultSet::iterator SearchResultSet::begin() const
 {
-    if ( ! mp_mset ) {
+    if ( ! mp_results ) {
         return nullptr;
     }
-    LOCK_SEARCH(mp_internalDb);
-    try {
-        return new SearchIterator::InternalData(mp_internalDb, mp_mset, mp_mset->begin());
-    } catch(Xapian::DatabaseError& e) {
-        throw zim::ZimFileFormatError(e.get_description());
-    }
+    return new SearchIterator::InternalData(mp_internalDb, mp_results, mp_highlighter, 0);
 }
 
 SearchResultSet::iterator SearchResultSet::end() const
 {
-    if ( ! mp_mset ) {
+    if ( ! mp_results ) {
         return nullptr;
     }
-    LOCK_SEARCH(mp_internalDb);
-    try {
-        return new SearchIterator::InternalData(mp_internalDb, mp_mset, mp_mset->end());
-    } catch(Xapian::DatabaseError& e) {
-        throw zim::ZimFileFormatError(e.get_description());
-    }
+    return new SearchIterator::InternalData(mp_internalDb, mp_results, mp_highlighter, mp_results->matches.size());
 }
 
 } //namespace zim
@@ -23,8 +23,10 @@
 #define ZIM_SEARCH_INTERNAL_H
 
 #include "tools.h"
-#include "lock.h"
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <vector>
 #include <xapian.h>
 
 #include <zim/archive.h>
@@ -70,16 +72,38 @@ class XapianDbMetadata {
     std::string m_stopwords;
 };
 
-class XapianDb {
+/**
+ * The fulltext index of an archive.
+ *
+ * A `Xapian::Database` cannot be used from several threads at the same time.
+ * So instead of sharing one database (and serializing all the searches on
+ * it), we keep a pool of handles on the embedded database. Each handle is
+ * used by only one search at a time. Handles are opened when needed and
+ * return to the pool when released.
+ */
+class XapianDb : public std::enable_shared_from_this<XapianDb> {
   public: // method
-    XapianDb(const Xapian::Database& db, std::string defaultLanguage);
+    XapianDb(const Xapian::Database& db,
+             std::string defaultLanguage,
+             const ItemDataDirectFdAccessInfo& fdAccessInfo,
+             const ItemDataDirectAccessInfo& accessInfo);
+
+    // Get a database handle for the exclusive use of the caller.
+    std::shared_ptr<Xapian::Database> acquireDatabase();
+
+  private: // method
+    void releaseDatabase(Xapian::Database* db);
 
   public: // data
     XapianDbMetadata m_metadata;
 
-    Xapian::Database m_db;
+  private: // data
+    // Where to open new handles from. The fd (if valid) is used first.
+    const ItemDataDirectFdAccessInfo m_fdAccessInfo;
+    const ItemDataDirectAccessInfo m_accessInfo;
 
-    std::recursive_mutex m_mutex;
+    std::mutex m_poolMutex;
+    std::vector<std::unique_ptr<Xapian::Database>> m_pool;
 };
 
 /**
@@ -95,9 +119,13 @@ class InternalDataBase {
 
     Xapian::Query parseQuery(const zim::Query& query);
 
-    std::lock_guard<MultiMutex> lock();
+    std::lock_guard<std::recursive_mutex> lock();
 
   public: // data
+    // The handles on the archive databases, leased from the archive pools
+    // for the lifetime of this object.
+    std::vector<std::shared_ptr<Xapian::Database>> m_databases;
+
     // The (main) database we will search on (wrapping other xapian databases).
     Xapian::Database m_database;
 
@@ -114,28 +142,90 @@ class InternalDataBase {
     // The metadata of the db
     XapianDbMetadata m_metadata;
 
-    // The MultiMutex associated to the multi db
-    MultiMutex m_mutexes;
+    // Protects the xapian objects (database, query parser, msets...) of
+    // this instance.
+    std::recursive_mutex m_mutex;
 
     // Verbosity of operations.
     bool m_verbose;
 };
 
+// The identity of the content of an archive in the caches shared by all the
+// searches. The uuid alone is not enough: an archive may be rebuilt (or
+// modified) without changing its uuid.
+std::string archiveContentKey(const Archive& archive);
+
+/**
+ * The results of a search, as kept in the search result cache.
+ *
+ * Only the ids and scores of the matching documents are kept (not the
+ * `Xapian::MSet`) so that cached results don't hold on the xapian objects of
+ * the search that produced them.
+ */
+struct SearchResults {
+    struct Match {
+      Xapian::docid docid;
+      int percent;
+    };
+
+    // The minimum number of documents checked to compute the results.
+    int checkedAtLeast = 0;
+    int estimatedMatches = 0;
+    std::vector<Match> matches;
+
+    // False if some archives were not (fully) searched.
+    bool complete = true;
+};
+
+struct SearchResultsMemorySize {
+    static size_t cost(const std::shared_ptr<const SearchResults>& results) {
+        return sizeof(SearchResults) + results->matches.capacity() * sizeof(SearchResults::Match);
+    }
+};
+
+/**
+ * Generates the snippets of the results of a query.
+ *
+ * The results don't keep the mset of the search. An empty mset of the same
+ * query is enough to highlight the terms: it is built on first use and
+ * reused for all the results of a result set.
+ *
+ * The lock of the database must be held to generate snippets.
+ */
+class SnippetHighlighter {
+  public: // methods
+    explicit SnippetHighlighter(const Xapian::Query& query) : m_query(query) {}
+
+    std::string generateSnippet(InternalDataBase& internalDb, const std::string& text);
+
+  private: // data
+    const Xapian::Query m_query;
+    std::unique_ptr<Xapian::MSet> mp_mset;
+};
+
 struct SearchIterator::InternalData {
     std::shared_ptr<InternalDataBase> mp_internalDb;
-    std::shared_ptr<Xapian::MSet> mp_mset;
-    Xapian::MSetIterator _iterator;
+    std::shared_ptr<const SearchResults> mp_results;
+    std::shared_ptr<SnippetHighlighter> mp_highlighter;
+    size_t _index;
     Xapian::Document _document;
     bool document_fetched;
     std::unique_ptr<Entry> _entry;
+    // Whether the data of the matching items has been requested in the
+    // background to generate their snippets. Shared by the copies of the
+    // iterator (but not with the other iterators on the same results, which
+    // may be cached and shared by other searches).
+    std::shared_ptr<std::atomic<bool>> mp_snippetSourcesPrefetched;
 
     InternalData(const InternalData& other) :
       mp_internalDb(other.mp_internalDb),
-      mp_mset(other.mp_mset),
-      _iterator(other._iterator),
+      mp_results(other.mp_results),
+      mp_highlighter(other.mp_highlighter),
+      _index(other._index),
       _document(other._document),
       document_fetched(other.document_fetched),
-      _entry(other._entry ? new Entry(*other._entry) : nullptr )
+      _entry(other._entry ? new Entry(*other._entry) : nullptr ),
+      mp_snippetSourcesPrefetched(other.mp_snippetSourcesPrefetched)
     {
     }
 
@@ -143,26 +233,33 @@ struct SearchIterator::InternalData {
     {
       if (this != &other) {
         mp_internalDb = other.mp_internalDb;
-        mp_mset = other.mp_mset;
-        _iterator = other._iterator;
+        mp_results = other.mp_results;
+        mp_highlighter = other.mp_highlighter;
+        _index = other._index;
         _document = other._document;
         document_fetched = other.document_fetched;
         _entry.reset(other._entry ? new Entry(*other._entry) : nullptr);
+        mp_snippetSourcesPrefetched = other.mp_snippetSourcesPrefetched;
       }
       return *this;
     }
 
-    InternalData(std::shared_ptr<InternalDataBase> p_internalDb, std::shared_ptr<Xapian::MSet> p_mset, Xapian::MSetIterator iterator) :
+    InternalData(std::shared_ptr<InternalDataBase> p_internalDb,
+                 std::shared_ptr<const SearchResults> p_results,
+                 std::shared_ptr<SnippetHighlighter> p_highlighter,
+                 size_t index) :
         mp_internalDb(p_internalDb),
-        mp_mset(p_mset),
-        _iterator(iterator),
-        document_fetched(false)
+        mp_results(p_results),
+        mp_highlighter(p_highlighter),
+        _index(index),
+        document_fetched(false),
+        mp_snippetSourcesPrefetched(std::make_shared<std::atomic<bool>>(false))
     {};
 
     Xapian::Document get_document() {
         try {
             if ( !document_fetched ) {
-                _document = iterator().get_document();
+                _document = mp_internalDb->m_database.get_document(match().docid);
                 document_fetched = true;
             }
             return _document;
@@ -172,12 +269,12 @@ struct SearchIterator::InternalData {
     }
 
     int get_databasenumber() {
-        try {
-            Xapian::docid docid = *iterator();
-            return (docid - 1) % mp_internalDb->m_archives.size();
-        } catch ( Xapian::DatabaseError& e) {
-            throw zim::ZimFileFormatError(e.get_description());
-        }
+        Xapian::docid docid = match().docid;
+        return (docid - 1) % mp_internalDb->m_archives.size();
+    }
+
+    const Archive& getArchive() {
+        return mp_internalDb->m_archives.at(get_databasenumber());
     }
 
     Entry& get_entry() {
@@ -195,19 +292,19 @@ struct SearchIterator::InternalData {
 
     bool operator==(const InternalData& other) const {
         return (mp_internalDb == other.mp_internalDb
-            &&  mp_mset == other.mp_mset
-            &&  _iterator == other._iterator);
+            &&  mp_results == other.mp_results
+            &&  _index == other._index);
     }
 
     bool is_end() const {
-        return _iterator == mp_mset->end();
+        return _index == mp_results->matches.size();
     }
 
-    const Xapian::MSetIterator& iterator() const {
+    const SearchResults::Match& match() const {
         if (is_end()) {
             throw std::runtime_error("Cannot get entry for end iterator");
         }
-        return _iterator;
+        return mp_results->matches[_index];
     }
 };
 
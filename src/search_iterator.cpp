@@ -27,9 +27,97 @@
 #include <zim/archive.h>
 #include <zim/item.h>
 #include "search_internal.h"
+#include "concurrent_cache.h"
+
+#include <algorithm>
+#include <tuple>
 
 namespace zim {
 
+namespace
+{
+
+// Only the start of the content of an item is used to generate its snippet.
+const size_type SNIPPET_SOURCE_MAX_SIZE = 64*1024;
+
+const size_t SNIPPET_SOURCE_CACHE_SIZE = 4*1024*1024;
+
+struct SnippetSourceMemorySize {
+    static size_t cost(const std::shared_ptr<const std::string>& text) {
+        return sizeof(std::string) + text->size();
+    }
+};
+
+// The text (without html tags) used to generate the snippets, by archive
+// content (see archiveContentKey()) and path.
+typedef std::tuple<std::string, std::string> SnippetSourceKey;
+typedef ConcurrentCache<SnippetSourceKey, std::shared_ptr<const std::string>, SnippetSourceMemorySize> SnippetSourceCache;
+
+SnippetSourceCache& getSnippetSourceCache()
+{
+    static SnippetSourceCache snippetSourceCache(SNIPPET_SOURCE_CACHE_SIZE);
+    return snippetSourceCache;
+}
+
+SnippetSourceKey snippetSourceKey(const Archive& archive, const std::string& path)
+{
+    return SnippetSourceKey(archiveContentKey(archive), path);
+}
+
+std::shared_ptr<const std::string> getSnippetSource(const Archive& archive, const std::string& path, const Entry& entry)
+{
+    return getSnippetSourceCache().getOrPut(snippetSourceKey(archive, path), [&entry]() {
+        /* We parse the content and use the html dump to avoid remove html
+           tags in the content and be able to nicely cut the text at random
+           place. */
+        const auto item = entry.getItem(true);
+        const std::string content = item.getData(0, std::min(item.getSize(), SNIPPET_SOURCE_MAX_SIZE));
+        zim::MyHtmlParser htmlParser;
+        try {
+          htmlParser.parse_html(content, "UTF-8", true);
+        } catch (...) {}
+        return std::make_shared<const std::string>(htmlParser.dump);
+    });
+}
+
+// Load the data of the results whose snippet source is not cached, using
+// the asynchronous item data threads.
+void prefetchSnippetSources(const InternalDataBase& internalDb, const SearchResults& results)
+{
+    for (const auto& match : results.matches) {
+        try {
+            const auto& archive = internalDb.m_archives.at((match.docid - 1) % internalDb.m_archives.size());
+            const auto path = internalDb.m_database.get_document(match.docid).get_data();
+            std::shared_ptr<const std::string> text;
+            if (!getSnippetSourceCache().getIfReady(snippetSourceKey(archive, path), text)) {
+                archive.getItemDataByPathAsync(path, [](const Blob&, std::exception_ptr) {});
+            }
+        } catch (...) {
+            // Prefetching is only an optimization.
+        }
+    }
+}
+
+} // unnamed namespace
+
+std::string SnippetHighlighter::generateSnippet(InternalDataBase& internalDb, const std::string& text)
+{
+    if (!mp_mset) {
+        Xapian::Enquire enquire(internalDb.m_database);
+        enquire.set_query(m_query);
+        mp_mset.reset(new Xapian::MSet(enquire.get_mset(0, 0)));
+    }
+    return mp_mset->snippet(text,
+                            /*length=*/500,
+                            /*stemmer=*/internalDb.m_metadata.m_stemmer,
+                            /*flags=*/0);
+}
+
+size_t getSnippetSourceCacheCurrentSize()
+{
+    return getSnippetSourceCache().getCurrentCost();
+}
+
 
 SearchIterator::~SearchIterator() = default;
 SearchIterator::SearchIterator(SearchIterator&& it) = default;
@@ -74,7 +162,7 @@ SearchIterator& SearchIterator::operator++() {
     if ( ! internal ) {
         return *this;
     }
-    ++(internal->_iterator);
+    ++(internal->_index);
     internal->document_fetched = false;
     internal->_entry.reset();
     return *this;
@@ -90,7 +178,7 @@ SearchIterator& SearchIterator::operator--() {
     if ( ! internal ) {
         return *this;
     }
-    --(internal->_iterator);
+    --(internal->_index);
     internal->document_fetched = false;
     internal->_entry.reset();
     return *this;
@@ -150,7 +238,7 @@ int SearchIterator::getScore() const {
         return 0;
     }
     LOCK_SEARCH(internal->mp_internalDb);
-    return internal->iterator().get_percent();
+    return internal->match().percent;
 }
 
 std::string SearchIterator::getSnippet() const {
@@ -171,24 +259,22 @@ std::string SearchIterator::getSnippet() const {
         }
         else if ( internal->mp_internalDb->hasValue("snippet") )
         {
-            return internal->get_document().get_value(internal->mp_internalDb->valueSlot("snippet"));
+            // The stored excerpt of the content is used as is by older
+            // readers, but we can still highlight the matching terms.
+            const auto excerpt = internal->get_document().get_value(internal->mp_internalDb->valueSlot("snippet"));
+            return internal->mp_highlighter->generateSnippet(*internal->mp_internalDb, excerpt);
         }
 
         Entry& entry = internal->get_entry();
         /* No reader, no snippet */
         try {
-            /* Get the content of the item to generate a snippet.
-               We parse it and use the html dump to avoid remove html tags in the
-               content and be able to nicely cut the text at random place. */
-            zim::MyHtmlParser htmlParser;
-            std::string content = entry.getItem().getData();
-            try {
-              htmlParser.parse_html(content, "UTF-8", true);
-            } catch (...) {}
-            return internal->mp_mset->snippet(htmlParser.dump,
-                                              /*length=*/500,
-                                              /*stemmer=*/internal->mp_internalDb->m_metadata.m_stemmer,
-                                              /*flags=*/0);
+            // The other results of the page will most probably need a
+            // snippet too. Load their data in parallel (once per iterator).
+            if (!internal->mp_snippetSourcesPrefetched->exchange(true)) {
+                prefetchSnippetSources(*internal->mp_internalDb, *internal->mp_results);
+            }
+            const auto text = getSnippetSource(internal->getArchive(), internal->get_document().get_data(), entry);
+            return internal->mp_highlighter->generateSnippet(*internal->mp_internalDb, *text);
         } catch (...) {
           return "";
         }
@@ -24,9 +24,12 @@
 #include <zim/item.h>
 #include "suggestion_internal.h"
 #include "fileimpl.h"
+#include "title_prefix_index.h"
 #include "tools.h"
 #include "constants.h"
 
+#include <algorithm>
+
 #if defined(ENABLE_XAPIAN)
 #include <unicode/locid.h>
 #endif  // ENABLE_XAPIAN
@@ -34,10 +37,17 @@
 namespace zim
 {
 
-SuggestionDataBase::SuggestionDataBase(const Archive& archive, bool verbose)
+SuggestionDataBase::SuggestionDataBase(const Archive& archive, bool verbose, bool usePrefixIndex)
   : m_archive(archive),
-    m_verbose(verbose)
+    m_verbose(verbose),
+    mp_prefixListing(m_archive.getImpl()->getTitlePrefixListing())
 {
+  if (usePrefixIndex) {
+    // No need of the xapian title index.
+    mp_prefixIndex = m_archive.getImpl()->getTitlePrefixIndex();
+    return;
+  }
+
 // Initialize Xapian DB if it is enabled
 #if defined(ENABLE_XAPIAN)
   try {
@@ -49,9 +59,23 @@ SuggestionDataBase::SuggestionDataBase(const Archive& archive, bool verbose)
 }
 
 #if defined(ENABLE_XAPIAN)
+void initSuggestionQueryParser(Xapian::QueryParser& queryParser, Xapian::Stem& stemmer, const std::string& language)
+{
+  queryParser.set_default_op(Xapian::Query::op::OP_AND);
+  if (!language.empty()) {
+      icu::Locale languageLocale(language.c_str());
+      /* Configuring language base stemming */
+      try {
+          stemmer = Xapian::Stem(languageLocale.getLanguage());
+          queryParser.set_stemmer(stemmer);
+      } catch (...) {
+          std::cout << "No stemming for language '" << languageLocale.getLanguage() << "'" << std::endl;
+      }
+  }
+}
+
 void SuggestionDataBase::initXapianDb() {
   m_queryParser.set_database(m_database);
-  m_queryParser.set_default_op(Xapian::Query::op::OP_AND);
 
   auto impl = m_archive.getImpl();
   FileImpl::FindxResult r;
@@ -62,14 +86,22 @@ void SuggestionDataBase::initXapianDb() {
   }
 
   auto xapianEntry = Entry(impl, entry_index_type(r.second));
-  auto accessInfo = xapianEntry.getItem().getDirectAccessInformation();
-  if (!accessInfo.isValid()) {
-      return;
-  }
-
+  auto xapianItem = xapianEntry.getItem();
+  // Prefer the fd we already hold over reopening the file by its path.
+  auto fdAccessInfo = xapianItem.getDirectFdAccessInformation();
   Xapian::Database database;
-  if (!getDbFromAccessInfo(accessInfo, database)) {
-    return;
+  if (fdAccessInfo.isValid()) {
+    if (!getDbFromAccessInfo(fdAccessInfo, database)) {
+      return;
+    }
+  } else {
+    auto accessInfo = xapianItem.getDirectAccessInformation();
+    if (!accessInfo.isValid()) {
+        return;
+    }
+    if (!getDbFromAccessInfo(accessInfo, database)) {
+      return;
+    }
   }
 
   m_valuesmap = read_valuesmap(database.get_metadata("valuesmap"));
@@ -84,16 +116,7 @@ void SuggestionDataBase::initXapianDb() {
           language = m_archive.getMetadata("Language");
       } catch(...) {}
   }
-  if (!language.empty()) {
-      icu::Locale languageLocale(language.c_str());
-      /* Configuring language base stemming */
-      try {
-          m_stemmer = Xapian::Stem(languageLocale.getLanguage());
-          m_queryParser.set_stemmer(m_stemmer);
-      } catch (...) {
-          std::cout << "No stemming for language '" << languageLocale.getLanguage() << "'" << std::endl;
-      }
-  }
+  initSuggestionQueryParser(m_queryParser, m_stemmer, language);
 
   m_database = database;
 }
@@ -132,20 +155,19 @@ int SuggestionDataBase::valueSlot(const std::string& valueName) const
  * becomes A+B+C (normalised out of 100). So the documents closer to the query
  * gets a higher relevance.
  */
-Xapian::Query SuggestionDataBase::parseQuery(const std::string& query)
+Xapian::Query parseSuggestionQuery(Xapian::QueryParser& queryParser, const std::string& query)
 {
-  std::lock_guard<std::mutex> locker(m_mutex);
   Xapian::Query xquery;
 
   const auto flags = Xapian::QueryParser::FLAG_DEFAULT | Xapian::QueryParser::FLAG_PARTIAL | Xapian::QueryParser::FLAG_CJK_NGRAM;
 
 #if XAPIAN_MAJOR_VERSION == 2
-  m_queryParser.set_min_wildcard_prefix(0);
+  queryParser.set_min_wildcard_prefix(0);
 #endif
 
   // Reset stemming strategy for normal parsing
-  m_queryParser.set_stemming_strategy(Xapian::QueryParser::STEM_SOME);
-  xquery = m_queryParser.parse_query(query, flags);
+  queryParser.set_stemming_strategy(Xapian::QueryParser::STEM_SOME);
+  xquery = queryParser.parse_query(query, flags);
 
   if ( !query.empty() && xquery.empty() ) {
     // a non-empty query string produced an empty xapian query which means
@@ -153,14 +175,14 @@ Xapian::Query SuggestionDataBase::parseQuery(const std::string& query)
     xquery = Xapian::Query(Xapian::Query::OP_WILDCARD, query);
   } else if (!query.empty()) {
     // Reconfigure stemming strategy for phrase search
-    m_queryParser.set_stemming_strategy(Xapian::QueryParser::STEM_NONE);
+    queryParser.set_stemming_strategy(Xapian::QueryParser::STEM_NONE);
 
-    Xapian::Query subquery_phrase = m_queryParser.parse_query(query, Xapian::QueryParser::FLAG_CJK_NGRAM);
+    Xapian::Query subquery_phrase = queryParser.parse_query(query, Xapian::QueryParser::FLAG_CJK_NGRAM);
     // Force the OP_PHRASE window to be equal to the number of terms.
     subquery_phrase = Xapian::Query(Xapian::Query::OP_PHRASE, subquery_phrase.get_terms_begin(), subquery_phrase.get_terms_end(), subquery_phrase.get_length());
 
     auto qs = ANCHOR_TERM + query;
-    Xapian::Query subquery_anchored = m_queryParser.parse_query(qs, Xapian::QueryParser::FLAG_CJK_NGRAM);
+    Xapian::Query subquery_anchored = queryParser.parse_query(qs, Xapian::QueryParser::FLAG_CJK_NGRAM);
     subquery_anchored = Xapian::Query(Xapian::Query::OP_PHRASE, subquery_anchored.get_terms_begin(), subquery_anchored.get_terms_end(), subquery_anchored.get_length());
 
     xquery = Xapian::Query(Xapian::Query::OP_OR, xquery, subquery_phrase);
@@ -170,12 +192,42 @@ Xapian::Query SuggestionDataBase::parseQuery(const std::string& query)
   return xquery;
 }
 
+Xapian::Query SuggestionDataBase::parseQuery(const std::string& query)
+{
+  std::lock_guard<std::mutex> locker(m_mutex);
+  return parseSuggestionQuery(m_queryParser, query);
+}
+
+/*
+ * In suggestion mode, we are searching over a separate title index. Default BM25 is not
+ * adapted for this case. WDF factor(k1) controls the effect of within document frequency.
+ * k1 = 0.001 reduces the effect of word repetition in document. In BM25, smaller documents
+ * get larger weights, so normalising the length of documents is necessary using b = 1.
+ * The document set is first sorted by their relevance score then by value so that suggestion
+ * results are closer to search string.
+ * refer https://xapian.org/docs/apidoc/html/classXapian_1_1BM25Weight.html
+ */
+void initSuggestionEnquire(Xapian::Enquire& enquire, const std::map<std::string, int>& valuesmap)
+{
+  enquire.set_weighting_scheme(Xapian::BM25Weight(0.001,0,1,1,0.5));
+  const auto title = valuesmap.find("title");
+  if (title != valuesmap.end()) {
+    enquire.set_sort_by_relevance_then_value(title->second, false);
+  }
+
+  const auto targetPath = valuesmap.find("targetPath");
+  if (targetPath != valuesmap.end()) {
+    enquire.set_collapse_key(targetPath->second);
+  }
+}
+
 #endif  // ENABLE_XAPIAN
 
 SuggestionSearcher::SuggestionSearcher(const Archive& archive) :
     mp_internalDb(nullptr),
     m_archive(archive),
-    m_verbose(false)
+    m_verbose(false),
+    m_usePrefixIndex(false)
 {}
 
 SuggestionSearcher::SuggestionSearcher(const SuggestionSearcher& other) = default;
@@ -197,9 +249,17 @@ void SuggestionSearcher::setVerbose(bool verbose)
   m_verbose = verbose;
 }
 
+void SuggestionSearcher::setUsePrefixIndex(bool usePrefixIndex)
+{
+  if (m_usePrefixIndex != usePrefixIndex) {
+    m_usePrefixIndex = usePrefixIndex;
+    mp_internalDb.reset();
+  }
+}
+
 void SuggestionSearcher::initDatabase()
 {
-  mp_internalDb = std::make_shared<SuggestionDataBase>(m_archive, m_verbose);
+  mp_internalDb = std::make_shared<SuggestionDataBase>(m_archive, m_verbose, m_usePrefixIndex);
 }
 
 SuggestionSearch::SuggestionSearch(std::shared_ptr<SuggestionDataBase> p_internalDb, const std::string& query)
@@ -230,9 +290,43 @@ SuggestionSearch::~SuggestionSearch() = default;
 #endif
 
 
+#if defined(ENABLE_XAPIAN)
+namespace
+{
+
+// Find the suggestions of the query stored in the archive, if any. They are
+// the first results of the xapian title index for the same query.
+bool findPrefixSuggestions(const SuggestionDataBase& db, const std::string& query, TitlePrefixListing::Prefix& prefix)
+{
+  return db.mp_prefixListing && db.mp_prefixListing->find(removeAccents(query), prefix);
+}
+
+// Get the stored suggestions from `start` to `start + maxResults` (excluded),
+// if they are all stored.
+bool getPrefixSuggestions(const SuggestionDataBase& db, const std::string& query, size_t start, size_t maxResults, std::vector<entry_index_type>& entries)
+{
+  TitlePrefixListing::Prefix prefix;
+  if (!findPrefixSuggestions(db, query, prefix) || start + maxResults > prefix.entries.size()) {
+    return false;
+  }
+  entries.assign(prefix.entries.begin() + start, prefix.entries.begin() + start + maxResults);
+  return true;
+}
+
+} // unnamed namespace
+#endif  // ENABLE_XAPIAN
+
 int SuggestionSearch::getEstimatedMatches() const
 {
+  if (mp_internalDb->mp_prefixIndex) {
+    return mp_internalDb->mp_prefixIndex->count(m_query);
+  }
+
   TRY_UTILIZING_SUGGESTIONDB(
+    TitlePrefixListing::Prefix prefix;
+    if (findPrefixSuggestions(*mp_internalDb, m_query, prefix)) {
+      return prefix.count;
+    }
     auto enquire = getEnquire();
     // Force xapian to check at least 10 documents even if we ask for an
     // empty mset. Else, the get_matches_estimated() may be wrong and return 0
@@ -241,16 +335,46 @@ int SuggestionSearch::getEstimatedMatches() const
     return mset.get_matches_estimated();
   );
 
+  const auto impl = mp_internalDb->m_archive.getImpl();
+  if (impl->hasFoldedTitleIndex()) {
+    const auto range = impl->findFoldedTitleRange(foldTitle(m_query));
+    return range.second.v - range.first.v;
+  }
+
   return mp_internalDb->m_archive.findByTitle(m_query).size();
 }
 
 const SuggestionResultSet SuggestionSearch::getResults(int start, int maxResults) const {
+  if (mp_internalDb->mp_prefixIndex) {
+    return SuggestionResultSet(
+      mp_internalDb,
+      mp_internalDb->mp_prefixIndex->getBest(m_query, std::max(start, 0), std::max(maxResults, 0)));
+  }
+
   TRY_UTILIZING_SUGGESTIONDB(
+    std::vector<entry_index_type> entries;
+    if (getPrefixSuggestions(*mp_internalDb, m_query, std::max(start, 0), std::max(maxResults, 0), entries)) {
+      return SuggestionResultSet(mp_internalDb, std::move(entries));
+    }
     auto enquire = getEnquire();
     auto mset = enquire.get_mset(start, maxResults);
     return SuggestionResultSet(mp_internalDb, std::move(mset));
   );
 
+  const auto impl = mp_internalDb->m_archive.getImpl();
+  if (impl->hasFoldedTitleIndex()) {
+    // Case and accent insensitive match of the title prefix.
+    const auto range = impl->findFoldedTitleRange(foldTitle(m_query));
+    const auto begin = range.first.v + std::min<entry_index_type>(std::max(start, 0), range.second.v - range.first.v);
+    const auto end = begin + std::min<entry_index_type>(std::max(maxResults, 0), range.second.v - begin);
+    std::vector<entry_index_type> entries;
+    entries.reserve(end - begin);
+    for (auto idx = begin; idx < end; ++idx) {
+      entries.push_back(impl->getIndexByFoldedTitle(title_index_t(idx)).v);
+    }
+    return SuggestionResultSet(mp_internalDb, std::move(entries));
+  }
+
   auto entryRange = mp_internalDb->m_archive.findByTitle(m_query);
   entryRange = entryRange.offset(start, maxResults);
   return SuggestionResultSet(entryRange);
@@ -277,25 +401,7 @@ Xapian::Enquire& SuggestionSearch::getEnquire() const
         std::cout << "Parsed query '" << unaccentedQuery << "' to " << query.get_description() << std::endl;
     }
     enquire->set_query(query);
-
-   /*
-    * In suggestion mode, we are searching over a separate title index. Default BM25 is not
-    * adapted for this case. WDF factor(k1) controls the effect of within document frequency.
-    * k1 = 0.001 reduces the effect of word repetition in document. In BM25, smaller documents
-    * get larger weights, so normalising the length of documents is necessary using b = 1.
-    * The document set is first sorted by their relevance score then by value so that suggestion
-    * results are closer to search string.
-    * refer https://xapian.org/docs/apidoc/html/classXapian_1_1BM25Weight.html
-    */
-
-    enquire->set_weighting_scheme(Xapian::BM25Weight(0.001,0,1,1,0.5));
-    if (mp_internalDb->hasValue("title")) {
-      enquire->set_sort_by_relevance_then_value(mp_internalDb->valueSlot("title"), false);
-    }
-
-    if (mp_internalDb->hasValue("targetPath")) {
-      enquire->set_collapse_key(mp_internalDb->valueSlot("targetPath"));
-    }
+    initSuggestionEnquire(*enquire, mp_internalDb->m_valuesmap);
 
     mp_enquire = std::move(enquire);
     return *mp_enquire;
@@ -316,8 +422,21 @@ SuggestionResultSet::SuggestionResultSet(EntryRange entryRange) :
 #endif  // ENABLE_XAPIAN
 {}
 
+SuggestionResultSet::SuggestionResultSet(SuggestionDBPtr p_internalDb, std::vector<entry_index_type>&& entries) :
+  mp_internalDb(p_internalDb),
+  mp_entryRange(nullptr),
+  mp_entries(std::make_shared<const std::vector<entry_index_type>>(std::move(entries)))
+#if defined(ENABLE_XAPIAN)
+  , mp_mset(nullptr)
+#endif  // ENABLE_XAPIAN
+{}
+
 int SuggestionResultSet::size() const
 {
+  if (mp_entries) {
+      return mp_entries->size();
+  }
+
 #if defined(ENABLE_XAPIAN)
   if (! mp_entryRange) {
       return mp_mset->size();
@@ -34,13 +34,16 @@
 namespace zim
 {
 
+class TitlePrefixIndex;
+class TitlePrefixListing;
+
 /**
  * A class to encapsulate a xapian title index and it's archive and all the
  * information we can gather from it.
  */
 class SuggestionDataBase {
   public: // methods
-    SuggestionDataBase(const Archive& archive, bool verbose);
+    SuggestionDataBase(const Archive& archive, bool verbose, bool usePrefixIndex);
 
   public: // data
     // The archive to get suggestions from.
@@ -49,6 +52,12 @@ class SuggestionDataBase {
     // Verbosity of operations.
     bool m_verbose;
 
+    // The index of the title prefixes, if it is used.
+    std::shared_ptr<const TitlePrefixIndex> mp_prefixIndex;
+
+    // The suggestions of the short prefixes stored in the archive, if any.
+    std::shared_ptr<const TitlePrefixListing> mp_prefixListing;
+
   private: // data
     std::mutex m_mutex;
 
@@ -80,6 +89,23 @@ class SuggestionDataBase {
 #endif  // LIBZIM_WITH_XAPIAN
 };
 
+#if defined(LIBZIM_WITH_XAPIAN)
+/*
+ * How the suggestions are searched in a xapian title index. The creator uses
+ * them too, to store the suggestions of the short prefixes exactly as the
+ * readers would find them.
+ */
+
+// Configure the query parser (and its stemmer) for a title index of `language`.
+void initSuggestionQueryParser(Xapian::QueryParser& queryParser, Xapian::Stem& stemmer, const std::string& language);
+
+// Parse the (unaccented) suggestion query.
+Xapian::Query parseSuggestionQuery(Xapian::QueryParser& queryParser, const std::string& query);
+
+// Rank the documents of a title index with the values of `valuesmap`.
+void initSuggestionEnquire(Xapian::Enquire& enquire, const std::map<std::string, int>& valuesmap);
+#endif  // LIBZIM_WITH_XAPIAN
+
 
 }
 
@@ -30,44 +30,83 @@ namespace zim
 {
 
 class SuggestionIterator::Impl {
-#if defined(LIBZIM_WITH_XAPIAN)
     std::shared_ptr<SuggestionDataBase> mp_db;
+
+    // Results of the title prefix index (null for xapian results)
+    std::shared_ptr<const std::vector<entry_index_type>> mp_entries;
+    size_t m_entryIdx;
+
+#if defined(LIBZIM_WITH_XAPIAN)
     std::shared_ptr<Xapian::MSet> mp_mset;
     Xapian::MSetIterator iterator;
 
     // cached/memoized data
     mutable std::string _entryPath;
     mutable bool _entryPathValid;
+#endif
     mutable ValuePtr<Entry> _entry;
 
 public:
+    Impl(std::shared_ptr<SuggestionDataBase> p_db,
+         std::shared_ptr<const std::vector<entry_index_type>> p_entries,
+         size_t entryIdx) :
+        mp_db(p_db),
+        mp_entries(p_entries),
+        m_entryIdx(entryIdx)
+#if defined(LIBZIM_WITH_XAPIAN)
+        , _entryPathValid(false)
+#endif
+    {};
+
+#if defined(LIBZIM_WITH_XAPIAN)
     Impl(std::shared_ptr<SuggestionDataBase> p_db,
          std::shared_ptr<Xapian::MSet> p_mset,
          Xapian::MSetIterator iterator) :
         mp_db(p_db),
+        m_entryIdx(0),
         mp_mset(p_mset),
         iterator(iterator),
         _entryPathValid(false)
     {};
+#endif
 
     void operator++() {
-        ++iterator;
         _entry.reset();
+        if (mp_entries) {
+            ++m_entryIdx;
+            return;
+        }
+#if defined(LIBZIM_WITH_XAPIAN)
+        ++iterator;
         _entryPathValid = false;
+#endif
     }
 
     void operator--() {
-        --iterator;
         _entry.reset();
+        if (mp_entries) {
+            --m_entryIdx;
+            return;
+        }
+#if defined(LIBZIM_WITH_XAPIAN)
+        --iterator;
         _entryPathValid = false;
+#endif
     }
 
     SuggestionItem get_suggestion() const {
-        return SuggestionItem(getIndexTitle(),
-                              getIndexPath(),
-                              getIndexSnippet());
+#if defined(LIBZIM_WITH_XAPIAN)
+        if (!mp_entries) {
+            return SuggestionItem(getIndexTitle(),
+                                  getIndexPath(),
+                                  getIndexSnippet());
+        }
+#endif
+        const auto& entry = get_entry();
+        return SuggestionItem(entry.getTitle(), entry.getPath());
     }
 
+#if defined(LIBZIM_WITH_XAPIAN)
     std::string get_entry_path() const {
         if ( !_entryPathValid ) {
             if (iterator == mp_mset->end()) {
@@ -78,21 +117,41 @@ public:
         }
         return _entryPath;
     }
+#endif
 
     Entry& get_entry() const {
         if (!_entry) {
-            const auto path = get_entry_path();
-            _entry.reset(new Entry(mp_db->m_archive.getEntryByPath(path)));
+            if (mp_entries) {
+                if (m_entryIdx >= mp_entries->size()) {
+                    throw std::runtime_error("Cannot get entry for end iterator");
+                }
+                _entry.reset(new Entry(mp_db->m_archive.getEntryByPath((*mp_entries)[m_entryIdx])));
+            } else {
+#if defined(LIBZIM_WITH_XAPIAN)
+                const auto path = get_entry_path();
+                _entry.reset(new Entry(mp_db->m_archive.getEntryByPath(path)));
+#endif
+            }
         }
         return *_entry.get();
     }
 
     bool operator==(const Impl& other) const {
+        if (mp_entries || other.mp_entries) {
+            return (mp_db == other.mp_db
+                &&  mp_entries == other.mp_entries
+                &&  m_entryIdx == other.m_entryIdx);
+        }
+#if defined(LIBZIM_WITH_XAPIAN)
         return (mp_db == other.mp_db
             &&  mp_mset == other.mp_mset
             &&  iterator == other.iterator);
+#else
+        return false;
+#endif
     }
 
+#if defined(LIBZIM_WITH_XAPIAN)
 private:
     std::string getIndexPath() const;
     std::string getIndexTitle() const;
@@ -148,19 +207,15 @@ SuggestionIterator::SuggestionIterator(RangeIterator rangeIterator)
   : mp_rangeIterator(new RangeIterator(rangeIterator))
 {}
 
-#if defined(LIBZIM_WITH_XAPIAN)
 SuggestionIterator::SuggestionIterator(Impl* impl)
   : mp_impl(impl)
 {}
-#endif  // LIBZIM_WITH_XAPIAN
 
 SuggestionIterator::SuggestionIterator(const SuggestionIterator& it)
 {
-#if defined(LIBZIM_WITH_XAPIAN)
     if (it.mp_impl) {
         mp_impl.reset(new Impl(*it.mp_impl));
     }
-#endif  // LIBZIM_WITH_XAPIAN
 
     if (it.mp_rangeIterator) {
         mp_rangeIterator.reset(new RangeIterator(*it.mp_rangeIterator));
@@ -180,11 +235,9 @@ bool SuggestionIterator::operator==(const SuggestionIterator& it) const {
         return (*mp_rangeIterator == *it.mp_rangeIterator);
     }
 
-#if defined(LIBZIM_WITH_XAPIAN)
     if (mp_impl && it.mp_impl) {
         return (*mp_impl == *it.mp_impl);
     }
-#endif  // LIBZIM_WITH_XAPIAN
 
     return false;
 }
@@ -194,11 +247,9 @@ bool SuggestionIterator::operator!=(const SuggestionIterator& it) const {
 }
 
 SuggestionIterator& SuggestionIterator::operator++() {
-#if defined(LIBZIM_WITH_XAPIAN)
     if (mp_impl) {
         ++(*mp_impl);
     }
-#endif  // LIBZIM_WITH_XAPIAN
 
     if (mp_rangeIterator) {
         ++(*mp_rangeIterator);
@@ -214,11 +265,9 @@ SuggestionIterator SuggestionIterator::operator++(int) {
 }
 
 SuggestionIterator& SuggestionIterator::operator--() {
-#if defined(LIBZIM_WITH_XAPIAN)
     if (mp_impl) {
         --(*mp_impl);
     }
-#endif  // LIBZIM_WITH_XAPIAN
 
     if (mp_rangeIterator) {
         --(*mp_rangeIterator);
@@ -234,15 +283,17 @@ SuggestionIterator SuggestionIterator::operator--(int) {
 }
 
 Entry SuggestionIterator::getEntry() const {
-#if defined(LIBZIM_WITH_XAPIAN)
     if (mp_impl) {
+#if defined(LIBZIM_WITH_XAPIAN)
         try {
             return mp_impl->get_entry();
         } catch ( Xapian::DatabaseError& e) {
             throw ZimFileFormatError(e.get_description());
         }
-    }
+#else
+        return mp_impl->get_entry();
 #endif  // LIBZIM_WITH_XAPIAN
+    }
 
     if (mp_rangeIterator) {
         return **mp_rangeIterator;
@@ -252,11 +303,9 @@ Entry SuggestionIterator::getEntry() const {
 
 SuggestionItem* SuggestionIterator::instantiateSuggestion() const
 {
-#if defined(LIBZIM_WITH_XAPIAN)
     if (mp_impl) {
         return new SuggestionItem(mp_impl->get_suggestion());
     }
-#endif  // LIBZIM_WITH_XAPIAN
 
     if (mp_rangeIterator) {
         return new SuggestionItem((*mp_rangeIterator)->getTitle(),
@@ -288,6 +337,10 @@ const SuggestionItem* SuggestionIterator::operator->() {
 
 SuggestionResultSet::iterator SuggestionResultSet::begin() const
 {
+    if ( mp_entries ) {
+        return iterator(new iterator::Impl(mp_internalDb, mp_entries, 0));
+    }
+
 #if defined(LIBZIM_WITH_XAPIAN)
     if ( ! mp_entryRange ) {
         return iterator(new iterator::Impl(mp_internalDb, mp_mset, mp_mset->begin()));
@@ -299,6 +352,10 @@ SuggestionResultSet::iterator SuggestionResultSet::begin() const
 
 SuggestionResultSet::iterator SuggestionResultSet::end() const
 {
+    if ( mp_entries ) {
+        return iterator(new iterator::Impl(mp_internalDb, mp_entries, mp_entries->size()));
+    }
+
 #if defined(LIBZIM_WITH_XAPIAN)
     if ( ! mp_entryRange ) {
         return iterator(new iterator::Impl(mp_internalDb, mp_mset, mp_mset->end()));
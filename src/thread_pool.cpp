@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace zim {
+
+ThreadPool::ThreadPool(const std::string& name, unsigned threadCount)
+  : m_name(name),
+    m_idleCount(0),
+    m_threadCount(std::max(1U, threadCount)),
+    m_stopping(false)
+{}
+
+ThreadPool::~ThreadPool()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  stopThreads(lock);
+}
+
+ThreadPool& ThreadPool::asyncPool()
+{
+  static ThreadPool pool("async", std::thread::hardware_concurrency());
+  return pool;
+}
+
+void ThreadPool::submit(Task task)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_tasks.push_back(std::move(task));
+  if (!m_stopping) {
+    startThreads();
+  }
+  m_taskAvailable.notify_one();
+}
+
+void ThreadPool::startThreads()
+{
+  // Busy threads will not take the queued tasks before they are done with
+  // their current one.
+  while (m_threads.size() < m_threadCount && m_idleCount < m_tasks.size()) {
+    m_threads.emplace_back(new NamedThread(m_name + std::to_string(m_threads.size()), [this]() { run(); }));
+    // The new thread is counted as idle until it runs a task.
+    ++m_idleCount;
+  }
+}
+
+unsigned ThreadPool::getThreadCount() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_threadCount;
+}
+
+void ThreadPool::setThreadCount(unsigned threadCount)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_threadCount = std::max(1U, threadCount);
+  stopThreads(lock);
+}
+
+void ThreadPool::stopThreads(std::unique_lock<std::mutex>& lock)
+{
+  m_stopping = true;
+  m_taskAvailable.notify_all();
+  std::vector<std::unique_ptr<NamedThread>> threads;
+  threads.swap(m_threads);
+  lock.unlock();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  lock.lock();
+  m_stopping = false;
+  // Tasks submitted while stopping have no thread to run them.
+  startThreads();
+}
+
+void ThreadPool::run()
+{
+  // The thread has been counted as idle when started.
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+    --m_idleCount;
+    if (m_tasks.empty()) {
+      // Stopping and all tasks done.
+      return;
+    }
+    auto task = std::move(m_tasks.front());
+    m_tasks.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+    ++m_idleCount;
+  }
+}
+
+};
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_THREAD_POOL_H_
+#define ZIM_THREAD_POOL_H_
+
+#include "namedthread.h"
+#include "config.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace zim {
+
+/** A pool of threads running tasks in submission order.
+ *
+ * Threads are started lazily, on the first submission.
+ */
+class LIBZIM_PRIVATE_API ThreadPool {
+  public: // types
+    typedef std::function<void()> Task;
+
+  public: // functions
+    ThreadPool(const std::string& name, unsigned threadCount);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Wait for all the submitted tasks to be run.
+    ~ThreadPool();
+
+    // The pool used by the asynchronous item API.
+    static ThreadPool& asyncPool();
+
+    // Tasks must not throw.
+    void submit(Task task);
+
+    unsigned getThreadCount() const;
+
+    // Wait for the running threads to complete the submitted tasks and
+    // stop them. The new threads are started at next submission.
+    // Must not be called from a task of the pool.
+    void setThreadCount(unsigned threadCount);
+
+  private: // functions
+    void run();
+    void stopThreads(std::unique_lock<std::mutex>& lock);
+    // Start the threads needed to run the queued tasks. Must be called with
+    // m_mutex locked.
+    void startThreads();
+
+  private: // data
+    const std::string m_name;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::deque<Task> m_tasks;
+    std::vector<std::unique_ptr<NamedThread>> m_threads;
+    // The number of threads waiting for a task.
+    size_t m_idleCount;
+    unsigned m_threadCount;
+    bool m_stopping;
+};
+
+};
+
+#endif // ZIM_THREAD_POOL_H_
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include "title_prefix_index.h"
+#include "endian_tools.h"
+#include "tools.h"
+
+#include <zim/error.h>
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+namespace zim
+{
+
+namespace
+{
+
+const size_t BLOCK_SIZE = 16;
+
+void writeVarint(std::string& out, size_t value)
+{
+  while (value >= 0x80) {
+    out += char(0x80 | (value & 0x7F));
+    value >>= 7;
+  }
+  out += char(value);
+}
+
+// Decode the successive keys of a block.
+class KeyReader
+{
+  public:
+    explicit KeyReader(const char* data) : mp_data(data) {}
+
+    const std::string& next() {
+      const size_t shared = readVarint();
+      const size_t suffixSize = readVarint();
+      m_key.resize(shared);
+      m_key.append(mp_data, suffixSize);
+      mp_data += suffixSize;
+      return m_key;
+    }
+
+  private:
+    size_t readVarint() {
+      size_t value = 0;
+      for (int shift = 0; ; shift += 7) {
+        const unsigned char byte = *mp_data++;
+        value |= size_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+          return value;
+        }
+      }
+    }
+
+    const char* mp_data;
+    std::string m_key;
+};
+
+} // unnamed namespace
+
+TitlePrefixIndex::TitlePrefixIndex(std::vector<Title> titles)
+{
+  if (titles.size() >= std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Too many titles to index");
+  }
+
+  std::vector<uint16_t> ranks;
+  ranks.reserve(titles.size());
+  for (auto& title: titles) {
+    ranks.push_back(std::min<size_t>(title.title.size(), std::numeric_limits<uint16_t>::max()));
+    title.title = foldTitle(title.title);
+  }
+
+  std::vector<uint32_t> order(titles.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&titles](uint32_t a, uint32_t b) {
+    if (titles[a].title != titles[b].title) {
+      return titles[a].title < titles[b].title;
+    }
+    return titles[a].entry < titles[b].entry;
+  });
+
+  m_entries.reserve(titles.size());
+  m_ranks.reserve(titles.size());
+  const std::string* previous = nullptr;
+  for (size_t i = 0; i < order.size(); ++i) {
+    const auto& title = titles[order[i]];
+    size_t shared = 0;
+    if (i % BLOCK_SIZE == 0) {
+      m_blockOffsets.push_back(m_keys.size());
+    } else {
+      const auto limit = std::min(previous->size(), title.title.size());
+      while (shared < limit && (*previous)[shared] == title.title[shared]) {
+        ++shared;
+      }
+    }
+    writeVarint(m_keys, shared);
+    writeVarint(m_keys, title.title.size() - shared);
+    m_keys.append(title.title, shared, std::string::npos);
+    previous = &title.title;
+
+    m_entries.push_back(title.entry);
+    m_ranks.push_back(ranks[order[i]]);
+  }
+  m_keys.shrink_to_fit();
+
+  m_leafCount = 1;
+  while (m_leafCount < m_entries.size()) {
+    m_leafCount *= 2;
+  }
+  // The padding leaves hold the (invalid) index `size()`.
+  m_tree.assign(2 * m_leafCount, uint32_t(m_entries.size()));
+  for (uint32_t i = 0; i < m_entries.size(); ++i) {
+    m_tree[m_leafCount + i] = i;
+  }
+  for (size_t node = m_leafCount - 1; node > 0; --node) {
+    const auto left = m_tree[2 * node];
+    const auto right = m_tree[2 * node + 1];
+    m_tree[node] = isBetter(right, left) ? right : left;
+  }
+}
+
+bool TitlePrefixIndex::isBetter(uint32_t a, uint32_t b) const
+{
+  if (a >= m_entries.size()) {
+    return false;
+  }
+  if (b >= m_entries.size()) {
+    return true;
+  }
+  if (m_ranks[a] != m_ranks[b]) {
+    return m_ranks[a] < m_ranks[b];
+  }
+  return a < b;
+}
+
+uint32_t TitlePrefixIndex::getBest(size_t begin, size_t end) const
+{
+  uint32_t best = uint32_t(m_entries.size());
+  for (begin += m_leafCount, end += m_leafCount; begin < end; begin /= 2, end /= 2) {
+    if (begin & 1) {
+      const auto candidate = m_tree[begin++];
+      best = isBetter(candidate, best) ? candidate : best;
+    }
+    if (end & 1) {
+      const auto candidate = m_tree[--end];
+      best = isBetter(candidate, best) ? candidate : best;
+    }
+  }
+  return best;
+}
+
+size_t TitlePrefixIndex::lowerBound(const std::string& foldedKey) const
+{
+  // Find the first block starting with a key not lower than `foldedKey`.
+  size_t low = 0;
+  size_t high = m_blockOffsets.size();
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (KeyReader(m_keys.data() + m_blockOffsets[middle]).next() < foldedKey) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  if (low == 0) {
+    return 0;
+  }
+
+  // The lower bound is in the previous block (or is the start of `low`).
+  const size_t block = low - 1;
+  const size_t end = std::min((block + 1) * BLOCK_SIZE, m_entries.size());
+  KeyReader reader(m_keys.data() + m_blockOffsets[block]);
+  for (size_t i = block * BLOCK_SIZE; i < end; ++i) {
+    if (!(reader.next() < foldedKey)) {
+      return i;
+    }
+  }
+  return end;
+}
+
+TitlePrefixIndex::Range TitlePrefixIndex::getRange(const std::string& prefix) const
+{
+  const auto foldedPrefix = foldTitle(prefix);
+  if (foldedPrefix.empty()) {
+    return Range(0, m_entries.size());
+  }
+  // No utf-8 (folded) title contains the byte 0xFF, so this is the first key
+  // after all the keys starting with the prefix.
+  return Range(lowerBound(foldedPrefix), lowerBound(foldedPrefix + '\xFF'));
+}
+
+size_t TitlePrefixIndex::count(const std::string& prefix) const
+{
+  const auto range = getRange(prefix);
+  return range.second - range.first;
+}
+
+std::vector<entry_index_type> TitlePrefixIndex::getBest(const std::string& prefix, size_t start, size_t maxResults) const
+{
+  // The best title of a range is returned before the best titles of the
+  // two sub ranges around it.
+  struct Candidate {
+    uint32_t best;
+    size_t begin;
+    size_t end;
+  };
+  const auto isWorse = [this](const Candidate& a, const Candidate& b) {
+    return isBetter(b.best, a.best);
+  };
+  std::priority_queue<Candidate, std::vector<Candidate>, decltype(isWorse)> candidates(isWorse);
+
+  const auto addCandidate = [&](size_t begin, size_t end) {
+    if (begin < end) {
+      candidates.push({getBest(begin, end), begin, end});
+    }
+  };
+
+  const auto range = getRange(prefix);
+  addCandidate(range.first, range.second);
+  std::vector<entry_index_type> results;
+  for (size_t rank = 0; rank < start + maxResults && !candidates.empty(); ++rank) {
+    const auto candidate = candidates.top();
+    candidates.pop();
+    if (rank >= start) {
+      results.push_back(m_entries[candidate.best]);
+    }
+    addCandidate(candidate.begin, candidate.best);
+    addCandidate(candidate.best + 1, candidate.end);
+  }
+  return results;
+}
+
+TitlePrefixListing::TitlePrefixListing(const Blob& data)
+  : m_data(data),
+    m_count(0)
+{
+  if (m_data.size() < sizeof(uint32_t)) {
+    throw ZimFileFormatError("Title prefix listing is too small");
+  }
+  m_count = fromLittleEndian<uint32_t>(m_data.data());
+  if ((m_data.size() - sizeof(uint32_t)) / sizeof(uint32_t) < m_count) {
+    throw ZimFileFormatError("Title prefix listing is too small");
+  }
+}
+
+const char* TitlePrefixListing::getRecord(uint32_t idx) const
+{
+  const auto offset = fromLittleEndian<uint32_t>(m_data.data() + sizeof(uint32_t) * (idx + 1));
+  // The record must at least contain the prefix, the count and the entry count.
+  if (offset >= m_data.size()
+   || m_data.size() - offset < 1 + size_t(uint8_t(m_data.data()[offset])) + sizeof(uint32_t) + 1) {
+    throw ZimFileFormatError("Invalid title prefix listing");
+  }
+  return m_data.data() + offset;
+}
+
+std::string TitlePrefixListing::readPrefix(uint32_t idx) const
+{
+  const char* record = getRecord(idx);
+  return std::string(record + 1, uint8_t(record[0]));
+}
+
+bool TitlePrefixListing::find(const std::string& key, Prefix& prefix) const
+{
+  uint32_t lo = 0;
+  uint32_t hi = m_count;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (readPrefix(mid) < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == m_count || readPrefix(lo) != key) {
+    return false;
+  }
+
+  const char* p = getRecord(lo);
+  const size_t prefixSize = uint8_t(*p++);
+  prefix.prefix.assign(p, prefixSize);
+  p += prefixSize;
+  prefix.count = fromLittleEndian<uint32_t>(p);
+  p += sizeof(uint32_t);
+  const size_t entryCount = uint8_t(*p++);
+  if (size_t(m_data.end() - p) / sizeof(uint32_t) < entryCount) {
+    throw ZimFileFormatError("Invalid title prefix listing");
+  }
+  prefix.entries.clear();
+  for (size_t i = 0; i < entryCount; ++i, p += sizeof(uint32_t)) {
+    prefix.entries.push_back(fromLittleEndian<uint32_t>(p));
+  }
+  return true;
+}
+
+size_t TitlePrefixListing::recordSize(const Prefix& prefix)
+{
+  return sizeof(uint32_t) // The offset of the record.
+       + 1 + prefix.prefix.size()
+       + sizeof(uint32_t)
+       + 1 + prefix.entries.size() * sizeof(uint32_t);
+}
+
+std::string TitlePrefixListing::serialize(const std::vector<Prefix>& prefixes)
+{
+  std::string records;
+  std::string header(sizeof(uint32_t) * (prefixes.size() + 1), '\0');
+  toLittleEndian(uint32_t(prefixes.size()), &header[0]);
+  char buffer[sizeof(uint32_t)];
+  for (size_t i = 0; i < prefixes.size(); ++i) {
+    const auto& prefix = prefixes[i];
+    if (prefix.prefix.size() > 255 || prefix.entries.size() > 255) {
+      throw std::runtime_error("Title prefix record too big");
+    }
+    toLittleEndian(uint32_t(header.size() + records.size()), &header[sizeof(uint32_t) * (i + 1)]);
+    records += char(prefix.prefix.size());
+    records += prefix.prefix;
+    toLittleEndian(uint32_t(prefix.count), buffer);
+    records.append(buffer, sizeof(buffer));
+    records += char(prefix.entries.size());
+    for (const auto entry: prefix.entries) {
+      toLittleEndian(uint32_t(entry), buffer);
+      records.append(buffer, sizeof(buffer));
+    }
+  }
+  return header + records;
+}
+
+} // namespace zim
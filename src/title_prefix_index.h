@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#ifndef ZIM_TITLE_PREFIX_INDEX_H
+#define ZIM_TITLE_PREFIX_INDEX_H
+
+#include <zim/zim.h>
+#include <zim/blob.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "config.h"
+
+namespace zim
+{
+
+/**
+ * An in-memory index answering title prefix queries.
+ *
+ * The titles are folded (see `foldTitle()`), sorted and front coded by
+ * blocks: only the first title of a block is stored in full, the others only
+ * store what differs from the previous title. The titles starting with a
+ * prefix are a range of the sorted titles, found with a binary search on the
+ * blocks.
+ *
+ * The titles are ranked by size (shortest first, then in title order): a
+ * short title is the closest completion of a prefix. A segment tree over the
+ * ranks gives the best titles of a range without scanning it, even for
+ * the (huge) ranges of the one letter prefixes.
+ */
+class LIBZIM_PRIVATE_API TitlePrefixIndex
+{
+  public: // types
+    struct Title {
+      std::string title;
+      entry_index_type entry;
+    };
+
+  public: // functions
+    explicit TitlePrefixIndex(std::vector<Title> titles);
+
+    // The number of titles starting with `prefix`.
+    size_t count(const std::string& prefix) const;
+
+    // The entries of the titles starting with `prefix`, from the rank `start`
+    // to `start + maxResults` (excluded).
+    std::vector<entry_index_type> getBest(const std::string& prefix, size_t start, size_t maxResults) const;
+
+    size_t size() const { return m_entries.size(); }
+
+  private: // types
+    typedef std::pair<size_t, size_t> Range;
+
+  private: // functions
+    Range getRange(const std::string& prefix) const;
+    size_t lowerBound(const std::string& foldedKey) const;
+
+    // Whether the title `a` ranks before the title `b`.
+    bool isBetter(uint32_t a, uint32_t b) const;
+    // The best title of the range [begin, end).
+    uint32_t getBest(size_t begin, size_t end) const;
+
+  private: // data
+    // The front coded folded titles.
+    std::string m_keys;
+    std::vector<size_t> m_blockOffsets;
+
+    // The entries and ranks, in the order of the folded titles.
+    std::vector<entry_index_type> m_entries;
+    std::vector<uint16_t> m_ranks;
+
+    // The best title of each node. Leaves start at `m_leafCount`.
+    std::vector<uint32_t> m_tree;
+    size_t m_leafCount;
+};
+
+/**
+ * The first suggestions of the xapian title index for short prefixes,
+ * computed at creation time.
+ *
+ * The listing starts with the number of prefixes and the offset of each
+ * prefix record (uint32), so a prefix is found with a binary search. A record
+ * is the (unaccented) prefix (uint8 size + bytes), the estimated number of
+ * matches of the index (uint32) and the first suggestions (uint8 count +
+ * uint32 entry indexes). Records are sorted by prefix and all integers are
+ * little endian.
+ */
+class LIBZIM_PRIVATE_API TitlePrefixListing
+{
+  public: // types
+    struct Prefix {
+      std::string prefix;
+      entry_index_type count;
+      std::vector<entry_index_type> entries;
+    };
+
+  public: // functions
+    explicit TitlePrefixListing(const Blob& data);
+
+    // Find the record of the prefix.
+    bool find(const std::string& key, Prefix& prefix) const;
+
+    size_t size() const { return m_count; }
+
+    // The size of the record of `prefix` in the listing.
+    static size_t recordSize(const Prefix& prefix);
+    // `prefixes` must be sorted by prefix and have at most 255 entries.
+    static std::string serialize(const std::vector<Prefix>& prefixes);
+
+  private: // functions
+    std::string readPrefix(uint32_t idx) const;
+    const char* getRecord(uint32_t idx) const;
+
+  private: // data
+    Blob m_data;
+    uint32_t m_count;
+};
+
+} // namespace zim
+
+#endif // ZIM_TITLE_PREFIX_INDEX_H
@@ -213,6 +213,116 @@ std::string zim::stripMimeParameters(const std::string& rawMimeType) {
   return rawMimeType.substr(0, rawMimeType.find_first_of("; \t"));
 }
 
+namespace
+{
+
+// Base letters of U+00C0-U+00FF and U+0100-U+017F ('?' for the characters
+// folded to several letters or kept as is).
+const char LATIN1_BASE_LETTERS[] =
+  "aaaaaa?ceeeeiiiidnooooo?ouuuuy??aaaaaa?ceeeeiiiidnooooo?ouuuuy?y";
+const char LATIN_EXTENDED_A_BASE_LETTERS[] =
+  "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii??jjkkkllllllllll"
+  "nnnnnnnnnoooooo??rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+
+const char* foldLigature(uint32_t c)
+{
+  switch (c) {
+    case 0xC6: case 0xE6: return "ae";
+    case 0xDE: case 0xFE: return "th";
+    case 0xDF: return "ss";
+    case 0x132: case 0x133: return "ij";
+    case 0x152: case 0x153: return "oe";
+    default: return nullptr;
+  }
+}
+
+uint32_t foldLetter(uint32_t c)
+{
+  if (c >= 'A' && c <= 'Z') {
+    return c + ('a' - 'A');
+  }
+  if (c >= 0xC0 && c < 0x100 && LATIN1_BASE_LETTERS[c - 0xC0] != '?') {
+    return LATIN1_BASE_LETTERS[c - 0xC0];
+  }
+  if (c >= 0x100 && c < 0x180 && LATIN_EXTENDED_A_BASE_LETTERS[c - 0x100] != '?') {
+    return LATIN_EXTENDED_A_BASE_LETTERS[c - 0x100];
+  }
+  // Greek capitals and final sigma
+  if ((c >= 0x391 && c <= 0x3A9 && c != 0x3A2) || c == 0x3C2) {
+    return c == 0x3C2 ? 0x3C3 : c + 0x20;
+  }
+  // Cyrillic capitals
+  if (c >= 0x400 && c < 0x410) {
+    return c + 0x50;
+  }
+  if (c >= 0x410 && c < 0x430) {
+    return c + 0x20;
+  }
+  return c;
+}
+
+void appendUtf8(std::string& out, uint32_t c)
+{
+  if (c < 0x80) {
+    out += char(c);
+  } else if (c < 0x800) {
+    out += char(0xC0 | (c >> 6));
+    out += char(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    out += char(0xE0 | (c >> 12));
+    out += char(0x80 | ((c >> 6) & 0x3F));
+    out += char(0x80 | (c & 0x3F));
+  } else {
+    out += char(0xF0 | (c >> 18));
+    out += char(0x80 | ((c >> 12) & 0x3F));
+    out += char(0x80 | ((c >> 6) & 0x3F));
+    out += char(0x80 | (c & 0x3F));
+  }
+}
+
+} // unnamed namespace
+
+std::string zim::foldTitle(const std::string& title)
+{
+  std::string folded;
+  folded.reserve(title.size());
+  for (size_t i = 0; i < title.size(); ) {
+    const unsigned char lead = title[i];
+    const size_t length = lead < 0x80 ? 1
+                        : (lead >> 5) == 0x6 ? 2
+                        : (lead >> 4) == 0xE ? 3
+                        : (lead >> 3) == 0x1E ? 4
+                        : 0;
+    uint32_t c = length == 1 ? lead
+               : length == 2 ? lead & 0x1F
+               : length == 3 ? lead & 0x0F
+               : lead & 0x07;
+    bool valid = length != 0 && i + length <= title.size();
+    for (size_t k = 1; valid && k < length; ++k) {
+      const unsigned char next = title[i + k];
+      valid = (next & 0xC0) == 0x80;
+      c = (c << 6) | (next & 0x3F);
+    }
+    if (!valid) {
+      // Not utf-8, keep the byte as is.
+      folded += title[i++];
+      continue;
+    }
+    i += length;
+
+    // Combining diacritical marks (of decomposed characters)
+    if (c >= 0x300 && c < 0x370) {
+      continue;
+    }
+    if (const auto ligature = foldLigature(c)) {
+      folded += ligature;
+      continue;
+    }
+    appendUtf8(folded, foldLetter(c));
+  }
+  return folded;
+}
+
 namespace
 {
 // The counter metadata format is a list of item separated by a `;` :
@@ -345,6 +455,42 @@ bool zim::getDbFromAccessInfo(zim::ItemDataDirectAccessInfo accessInfo, Xapian::
   return true;
 }
 
+bool zim::getDbFromAccessInfo(const zim::ItemDataDirectFdAccessInfo& accessInfo, Xapian::Database& database) {
+#ifdef _WIN32
+  return false;
+#else
+  // Xapian reads the database from the current position of the fd it owns.
+  // A duplicated fd shares its position with the original one (and all other
+  // duplicates), so the opening of the databases must be serialized.
+  // Once opened, xapian only uses positional reads.
+  static std::mutex positionMutex;
+  std::lock_guard<std::mutex> lock(positionMutex);
+
+  zim::DEFAULTFS::FD databasefd(dup(*accessInfo.fd));
+  if (databasefd.getNativeHandle() == -1) {
+      std::cerr << "Impossible to duplicate the fd of the zimfile" << std::endl;
+      std::cerr << strerror(errno) << std::endl;
+      return false;
+  }
+  if (!databasefd.seek(zim::offset_t(accessInfo.offset))) {
+      std::cerr << "Something went wrong seeking databasedb" << std::endl;
+      std::cerr << "dbOffest = " << accessInfo.offset << std::endl;
+      return false;
+  }
+
+  try {
+      database = Xapian::Database(databasefd.release());
+  } catch( Xapian::DatabaseError& e) {
+      std::cerr << "Something went wrong opening xapian database" << std::endl;
+      std::cerr << "dbOffest = " << accessInfo.offset << std::endl;
+      std::cerr << "error = " << e.get_msg() << std::endl;
+      return false;
+  }
+
+  return true;
+#endif
+}
+
 void zim::setICUDataDirectory(const std::string& path)
 {
   u_setDataDirectory(path.c_str());
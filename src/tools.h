@@ -58,6 +58,15 @@ namespace zim {
 
   std::string LIBZIM_PRIVATE_API stripMimeParameters(const std::string& rawMimeType);
 
+  /** Fold the case and the accents of a title.
+   *
+   * This is a simple and stable folding (of latin, greek and cyrillic
+   * letters), which doesn't depend on ICU. The same title is always folded
+   * the same way, so folded titles can be stored and compared with the
+   * folding of a query.
+   */
+  std::string LIBZIM_PRIVATE_API foldTitle(const std::string& title);
+
   using MimeCounterType = std::map<const std::string, zim::entry_index_type>;
   MimeCounterType LIBZIM_PRIVATE_API parseMimetypeCounter(const std::string& counterData);
 
@@ -76,6 +85,8 @@ namespace zim {
 #if defined(ENABLE_XAPIAN)
   std::string LIBZIM_PRIVATE_API removeAccents(const std::string& text);
   bool LIBZIM_PRIVATE_API getDbFromAccessInfo(zim::ItemDataDirectAccessInfo accessInfo, Xapian::Database& database);
+  // Open the database from a duplicate of the (already opened) fd.
+  bool LIBZIM_PRIVATE_API getDbFromAccessInfo(const zim::ItemDataDirectFdAccessInfo& accessInfo, Xapian::Database& database);
 #endif
 }
 
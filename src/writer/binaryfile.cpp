@@ -1,8 +1,11 @@
 #include "binaryfile.h"
+#include "../md5.h"
 
 #include <fcntl.h>
 #include <cstring>
 
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 #ifdef _WIN32
@@ -80,6 +83,31 @@ void BinaryFile::write(const char* buf, size_t size)
   if ( fwrite(buf, 1, size, file) != size ) {
     throw std::runtime_error(std::strerror(errno));
   }
+  if ( checksumContext ) {
+    addToChecksum(reinterpret_cast<const unsigned char*>(buf), size);
+  }
+}
+
+void BinaryFile::startChecksum()
+{
+  checksumContext.reset(new zim_MD5_CTX);
+  zim_MD5Init(checksumContext.get());
+}
+
+void BinaryFile::addToChecksum(const unsigned char* data, size_t size)
+{
+  while ( size ) {
+    const unsigned int chunkSize = std::min<size_t>(size, std::numeric_limits<unsigned int>::max());
+    zim_MD5Update(checksumContext.get(), data, chunkSize);
+    data += chunkSize;
+    size -= chunkSize;
+  }
+}
+
+void BinaryFile::finishChecksum(unsigned char digest[16])
+{
+  zim_MD5Final(digest, checksumContext.get());
+  checksumContext.reset();
 }
 
 } // namespace writer
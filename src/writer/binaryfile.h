@@ -23,9 +23,12 @@
 #include "config.h"
 #include "zim/zim.h"
 
+#include <memory>
 #include <string>
 #include <stdio.h>
 
+struct zim_MD5_CTX;
+
 namespace zim
 {
 
@@ -50,12 +53,22 @@ public: // functions
 
   void write(const char* buf, size_t size);
 
+  // Compute the MD5 of all data subsequently written to the file, until
+  // `finishChecksum()`.
+  void startChecksum();
+  // Add data not written to the file to the MD5.
+  void addToChecksum(const unsigned char* data, size_t size);
+  // Stop computing the MD5 and get it.
+  void finishChecksum(unsigned char digest[16]);
+
   void flush();
 
 private: // data
   // For our use cases C stdio proves to be significantly more efficient than
   // std::ofstream or (untuned) custom buffering over raw syscalls to write()
   FILE* file = nullptr;
+  // The MD5 being computed, if any.
+  std::unique_ptr<zim_MD5_CTX> checksumContext;
 };
 
 } // namespace writer
@@ -24,6 +24,7 @@
 #include "../endian_tools.h"
 #include "../debug.h"
 #include "../compression.h"
+#include "../md5.h"
 
 #include <zim/writer/contentProvider.h>
 #include <zim/tools.h>
@@ -151,32 +152,39 @@ void Cluster::_compress()
 
 void Cluster::write(BinaryFile& f) const
 {
+  struct zim_MD5_CTX md5ctx;
+  zim_MD5Init(&md5ctx);
+
+  // Ideally we would simply have to do :
+  // ::write(tmp_fd, data.c_str(), data.size());
+  // However, the data can be pretty big (> 4Gb), especially with test,
+  // And ::write fails to write data > 4Gb. So we have to chunk the write.
+  // We also keep track of the checksum of what is written.
+  auto writeToFile = [&f, &md5ctx](const char* src, size_type to_write) -> void {
+    while (to_write) {
+     const size_type chunk_size = std::min(MAX_WRITE_SIZE, to_write);
+     f.write(src, chunk_size);
+     zim_MD5Update(&md5ctx, reinterpret_cast<const unsigned char*>(src), unsigned(chunk_size));
+     src += chunk_size;
+     to_write -= chunk_size;
+    }
+  };
+
   // write clusterInfo
   char clusterInfo = 0;
   if (isExtended) {
     clusterInfo = 0x10;
   }
   clusterInfo += static_cast<uint8_t>(getCompression());
-  f.write(&clusterInfo, 1);
+  writeToFile(&clusterInfo, 1);
 
   // Open a compression stream if needed
   switch(getCompression())
   {
     case Compression::None:
     {
-      auto writer = [&f](const Blob& data) -> void {
-        // Ideally we would simply have to do :
-        // ::write(tmp_fd, data.c_str(), data.size());
-        // However, the data can be pretty big (> 4Gb), especially with test,
-        // And ::write fails to write data > 4Gb. So we have to chunk the write.
-        size_type to_write = data.size();
-        const char* src = data.data();
-        while (to_write) {
-         const size_type chunk_size = std::min(MAX_WRITE_SIZE, to_write);
-         f.write(src, chunk_size);
-         src += chunk_size;
-         to_write -= chunk_size;
-        }
+      auto writer = [&writeToFile](const Blob& data) -> void {
+        writeToFile(data.data(), data.size());
       };
       write_content(writer);
       break;
@@ -185,7 +193,7 @@ void Cluster::write(BinaryFile& f) const
     case Compression::Zstd:
       {
         log_debug("compress data");
-        f.write(compressed_data.data(), compressed_data.size());
+        writeToFile(compressed_data.data(), compressed_data.size());
         break;
       }
 
@@ -195,6 +203,7 @@ void Cluster::write(BinaryFile& f) const
       log_error(fmt_msg);
       throw std::runtime_error(fmt_msg);
   }
+  zim_MD5Final(checksum.data(), &md5ctx);
 }
 
 
@@ -26,6 +26,7 @@
 #include <vector>
 #include <functional>
 #include <atomic>
+#include <array>
 
 #include <zim/writer/item.h>
 #include "../zim_types.h"
@@ -78,6 +79,11 @@ class LIBZIM_PRIVATE_API Cluster {
 
     void write(BinaryFile&) const;
 
+    // MD5 digest of the cluster as written in the zim file.
+    // Only valid once the cluster has been written.
+    typedef std::array<unsigned char, 16> Checksum;
+    const Checksum& getChecksum() const { return checksum; }
+
   protected:
     Compression compression;
     cluster_index_t index;
@@ -88,6 +94,7 @@ class LIBZIM_PRIVATE_API Cluster {
     ClusterProviders m_providers;
     mutable Blob compressed_data;
     std::string tmp_filename;
+    mutable Checksum checksum;
     std::atomic<bool> closed { false };
     blob_index_type m_count { 0 };
 
@@ -44,13 +44,13 @@
 #if defined(ENABLE_XAPIAN)
 # include "xapianHandler.h"
 # include "xapianIndexer.h"
+# include "../suggestion_internal.h"
 #endif
 
 #ifdef _WIN32
 # include <io.h>
 #else
-# define _write(fd, addr, size) if(::write((fd), (addr), (size)) != (ssize_t)(size)) \
-{throw std::runtime_error("Error writing");}
+# include <unistd.h>
 #endif
 
 #include <sys/stat.h>
@@ -61,9 +61,12 @@
 #include <sstream>
 #include <ctime>
 #include <deque>
+#include <map>
+#include <vector>
 #include "log.h"
 #include "../fs.h"
 #include "../tools.h"
+#include "../title_prefix_index.h"
 
 log_define("zim.writer.creator")
 
@@ -207,62 +210,160 @@ class TitleListingProvider : public ContentProvider {
     DirentPtrs::const_iterator m_it;
 };
 
-typedef std::deque<offset_t> DirentOffsets;
+// The front articles sorted by folded title (see zim::foldTitle()), the plain
+// title being used to order titles folding to the same key. Readers can then
+// look up a case and accent insensitive title prefix with a binary search.
+class FoldedTitleListingProvider : public ContentProvider {
+  public:
+    explicit FoldedTitleListingProvider(const CreatorData::UrlSortedDirents& dirents) {
+      for ( Dirent* const d : dirents ) {
+        if ( d->isFrontArticle() ) {
+          m_dirents.emplace_back(zim::foldTitle(d->getTitle()), d);
+        }
+      }
+
+      std::sort(m_dirents.begin(), m_dirents.end(), compareFoldedTitle);
+      m_it = m_dirents.begin();
+    }
+
+    zim::size_type getSize() const override {
+        return m_dirents.size() * sizeof(zim::entry_index_type);
+    }
+
+    zim::Blob feed() override {
+      char* p = buffer;
+      for ( ; m_it != m_dirents.end() && p != buffer + sizeof(buffer); ++m_it ) {
+        zim::toLittleEndian(m_it->second->getIdx().v, p);
+        p += sizeof(zim::entry_index_type);
+      }
+      return zim::Blob(buffer, p - buffer);
+    }
+
+  private:
+    typedef std::pair<std::string, const Dirent*> FoldedDirent;
 
-DirentOffsets writeDirents(BinaryFile& f, const CreatorData::UrlSortedDirents& dirents)
+    static bool compareFoldedTitle(const FoldedDirent& d1, const FoldedDirent& d2) {
+      if ( d1.first != d2.first ) {
+        return d1.first < d2.first;
+      }
+      return compareTitle(d1.second, d2.second);
+    }
+
+    typedef std::vector<FoldedDirent> FoldedDirents;
+    FoldedDirents m_dirents;
+    char buffer[1024 * sizeof(zim::entry_index_type)];
+    FoldedDirents::const_iterator m_it;
+};
+
+// The user entries (C namespace) sorted by cluster and blob, redirects first.
+// The cluster numbers are only known once all clusters are closed, so the
+// listing is sorted on the first call to feed(), when the (uncompressed)
+// cluster containing it is written.
+class ClusterOrderListingProvider : public ContentProvider {
+  public:
+    explicit ClusterOrderListingProvider(const CreatorData::UrlSortedDirents& dirents)
+      : m_sorted(false) {
+      for ( Dirent* const d : dirents ) {
+        if ( d->getNamespace() == NS::C ) {
+          m_dirents.push_back(d);
+        }
+      }
+      m_it = m_dirents.begin();
+    }
+
+    zim::size_type getSize() const override {
+        return m_dirents.size() * sizeof(zim::entry_index_type);
+    }
+
+    zim::Blob feed() override {
+      if (!m_sorted) {
+        std::stable_sort(m_dirents.begin(), m_dirents.end(), compareClusterOrder);
+        m_it = m_dirents.begin();
+        m_sorted = true;
+      }
+      char* p = buffer;
+      for ( ; m_it != m_dirents.end() && p != buffer + sizeof(buffer); ++m_it ) {
+        zim::toLittleEndian((*m_it)->getIdx().v, p);
+        p += sizeof(zim::entry_index_type);
+      }
+      return zim::Blob(buffer, p - buffer);
+    }
+
+  private:
+    static bool compareClusterOrder(const Dirent* d1, const Dirent* d2) {
+      if ( d1->isRedirect() || d2->isRedirect() ) {
+        return d1->isRedirect() && !d2->isRedirect();
+      }
+      return std::make_pair(d1->getClusterNumber(), d1->getBlobNumber())
+           < std::make_pair(d2->getClusterNumber(), d2->getBlobNumber());
+    }
+
+    typedef std::vector<const Dirent*> DirentPtrs;
+    DirentPtrs m_dirents;
+    bool m_sorted;
+    char buffer[1024 * sizeof(zim::entry_index_type)];
+    DirentPtrs::const_iterator m_it;
+};
+
+// Provides the checksums of all the clusters preceding the one containing
+// the listing. The listing is stored in the last cluster and is uncompressed,
+// so feed() is called by the cluster writer once all the previous clusters
+// have been written (and their checksums computed).
+class ClusterChecksumListingProvider : public ContentProvider {
+  public:
+    explicit ClusterChecksumListingProvider(const CreatorData::ClusterList& clusters)
+      : m_clusters(clusters.begin(), clusters.end()),
+        m_it(m_clusters.begin())
+    {}
+
+    zim::size_type getSize() const override {
+        return m_clusters.size() * sizeof(Cluster::Checksum);
+    }
+
+    zim::Blob feed() override {
+      char* p = buffer;
+      for ( ; m_it != m_clusters.end() && p != buffer + sizeof(buffer); ++m_it ) {
+        const auto& checksum = (*m_it)->getChecksum();
+        std::copy(checksum.begin(), checksum.end(), p);
+        p += sizeof(Cluster::Checksum);
+      }
+      return zim::Blob(buffer, p - buffer);
+    }
+
+  private:
+    typedef std::vector<const Cluster*> Clusters;
+    const Clusters m_clusters;
+    char buffer[1024 * sizeof(Cluster::Checksum)];
+    Clusters::const_iterator m_it;
+};
+
+void writeDirents(BinaryFile& f, const CreatorData::UrlSortedDirents& dirents)
 {
-  DirentOffsets direntOffsets;
-  f.seekEnd();
   for (Dirent* dirent: dirents)
   {
-    direntOffsets.push_back(offset_t(f.tellFilePos()));
     dirent->write(f);
   }
-  return direntOffsets;
 }
 
-void writeDirentOffsets(BinaryFile& f, const DirentOffsets& direntOffsets)
+// The dirent offsets are reconstructed as a running sum of the dirent sizes
+// starting from the offset of the first dirent.
+void writeDirentOffsets(BinaryFile& f,
+                        const CreatorData::UrlSortedDirents& dirents,
+                        offset_type firstDirentOffset)
 {
-  for (auto offset : direntOffsets)
+  offset_type offset = firstDirentOffset;
+  for (Dirent* dirent: dirents)
   {
     char tmp_buff[sizeof(offset_type)];
     toLittleEndian(offset, tmp_buff);
     f.write(tmp_buff, sizeof(offset_type));
+    offset += dirent->getDirentSize();
   }
 }
 
-void writeChecksum(int fd)
-{
-  struct zim_MD5_CTX md5ctx;
-  unsigned char batch_read[1024+1];
-  lseek(fd, 0, SEEK_SET);
-  zim_MD5Init(&md5ctx);
-  while (true) {
-     auto r = read(fd, batch_read, 1024);
-     if (r == -1) {
-       throw std::runtime_error(std::strerror(errno));
-     }
-     if (r == 0)
-       break;
-     batch_read[r] = 0;
-     zim_MD5Update(&md5ctx, batch_read, r);
-  }
-  unsigned char digest[16];
-  zim_MD5Final(digest, &md5ctx);
-  _write(fd, reinterpret_cast<const char*>(digest), 16);
-}
-
-void addChecksum(const std::string& filePath)
-{
-#ifdef _WIN32
-  const int flag = _O_RDWR | _O_BINARY;
-#else
-  const int flag = O_RDWR;
-#endif
-  const int fd = ::open(filePath.c_str(), flag);
-  writeChecksum(fd);
-  ::close(fd);
-}
+// The prefixes of the title words of up to this number of characters may have
+// stored suggestions.
+const unsigned MAX_SUGGESTION_PREFIX_CHARS = 3;
 
 } // unnamed namespace
 
@@ -297,6 +398,19 @@ Creator& Creator::configIndexing(bool indexing, const std::string& language)
   return *this;
 }
 
+Creator& Creator::configSearchSnippets(zim::size_type maxSize)
+{
+  m_snippetSize = maxSize;
+  return *this;
+}
+
+Creator& Creator::configPrefixSuggestions(unsigned nbSuggestions, zim::size_type maxSize)
+{
+  m_nbPrefixSuggestions = std::min(nbSuggestions, 255U);
+  m_prefixSuggestionsSize = maxSize;
+  return *this;
+}
+
 Creator& Creator::configNbWorkers(unsigned nbWorkers)
 {
   m_nbWorkers = nbWorkers;
@@ -306,7 +420,7 @@ Creator& Creator::configNbWorkers(unsigned nbWorkers)
 void Creator::startZimCreation(const std::string& filepath)
 {
   data = std::unique_ptr<CreatorData>(
-    new CreatorData(filepath, m_verbose, m_withIndex, m_indexingLanguage, m_compression, m_clusterSize)
+    new CreatorData(filepath, m_verbose, m_withIndex, m_indexingLanguage, m_snippetSize, m_compression, m_clusterSize)
   );
 
   for(unsigned i=0; i<m_nbWorkers; i++)
@@ -423,6 +537,9 @@ void Creator::finishZimCreation()
   checkError();
 
   data->createDirent(NS::X, "listing/titleOrdered/v1", "application/octet-stream+zimlisting", "");
+  data->createDirent(NS::X, "listing/foldedTitleOrdered/v1", "application/octet-stream+zimlisting", "");
+  data->createDirent(NS::X, "listing/clusterOrdered/v1", "application/octet-stream+zimlisting", "");
+  data->createDirent(NS::X, "listing/clusterChecksums/v1", "application/octet-stream+zimlisting", "");
 
   // Create a redirection for the mainPage.
   // We need to keep the created dirent to set the fileheader.
@@ -451,7 +568,7 @@ void Creator::finishZimCreation()
   data->removeLoopsAndBlindChainsOfRedirects();
   data->dropRemovedRedirects();
 
-  data->indexTitles();
+  data->indexTitles(m_nbPrefixSuggestions, m_prefixSuggestionsSize);
 
   TINFO("Set entry indices");
   data->setEntryIndexes();
@@ -478,6 +595,10 @@ void Creator::finishZimCreation()
   }
 
   data->addTitleListingData();
+  data->addFoldedTitleListingData();
+  data->addTitlePrefixListingData();
+  data->addClusterOrderListingData();
+  data->addClusterChecksumListingData();
 
   // All the data has been added, we can now close all clusters
   if (data->compCluster->count())
@@ -500,6 +621,7 @@ void Creator::finishZimCreation()
   TINFO(data->clustersList.size() << " clusters created");
 
   TINFO("write zimfile :");
+  INFO("Adding checksum...");
   writeLastParts();
   data->outFile.closeFile();
 
@@ -507,8 +629,6 @@ void Creator::finishZimCreation()
   DEFAULTFS::rename(data->tmpFileName, data->zimName);
   data->tmpFileName.clear();
 
-  INFO("Adding checksum...");
-  addChecksum(data->zimName);
   INFO("ZIM file is ready!");
 
   TINFO("finish");
@@ -538,31 +658,20 @@ void Creator::writeLastParts() const
 
   BinaryFile& outFile = data->outFile;
 
-  outFile.seek(header.getMimeListPos());
-  TINFO(" write mimetype list");
-  for(auto& mimeType: data->mimeTypesList)
-  {
-    outFile.write(mimeType.c_str(), mimeType.size()+1);
-  }
-
-  outFile.write("", 1);
-
-  ASSERT(outFile.tellFilePos(), <, offset_type(CLUSTER_BASE_OFFSET));
+  // The checksum is the MD5 of the header area (everything before the first
+  // cluster) followed by the MD5 of the rest of the file. The latter has been
+  // computed since the first cluster was written: it ends with the parts
+  // written here, before the header.
+  ASSERT(data->clustersList.empty(), ==, false);
+  ASSERT(data->clustersList.front()->getOffset().v, ==, offset_type(CLUSTER_BASE_OFFSET));
 
-  { // writing dirents
-
-  // TODO: Memory usage by direntOffsets can be reduced by replacing
-  // TODO: the offset values with dirent size values and reconstructing
-  // TODO: the offsets as a running sum starting from the offset of the
-  // TODO: first dirent
+  const offset_type direntsPos = outFile.seekEnd();
   TINFO(" write directory entries");
-  const DirentOffsets direntOffsets = writeDirents(outFile, data->dirents);
+  writeDirents(outFile, data->dirents);
 
   TINFO(" write path ptr list");
   header.setPathPtrPos(outFile.tellFilePos());
-  writeDirentOffsets(outFile, direntOffsets);
-
-  } // writing dirents
+  writeDirentOffsets(outFile, data->dirents, direntsPos);
 
   TINFO(" write cluster offset list");
   header.setClusterPtrPos(outFile.tellFilePos());
@@ -574,10 +683,34 @@ void Creator::writeLastParts() const
   }
 
   header.setChecksumPos(outFile.tellFilePos());
+  unsigned char clustersDigest[16];
+  outFile.finishChecksum(clustersDigest);
 
   TINFO(" write header");
   outFile.seek(0);
+  outFile.startChecksum();
   header.write(outFile);
+
+  ASSERT(outFile.tellFilePos(), ==, header.getMimeListPos());
+  TINFO(" write mimetype list");
+  for(auto& mimeType: data->mimeTypesList)
+  {
+    outFile.write(mimeType.c_str(), mimeType.size()+1);
+  }
+
+  outFile.write("", 1);
+
+  ASSERT(outFile.tellFilePos(), <, offset_type(CLUSTER_BASE_OFFSET));
+  // Fill the header area up to the first cluster, all of it is hashed.
+  const std::string padding(offset_type(CLUSTER_BASE_OFFSET) - outFile.tellFilePos(), '\0');
+  outFile.write(padding.data(), padding.size());
+  outFile.addToChecksum(clustersDigest, sizeof(clustersDigest));
+
+  TINFO(" write checksum");
+  unsigned char digest[16];
+  outFile.finishChecksum(digest);
+  outFile.seek(header.getChecksumPos());
+  outFile.write(reinterpret_cast<const char*>(digest), 16);
 }
 
 void Creator::checkError()
@@ -597,6 +730,7 @@ CreatorData::CreatorData(const std::string& fname,
                                bool verbose,
                                bool withIndex,
                                std::string language,
+                               size_t snippetSize,
                                Compression c,
                                size_t clusterSize)
   : mainPageDirent(nullptr),
@@ -607,6 +741,7 @@ CreatorData::CreatorData(const std::string& fname,
     clusterSize(clusterSize),
     withIndex(withIndex),
     indexingLanguage(language),
+    snippetSize(snippetSize),
     verbose(verbose),
     nbRedirectItems(0),
     nbCompItems(0),
@@ -618,6 +753,8 @@ CreatorData::CreatorData(const std::string& fname,
 {
   outFile.openFile(tmpFileName);
   outFile.seek(CLUSTER_BASE_OFFSET);
+  // The clusters are hashed as they are written (see `writeLastParts()`).
+  outFile.startChecksum();
 
   // We keep both a "compressed cluster" and an "uncompressed cluster"
   // because we don't know which one will fill up first.  We also need
@@ -949,6 +1086,56 @@ void CreatorData::addTitleListingData()
   addItemData(*d, std::move(listingProvider), false);
 }
 
+void CreatorData::addFoldedTitleListingData()
+{
+  Dirent* const d = *findDirent(NS::X, "listing/foldedTitleOrdered/v1");
+  auto listingProvider = std::make_unique<FoldedTitleListingProvider>(this->dirents);
+  addItemData(*d, std::move(listingProvider), false);
+}
+
+void CreatorData::addTitlePrefixListingData()
+{
+  if (titlePrefixSuggestions.empty()) {
+    return;
+  }
+
+  std::vector<TitlePrefixListing::Prefix> prefixes;
+  for ( auto& suggestions : titlePrefixSuggestions ) {
+    auto& prefix = suggestions.first;
+    prefix.entries.clear();
+    for ( const Dirent* const dirent : suggestions.second ) {
+      prefix.entries.push_back(dirent->getIdx().v);
+    }
+    prefixes.push_back(std::move(prefix));
+  }
+  titlePrefixSuggestions.clear();
+
+  Dirent* const d = *findDirent(NS::X, "listing/titlePrefixes/v1");
+  auto listingProvider = std::make_unique<StringProvider>(TitlePrefixListing::serialize(prefixes));
+  addItemData(*d, std::move(listingProvider), false);
+}
+
+void CreatorData::addClusterOrderListingData()
+{
+  Dirent* const d = *findDirent(NS::X, "listing/clusterOrdered/v1");
+  auto listingProvider = std::make_unique<ClusterOrderListingProvider>(this->dirents);
+  addItemData(*d, std::move(listingProvider), false);
+}
+
+void CreatorData::addClusterChecksumListingData()
+{
+  // The listing must be alone in the last cluster to be written.
+  if (compCluster->count())
+    closeCluster(true);
+
+  if (uncompCluster->count())
+    closeCluster(false);
+
+  Dirent* const d = *findDirent(NS::X, "listing/clusterChecksums/v1");
+  auto listingProvider = std::make_unique<ClusterChecksumListingProvider>(this->clustersList);
+  addItemData(*d, std::move(listingProvider), false);
+}
+
 #if defined(ENABLE_XAPIAN)
 namespace
 {
@@ -967,10 +1154,110 @@ void indexTitle(XapianIndexer& indexer, const Dirent& dirent)
   }
 }
 
+// Add the prefixes of 1 to `MAX_SUGGESTION_PREFIX_CHARS` characters of the
+// words of `text` to `prefixes`, with their number of characters.
+void addWordPrefixes(const std::string& text, std::map<std::string, unsigned>& prefixes)
+{
+  size_t wordStart = 0;
+  while ( wordStart < text.size() ) {
+    const size_t wordEnd = std::min(text.find(' ', wordStart), text.size());
+    size_t prefixEnd = wordStart;
+    for ( unsigned nbChars = 1; nbChars <= MAX_SUGGESTION_PREFIX_CHARS && prefixEnd < wordEnd; ++nbChars ) {
+      // Skip the utf-8 continuation bytes.
+      do {
+        ++prefixEnd;
+      } while ( prefixEnd < wordEnd && (text[prefixEnd] & 0xC0) == 0x80 );
+      prefixes.emplace(text.substr(wordStart, prefixEnd - wordStart), nbChars);
+    }
+    wordStart = wordEnd + 1;
+  }
+}
+
 } // unnamed namespace
+
+/*
+ * The stored suggestions of a prefix are the first results of the title index
+ * for the same query, found the same way the readers search it. The readers
+ * can then answer these queries (or their first pages) without searching the
+ * index, and continue with the index for the next pages.
+ *
+ * The candidates are the prefixes of the title words (as written and folded).
+ * The shortest ones match the most titles and are the most expensive to
+ * search: they are kept first, then the ones starting the most titles, until
+ * the listing reaches `maxSize`.
+ */
+void CreatorData::findTitlePrefixSuggestions(const std::string& indexPath, unsigned nbSuggestions, size_t maxSize)
+{
+  // The number of characters of each prefix and the number of titles having
+  // a word starting with it.
+  std::map<std::string, std::pair<unsigned, size_t>> candidates;
+  for ( Dirent* const d : dirents ) {
+    const auto title = d->getTitle();
+    if ( !d->isFrontArticle() || title.empty() ) {
+      continue;
+    }
+    std::map<std::string, unsigned> prefixes;
+    const auto unaccentedTitle = removeAccents(title);
+    addWordPrefixes(unaccentedTitle, prefixes);
+    addWordPrefixes(foldTitle(unaccentedTitle), prefixes);
+    for ( const auto& prefix : prefixes ) {
+      auto& candidate = candidates[prefix.first];
+      candidate.first = prefix.second;
+      ++candidate.second;
+    }
+  }
+
+  std::vector<std::pair<std::string, std::pair<unsigned, size_t>>> sortedCandidates(candidates.begin(), candidates.end());
+  std::stable_sort(sortedCandidates.begin(), sortedCandidates.end(), [](const auto& a, const auto& b) {
+    if ( a.second.first != b.second.first ) {
+      return a.second.first < b.second.first;
+    }
+    return a.second.second > b.second.second;
+  });
+
+  Xapian::Database database(indexPath);
+  Xapian::QueryParser queryParser;
+  Xapian::Stem stemmer;
+  initSuggestionQueryParser(queryParser, stemmer, database.get_metadata("language"));
+  Xapian::Enquire enquire(database);
+  initSuggestionEnquire(enquire, read_valuesmap(database.get_metadata("valuesmap")));
+
+  size_t size = sizeof(uint32_t);
+  for ( const auto& candidate : sortedCandidates ) {
+    enquire.set_query(parseSuggestionQuery(queryParser, candidate.first));
+    const auto mset = enquire.get_mset(0, nbSuggestions);
+    std::vector<Dirent*> suggestions;
+    for ( auto it = mset.begin(); it != mset.end(); ++it ) {
+      // The data of a document is the full path of its entry.
+      const auto fullPath = it.get_document().get_data();
+      const auto direntIt = findDirent(NS::C, fullPath.substr(2));
+      ASSERT(direntIt != dirents.end(), ==, true);
+      suggestions.push_back(*direntIt);
+    }
+
+    TitlePrefixListing::Prefix prefix;
+    prefix.prefix = candidate.first;
+    // The estimation the readers get from the index.
+    prefix.count = enquire.get_mset(0, 0, 10).get_matches_estimated();
+    // The entries are set once they have their index.
+    prefix.entries.resize(suggestions.size());
+    size += TitlePrefixListing::recordSize(prefix);
+    if ( size > maxSize ) {
+      break;
+    }
+    titlePrefixSuggestions.emplace_back(std::move(prefix), std::move(suggestions));
+  }
+  std::sort(titlePrefixSuggestions.begin(), titlePrefixSuggestions.end(), [](const auto& a, const auto& b) {
+    return a.first.prefix < b.first.prefix;
+  });
+
+  if (!titlePrefixSuggestions.empty()) {
+    createDirent(NS::X, "listing/titlePrefixes/v1", "application/octet-stream+zimlisting", "");
+  }
+}
 #endif // defined(ENABLE_XAPIAN)
 
-void CreatorData::indexTitles()
+void CreatorData::indexTitles(unsigned nbPrefixSuggestions, size_t prefixSuggestionsSize)
 {
   INFO("Index titles");
 #if defined(ENABLE_XAPIAN)
@@ -989,6 +1276,13 @@ void CreatorData::indexTitles()
                                    "application/octet-stream+xapian", "");
     auto fileDataProvider = std::make_unique<FileProvider>(tmpFilePath);
     addItemData(*d, std::move(fileDataProvider), false);
+
+    // Without an indexing language, the readers stem the queries with the
+    // language of the archive: we cannot search the index as they do.
+    if ( nbPrefixSuggestions && !indexingLanguage.empty() ) {
+      INFO("Compute title prefix suggestions");
+      findTitlePrefixSuggestions(tmpFilePath, nbPrefixSuggestions, prefixSuggestionsSize);
+    }
   }
 #endif // defined(ENABLE_XAPIAN)
 }
@@ -35,6 +35,7 @@
 #include "config.h"
 
 #include "../fileheader.h"
+#include "../title_prefix_index.h"
 #include "direntPool.h"
 #include "binaryfile.h"
 
@@ -66,6 +67,7 @@ namespace zim
 
         CreatorData(const std::string& fname, bool verbose,
                        bool withIndex, std::string language,
+                       size_t snippetSize,
                        Compression compression,
                        size_t clusterSize);
         virtual ~CreatorData();
@@ -97,8 +99,15 @@ namespace zim
         DirentIterator removeDirent(DirentIterator it);
         void removeDirent(Dirent* dirent);
 
-        void indexTitles();
+        void indexTitles(unsigned nbPrefixSuggestions, size_t prefixSuggestionsSize);
+#if defined(ENABLE_XAPIAN)
+        void findTitlePrefixSuggestions(const std::string& indexPath, unsigned nbSuggestions, size_t maxSize);
+#endif
         void addTitleListingData();
+        void addFoldedTitleListingData();
+        void addTitlePrefixListingData();
+        void addClusterOrderListingData();
+        void addClusterChecksumListingData();
 
         DirentPool  pool;
 
@@ -129,6 +138,12 @@ namespace zim
 
         bool withIndex;
         std::string indexingLanguage;
+        size_t snippetSize;
+
+        // The suggestions of the short title prefixes found in the title index
+        // (see `findTitlePrefixSuggestions()`), with the dirents of the entries
+        // to store once they have their index.
+        std::vector<std::pair<TitlePrefixListing::Prefix, std::vector<Dirent*>>> titlePrefixSuggestions;
 
         std::vector<std::shared_ptr<DirentHandler>> m_direntHandlers;
         void handle(const Dirent& dirent) {
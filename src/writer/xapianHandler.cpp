@@ -29,7 +29,7 @@
 using namespace zim::writer;
 
 XapianHandler::XapianHandler(CreatorData* data)
-  : mp_fulltextIndexer(new XapianIndexer(data->zimName+"_fulltext.idx", data->indexingLanguage, IndexingMode::FULL, true)),
+  : mp_fulltextIndexer(new XapianIndexer(data->zimName+"_fulltext.idx", data->indexingLanguage, IndexingMode::FULL, true, data->snippetSize)),
     mp_creatorData(data)
 {}
 
@@ -33,10 +33,11 @@
 using namespace zim::writer;
 
 /* Constructor */
-XapianIndexer::XapianIndexer(const std::string& indexPath, const std::string& language, IndexingMode indexingMode, const bool verbose)
+XapianIndexer::XapianIndexer(const std::string& indexPath, const std::string& language, IndexingMode indexingMode, const bool verbose, size_t snippetSize)
     : indexPath(indexPath),
       language(language),
-      indexingMode(indexingMode)
+      indexingMode(indexingMode),
+      snippetSize(snippetSize)
 {
   /* Build ICU Local object to retrieve ISO-639 language code (from
      ISO-639-3) */
@@ -82,6 +83,8 @@ XapianIndexer::~XapianIndexer()
  * Slot 0: Title of the article. Used in collapsing articles with same name.
  * Slot 1: Word count of the article.
  * Slot 2: Geo position of the article. Used for geo-filtering.
+ * Slot 3: Excerpt of the indexed text of the article (only if configured).
+ *         Used to generate search snippets.
  *
  * `kind` metadata indicate whether the database is a title or a fulltext index.
  *
@@ -100,7 +103,9 @@ void XapianIndexer::indexingPrelude()
       writableDatabase.set_metadata("data", "fullPath");
       break;
     case IndexingMode::FULL:
-      writableDatabase.set_metadata("valuesmap", "title:0;wordcount:1;geo.position:2");
+      writableDatabase.set_metadata("valuesmap",
+        snippetSize ? "title:0;wordcount:1;geo.position:2;snippet:3"
+                    : "title:0;wordcount:1;geo.position:2");
       writableDatabase.set_metadata("kind", "fulltext");
       writableDatabase.set_metadata("data", "fullPath");
       break;
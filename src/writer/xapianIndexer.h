@@ -42,7 +42,7 @@ enum class IndexingMode {
 class XapianIndexer
 {
  public:
-  XapianIndexer(const std::string& indexPath, const std::string& language, IndexingMode mode, bool verbose);
+  XapianIndexer(const std::string& indexPath, const std::string& language, IndexingMode mode, bool verbose, size_t snippetSize = 0);
   virtual ~XapianIndexer();
   std::string getIndexPath() { return indexPath; }
   void indexingPrelude();
@@ -60,6 +60,8 @@ class XapianIndexer
   std::string language;
   std::string stopwords;
   IndexingMode indexingMode;
+  // The maximum size of the excerpts stored as snippets (0 to not store them).
+  size_t snippetSize;
 
  friend class zim::writer::IndexTask;
 };
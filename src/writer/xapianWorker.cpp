@@ -40,6 +40,23 @@ namespace zim
       return contentLength / 500 + 1;
     }
 
+    // The start of `text`, of at most `maxSize` bytes. If possible, the text
+    // is cut at a space, else at a utf8 character boundary.
+    inline std::string getExcerpt(const std::string& text, size_t maxSize)
+    {
+      if (text.size() <= maxSize) {
+        return text;
+      }
+      auto size = text.rfind(' ', maxSize);
+      if (size == std::string::npos || size < maxSize / 2) {
+        size = maxSize;
+        while (size > 0 && (text[size] & 0xC0) == 0x80) {
+          --size;
+        }
+      }
+      return text.substr(0, size);
+    }
+
     void IndexTask::run(CreatorData* data) {
       if (!mp_indexData->hasIndexData()) {
         return;
@@ -76,6 +93,9 @@ namespace zim
       auto indexContent = mp_indexData->getContent();
       if (!indexContent.empty()) {
         indexer.index_text_without_positions(indexContent);
+        if (mp_indexer->snippetSize) {
+          document.add_value(3, getExcerpt(indexContent, mp_indexer->snippetSize));
+        }
       }
 
       /* Index the title */
@@ -35,6 +35,11 @@
 
 #include "gtest/gtest.h"
 
+#include <fstream>
+#include <future>
+#include <map>
+#include <thread>
+
 namespace
 {
 
@@ -189,11 +194,11 @@ TEST_F(ZimArchive, openCreatedArchive)
 
   zim::Archive archive(tempPath);
 #if !defined(ENABLE_XAPIAN)
-// listingIndex + M/Counter + M/Title + mainpage + 2*Illustration + 2*Item + redirection
-#define ALL_ENTRY_COUNT 9U
+// 4*listingIndex + M/Counter + M/Title + mainpage + 2*Illustration + 2*Item + redirection
+#define ALL_ENTRY_COUNT 12U
 #else
 // same as above + 2 xapian indexes.
-#define ALL_ENTRY_COUNT 11U
+#define ALL_ENTRY_COUNT 14U
 #endif
   ASSERT_EQ(archive.getAllEntryCount(), ALL_ENTRY_COUNT);
 #undef ALL_ENTRY_COUNT
@@ -264,6 +269,517 @@ TEST_F(ZimArchive, openCreatedArchive)
   ASSERT_THROW(archive.getEntryByPathWithNamespace('C', "non/existent/path"), zim::EntryNotFound);
 }
 
+TEST_F(ZimArchive, openCreatedArchiveLazily)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+
+  zim::writer::Creator creator;
+  creator.startZimCreation(tempPath);
+  auto item = std::make_shared<TestItem>("foo", "text/html", "Foo", "FooContent", IsFrontArticle::YES);
+  creator.addItem(item);
+  item = std::make_shared<TestItem>("foo2", "text/html", "AFoo", "Foo2Content", IsFrontArticle::NO);
+  creator.addItem(item);
+  creator.addMetadata("Title", "This is a title");
+  creator.setMainPath("foo");
+  creator.finishZimCreation();
+
+  const zim::Archive eagerArchive(tempPath);
+  const zim::Archive archive(tempPath, zim::OpenConfig().lazyOpen(true));
+
+  // Header based information doesn't need the indexes.
+  ASSERT_EQ(archive.getUuid(), eagerArchive.getUuid());
+  ASSERT_EQ(archive.getAllEntryCount(), eagerArchive.getAllEntryCount());
+  ASSERT_TRUE(archive.hasMainEntry());
+
+  ASSERT_EQ(archive.getEntryCount(), 2U);
+  ASSERT_EQ(archive.getArticleCount(), 1U);
+  ASSERT_EQ(archive.getMetadata("Title"), "This is a title");
+  ASSERT_EQ(archive.getMainEntry().getRedirectEntryIndex(), archive.getEntryByPath("foo").getIndex());
+  ASSERT_EQ(std::string(archive.getEntryByPath("foo2").getItem().getData()), "Foo2Content");
+  ASSERT_EQ(archive.getEntryByTitle("Foo").getPath(), "foo");
+  ASSERT_EQ(archive.getEntryByPath("foo").getItem().getMimetype(), "text/html");
+  ASSERT_TRUE(archive.check());
+}
+
+TEST_F(ZimArchive, lazyOpeningDefersIndexesValidation)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+
+  zim::writer::Creator creator;
+  creator.startZimCreation(tempPath);
+  creator.addItem(std::make_shared<TestItem>("foo", "text/html", "Foo", "FooContent"));
+  creator.finishZimCreation();
+
+  std::string zimfileContent;
+  {
+    std::ifstream in(tempPath, std::ios::binary);
+    zimfileContent.assign(std::istreambuf_iterator<char>(in), {});
+  }
+  // Move the cluster pointer table out of the file.
+  const zim::offset_type clusterPtrPos = zimfileContent.size() - 4;
+  for ( int i = 0; i < 8; ++i ) {
+    zimfileContent[48+i] = char((clusterPtrPos >> (8*i)) & 0xff);
+  }
+  const auto tmpfile = makeTempFile("corrupted_cluster_ptr_pos", zimfileContent);
+
+  EXPECT_THROW( zim::Archive(tmpfile->path()), zim::ZimFileFormatError );
+
+  const zim::Archive archive(tmpfile->path(), zim::OpenConfig().lazyOpen(true));
+  ASSERT_EQ(archive.getAllEntryCount(), zim::Archive(tempPath).getAllEntryCount());
+  EXPECT_THROW( archive.getEntryCount(), zim::ZimFileFormatError );
+  // A failed loading is retried (and fails again) at next access.
+  EXPECT_THROW( archive.getEntryByPath("foo"), zim::ZimFileFormatError );
+}
+
+TEST_F(ZimArchive, fdPoolLimitsOpenedFiles)
+{
+  const int ARCHIVE_COUNT = 3;
+  std::vector<std::unique_ptr<TempFile>> tempFiles;
+  for ( int i = 0; i < ARCHIVE_COUNT; ++i ) {
+    tempFiles.emplace_back(new TempFile("zimfile"));
+    zim::writer::Creator creator;
+    creator.startZimCreation(tempFiles.back()->path());
+    for ( int j = 0; j < 2; ++j ) {
+      const auto path = "foo" + std::to_string(j);
+      const auto content = "FooContent" + std::to_string(i) + std::to_string(j);
+      creator.addItem(std::make_shared<TestItem>(path, "text/html", path, content));
+    }
+    creator.finishZimCreation();
+  }
+
+  // The pool is process wide: restore its configuration whatever the
+  // outcome of the test, and only check the counters relatively.
+  struct FdPoolSizeRestorer {
+    const size_t maxSize = zim::getFdPoolMaxSize();
+    ~FdPoolSizeRestorer() { zim::setFdPoolMaxSize(maxSize); }
+  } restorer;
+  zim::setFdPoolMaxSize(0);
+
+  const auto initialSize = zim::getFdPoolCurrentSize();
+  std::vector<zim::Archive> archives;
+  for ( auto& tempFile : tempFiles ) {
+    archives.emplace_back(tempFile->path());
+  }
+  ASSERT_EQ(zim::getFdPoolCurrentSize(), initialSize + ARCHIVE_COUNT);
+
+  zim::setFdPoolMaxSize(1);
+  ASSERT_EQ(zim::getFdPoolCurrentSize(), 1U);
+  const auto missCount = zim::getFdPoolMissCount();
+  const auto hitCount = zim::getFdPoolHitCount();
+
+  for ( int j = 0; j < 2; ++j ) {
+    for ( int i = 0; i < ARCHIVE_COUNT; ++i ) {
+      const TestContext ctx{ {"archive", std::to_string(i) }, {"item", std::to_string(j) } };
+      const auto item = archives[i].getEntryByPath("foo" + std::to_string(j)).getItem();
+      ASSERT_EQ(std::string(item.getData()), "FooContent" + std::to_string(i) + std::to_string(j)) << ctx;
+      ASSERT_EQ(zim::getFdPoolCurrentSize(), 1U) << ctx;
+    }
+  }
+  // Each archive (but the last one) has been closed then reopened.
+  ASSERT_GE(zim::getFdPoolMissCount(), missCount + ARCHIVE_COUNT - 1);
+  ASSERT_GT(zim::getFdPoolHitCount(), hitCount);
+  ASSERT_TRUE(archives[0].check());
+
+  zim::setFdPoolMaxSize(0);
+  ASSERT_EQ(zim::getFdPoolMaxSize(), 0U);
+  archives.clear();
+  ASSERT_EQ(zim::getFdPoolCurrentSize(), initialSize);
+}
+
+TEST_F(ZimArchive, getDataReader)
+{
+  std::string bigContent;
+  for ( int i = 0; i < 100000; ++i ) {
+    bigContent += "line " + std::to_string(i) + "\n";
+  }
+
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  {
+    zim::writer::Creator creator;
+    creator.configClusterSize(16*1024*1024);
+    creator.startZimCreation(tempPath);
+    creator.addItem(std::make_shared<TestItem>("foo", "text/html", "Foo", "FooContent"));
+    creator.addItem(std::make_shared<TestItem>("big", "text/html", "Big", bigContent));
+    creator.addItem(std::make_shared<TestItem>("image", "image/png", "Image", "ImageContent"));
+    creator.addItem(std::make_shared<TestItem>("empty", "text/html", "Empty", ""));
+    creator.finishZimCreation();
+  }
+
+  const auto readAll = [](zim::ItemReader reader) {
+    std::string data;
+    char chunk[1000];
+    while ( const auto n = reader.read(chunk, sizeof(chunk)) ) {
+      data.append(chunk, n);
+    }
+    EXPECT_EQ(reader.getRemainingSize(), 0U);
+    return data;
+  };
+
+  const zim::Archive archive(tempPath);
+  const auto big = archive.getEntryByPath("big").getItem();
+  const auto clusterCacheSize = zim::getClusterCacheCurrentSize();
+  ASSERT_EQ(big.getDataReader().getSize(), bigContent.size());
+  ASSERT_EQ(readAll(big.getDataReader()), bigContent);
+  ASSERT_EQ(readAll(big.getDataReader(1234)), bigContent.substr(1234));
+  ASSERT_EQ(readAll(big.getDataReader(bigContent.size()+10)), "");
+  // Streaming doesn't put the cluster in the cache.
+  ASSERT_EQ(zim::getClusterCacheCurrentSize(), clusterCacheSize);
+
+  ASSERT_EQ(readAll(archive.getEntryByPath("foo").getItem().getDataReader()), "FooContent");
+  ASSERT_EQ(readAll(archive.getEntryByPath("image").getItem().getDataReader(5)), "Content");
+  ASSERT_EQ(readAll(archive.getEntryByPath("empty").getItem().getDataReader()), "");
+}
+
+std::string concatChunks(const std::vector<zim::Blob>& chunks)
+{
+  std::string data;
+  for ( const auto& chunk : chunks ) {
+    data.append(chunk.data(), chunk.size());
+  }
+  return data;
+}
+
+#ifndef _WIN32
+TEST_F(ZimArchive, getDataChunks)
+{
+  std::string content;
+  for ( int i = 0; i < 10000; ++i ) {
+    content += "chunk" + std::to_string(i);
+  }
+
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  {
+    zim::writer::Creator creator;
+    creator.startZimCreation(tempPath);
+    // Images are not compressed.
+    creator.addItem(std::make_shared<TestItem>("image", "image/png", "Image", content));
+    creator.addItem(std::make_shared<TestItem>("foo", "text/html", "Foo", "FooContent"));
+    creator.addItem(std::make_shared<TestItem>("empty", "text/html", "Empty", ""));
+    creator.finishZimCreation();
+  }
+
+  zim::offset_type imageOffset;
+  {
+    const zim::Archive archive(tempPath);
+    const auto item = archive.getEntryByPath("image").getItem();
+    ASSERT_EQ(concatChunks(item.getDataChunks()), content);
+    imageOffset = item.getDirectAccessInformation().offset;
+    ASSERT_NE(imageOffset, 0U);
+  }
+
+  // Split the archive in the middle of the image.
+  const auto fileSize = zim::DEFAULTFS::openFile(tempPath).getSize().v;
+  const auto splitOffset = imageOffset + content.size()/2;
+  const int fd = temp.fd();
+  const zim::Archive archive(std::vector<zim::FdInput>{
+    zim::FdInput(fd, 0, splitOffset),
+    zim::FdInput(fd, splitOffset, fileSize - splitOffset)
+  });
+  ASSERT_TRUE(archive.isMultiPart());
+
+  const auto image = archive.getEntryByPath("image").getItem();
+  const auto chunks = image.getDataChunks();
+  ASSERT_EQ(chunks.size(), 2U);
+  ASSERT_EQ(chunks[0].size(), content.size()/2);
+  ASSERT_EQ(concatChunks(chunks), content);
+  ASSERT_EQ(concatChunks(image.getDataChunks(10)), content.substr(10));
+  ASSERT_EQ(concatChunks(image.getDataChunks(10, 20)), content.substr(10, 20));
+  ASSERT_EQ(image.getDataChunks(0, content.size()/2).size(), 1U);
+  ASSERT_EQ(std::string(image.getData()), content);
+
+  const auto fooChunks = archive.getEntryByPath("foo").getItem().getDataChunks();
+  ASSERT_EQ(fooChunks.size(), 1U);
+  ASSERT_EQ(concatChunks(fooChunks), "FooContent");
+
+  ASSERT_TRUE(archive.getEntryByPath("empty").getItem().getDataChunks().empty());
+}
+
+TEST_F(ZimArchive, getDirectFdAccessInformation)
+{
+  const std::string content = "ImageContent";
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  {
+    zim::writer::Creator creator;
+    creator.startZimCreation(tempPath);
+    creator.addItem(std::make_shared<TestItem>("image", "image/png", "Image", content));
+    creator.addItem(std::make_shared<TestItem>("foo", "text/html", "Foo", "FooContent"));
+    creator.finishZimCreation();
+  }
+
+  zim::ItemDataDirectFdAccessInfo info;
+  {
+    const zim::Archive archive(tempPath);
+    const auto image = archive.getEntryByPath("image").getItem();
+    info = image.getDirectFdAccessInformation();
+    ASSERT_TRUE(info.isValid());
+    ASSERT_EQ(info.offset, image.getDirectAccessInformation().offset);
+    ASSERT_EQ(info.size, content.size());
+
+    ASSERT_FALSE(archive.getEntryByPath("foo").getItem().getDirectFdAccessInformation().isValid());
+  }
+
+  // The fd is still usable after the archive is destroyed.
+  std::string data(info.size, '\0');
+  ASSERT_EQ(pread(*info.fd, &data[0], info.size, info.offset), ssize_t(info.size));
+  ASSERT_EQ(data, content);
+}
+#endif // not _WIN32
+
+TEST_F(ZimArchive, getItemDataAsync)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  std::map<std::string, std::string> contents;
+  {
+    zim::writer::Creator creator;
+    creator.configClusterSize(1024);
+    creator.startZimCreation(tempPath);
+    for ( int i = 0; i < 50; ++i ) {
+      const auto path = "item" + std::to_string(i);
+      contents[path] = std::string(100 + i, char('a' + i % 26));
+      creator.addItem(std::make_shared<TestItem>(path, "text/html", path, contents[path]));
+    }
+    creator.addRedirection("redirect", "Redirect", "item7");
+    creator.finishZimCreation();
+  }
+
+  const auto threadCount = zim::getAsyncThreadCount();
+  zim::setAsyncThreadCount(3);
+  ASSERT_EQ(zim::getAsyncThreadCount(), 3U);
+  {
+    const zim::Archive archive(tempPath);
+
+    // Several requests on the same clusters at the same time.
+    std::vector<std::pair<std::string, std::future<zim::Blob>>> futures;
+    for ( int round = 0; round < 3; ++round ) {
+      for ( const auto& content : contents ) {
+        futures.emplace_back(content.first, archive.getItemDataAsync(archive.getEntryByPath(content.first)));
+        futures.emplace_back(content.first, archive.getItemDataByPathAsync(content.first));
+      }
+    }
+    for ( auto& future : futures ) {
+      ASSERT_EQ(std::string(future.second.get()), contents[future.first]);
+    }
+
+    // Redirects are followed.
+    ASSERT_EQ(std::string(archive.getItemDataAsync(archive.getEntryByPath("redirect")).get()), contents["item7"]);
+
+    auto notFound = archive.getItemDataByPathAsync("unknown");
+    ASSERT_THROW(notFound.get(), zim::EntryNotFound);
+
+    std::promise<std::string> result;
+    archive.getItemDataByPathAsync("item3", [&](const zim::Blob& data, std::exception_ptr error) {
+      ASSERT_FALSE(error);
+      result.set_value(std::string(data));
+    });
+    ASSERT_EQ(result.get_future().get(), contents["item3"]);
+
+    std::promise<bool> failed;
+    archive.getItemDataByPathAsync("unknown", [&](const zim::Blob& data, std::exception_ptr error) {
+      failed.set_value(error && data.size() == 0);
+    });
+    ASSERT_TRUE(failed.get_future().get());
+  }
+  zim::setAsyncThreadCount(threadCount);
+}
+
+TEST_F(ZimArchive, tryGetItemData)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  {
+    zim::writer::Creator creator;
+    creator.configClusterSize(1024);
+    creator.startZimCreation(tempPath);
+    const zim::writer::Hints compress{{zim::writer::COMPRESS, 1}};
+    creator.addItem(zim::writer::StringItem::create("foo", "text/html", "Foo", compress, std::string(2000, 'f')));
+    creator.addItem(zim::writer::StringItem::create("bar", "text/html", "Bar", compress, std::string(2000, 'b')));
+    const zim::writer::Hints noCompress{{zim::writer::COMPRESS, 0}};
+    creator.addItem(zim::writer::StringItem::create("raw", "text/html", "Raw", noCompress, std::string(2000, 'r')));
+    creator.addRedirection("redirect", "Redirect", "foo");
+    creator.finishZimCreation();
+  }
+
+  const auto threadCount = zim::getAsyncThreadCount();
+  {
+    const zim::Archive archive(tempPath);
+    const auto foo = archive.getEntryByPath("foo");
+    const auto bar = archive.getEntryByPath("bar");
+    ASSERT_NE(foo.getItem().getClusterIndex(), bar.getItem().getClusterIndex());
+
+    zim::Blob data;
+    ASSERT_FALSE(archive.tryGetItemData(foo, data));
+    ASSERT_FALSE(archive.tryGetItemData(foo, data));
+
+    ASSERT_FALSE(archive.tryGetItemData(foo, data, true));
+    for ( int i = 0; i < 500 && !archive.tryGetItemData(foo, data); ++i ) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(std::string(data), std::string(2000, 'f'));
+
+    // The dirent of foo and its cluster are cached.
+    data = zim::Blob();
+    ASSERT_TRUE(archive.tryGetItemData(archive.getEntryByPath("redirect"), data));
+    ASSERT_EQ(std::string(data), std::string(2000, 'f'));
+
+    ASSERT_FALSE(archive.tryGetItemData(bar, data));
+    bar.getItem().getData();
+    ASSERT_TRUE(archive.tryGetItemData(bar, data));
+    ASSERT_EQ(std::string(data), std::string(2000, 'b'));
+
+    // Uncompressed data is read from the file on access, it is never ready.
+    const auto raw = archive.getEntryByPath("raw");
+    ASSERT_EQ(std::string(raw.getItem().getData()), std::string(2000, 'r'));
+    data = zim::Blob();
+    ASSERT_FALSE(archive.tryGetItemData(raw, data));
+    ASSERT_FALSE(archive.tryGetItemData(raw, data, true));
+    ASSERT_EQ(data.size(), 0U);
+  }
+  // Wait for the background load to be completely done.
+  zim::setAsyncThreadCount(threadCount);
+}
+
+TEST_F(ZimArchive, checkIntegrityProgress)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  const unsigned entryCount = 10000;
+  {
+    zim::writer::Creator creator;
+    creator.configClusterSize(4096);
+    creator.startZimCreation(tempPath);
+    for ( unsigned i = 0; i < entryCount; ++i ) {
+      const auto path = "entry_" + std::to_string(i);
+      creator.addItem(std::make_shared<TestItem>(path, "text/html", "Entry " + std::to_string(i), path + " content"));
+    }
+    creator.finishZimCreation();
+  }
+
+  zim::Archive archive(tempPath);
+  for ( size_t i = 0; i < size_t(zim::IntegrityCheck::COUNT); ++i ) {
+    const auto checkType = zim::IntegrityCheck(i);
+    zim::size_type lastChecked = 0;
+    zim::size_type lastTotal = 0;
+    unsigned callCount = 0;
+    const auto progress = [&](zim::IntegrityCheck check, zim::size_type checked, zim::size_type total) {
+      EXPECT_EQ(check, checkType);
+      EXPECT_LE(lastChecked, checked);
+      EXPECT_LE(checked, total);
+      lastChecked = checked;
+      lastTotal = total;
+      ++callCount;
+      return true;
+    };
+    ASSERT_TRUE(archive.checkIntegrity(checkType, 4, progress)) << i;
+    ASSERT_NE(callCount, 0U) << i;
+    ASSERT_EQ(lastChecked, lastTotal) << i;
+  }
+
+  // Cancel the check as soon as possible.
+  unsigned callCount = 0;
+  const auto cancel = [&](zim::IntegrityCheck, zim::size_type, zim::size_type) {
+    ++callCount;
+    return false;
+  };
+  ASSERT_FALSE(archive.checkIntegrity(zim::IntegrityCheck::DIRENT_ORDER, 4, cancel));
+  ASSERT_EQ(callCount, 1U);
+
+  zim::IntegrityCheckList all;
+  all.set();
+  ASSERT_TRUE(zim::validate(tempPath, all, 0));
+}
+
+TEST_F(ZimArchive, clusterChecksums)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  {
+    zim::writer::Creator creator;
+    creator.configClusterSize(1024);
+    creator.startZimCreation(tempPath);
+    // Images are not compressed.
+    creator.addItem(std::make_shared<TestItem>("image1", "image/png", "Image1", std::string(2000, 'a')));
+    creator.addItem(std::make_shared<TestItem>("image2", "image/png", "Image2", std::string(2000, 'b')));
+    creator.addItem(std::make_shared<TestItem>("foo", "text/html", "Foo", "FooContent"));
+    creator.finishZimCreation();
+  }
+
+  zim::offset_type image1Offset;
+  {
+    zim::Archive archive(tempPath);
+    ASSERT_TRUE(archive.hasClusterChecksums());
+    for ( const char* path : {"image1", "image2", "foo"} ) {
+      EXPECT_TRUE(archive.verifyItemData(archive.getEntryByPath(path).getItem())) << path;
+    }
+    EXPECT_TRUE(archive.checkIntegrity(zim::IntegrityCheck::CLUSTER_CHECKSUMS, 2));
+    image1Offset = archive.getEntryByPath("image1").getItem().getDirectAccessInformation().offset;
+    ASSERT_NE(image1Offset, 0U);
+  }
+
+  // Corrupt the content of image1
+  {
+    std::fstream file(tempPath, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(image1Offset + 1000);
+    file.put('c');
+  }
+
+  zim::Archive archive(tempPath);
+  ASSERT_TRUE(archive.hasClusterChecksums());
+  EXPECT_FALSE(archive.verifyItemData(archive.getEntryByPath("image1").getItem()));
+  EXPECT_TRUE(archive.verifyItemData(archive.getEntryByPath("image2").getItem()));
+  EXPECT_TRUE(archive.verifyItemData(archive.getEntryByPath("foo").getItem()));
+
+  CapturedStderr stderror;
+  EXPECT_FALSE(archive.checkIntegrity(zim::IntegrityCheck::CLUSTER_CHECKSUMS, 2));
+  EXPECT_NE(std::string(stderror), "");
+}
+
+TEST_F(ZimArchive, splitChecksum)
+{
+  TempFile temp("zimfile");
+  auto tempPath = temp.path();
+  {
+    zim::writer::Creator creator;
+    creator.startZimCreation(tempPath);
+    // Images are not compressed.
+    creator.addItem(std::make_shared<TestItem>("image", "image/png", "Image", std::string(2000, 'a')));
+    creator.finishZimCreation();
+  }
+
+  zim::offset_type imageOffset;
+  {
+    zim::Archive archive(tempPath);
+    ASSERT_TRUE(archive.check());
+    imageOffset = archive.getEntryByPath("image").getItem().getDirectAccessInformation().offset;
+    ASSERT_GT(imageOffset, 2048U);
+  }
+
+  // The checksum covers the header, the unused bytes before the first cluster
+  // (at offset 2048) and the clusters.
+  for ( const zim::offset_type offset : {zim::offset_type(10), zim::offset_type(1500), imageOffset + 1000} ) {
+    char byte;
+    {
+      std::fstream file(tempPath, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekg(offset);
+      file.get(byte);
+      file.seekp(offset);
+      file.put(byte ^ 0x01);
+    }
+    EXPECT_FALSE(zim::Archive(tempPath).check()) << offset;
+    {
+      std::fstream file(tempPath, std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(offset);
+      file.put(byte);
+    }
+    EXPECT_TRUE(zim::Archive(tempPath).check()) << offset;
+  }
+}
+
 #if WITH_TEST_DATA
 TEST_F(ZimArchive, openRealZimArchive)
 {
@@ -858,6 +1374,37 @@ TEST_F(ZimArchive, validate)
 }
 
 
+TEST_F(ZimArchive, validateMultithreaded)
+{
+  zim::IntegrityCheckList all;
+  all.set();
+
+  for(auto& testfile: getDataFilePath("small.zim")) {
+    ASSERT_TRUE(zim::validate(testfile.path, all, 4));
+  }
+
+  zim::IntegrityCheckList checksToRun;
+  checksToRun.set();
+  checksToRun.reset(size_t(zim::IntegrityCheck::CHECKSUM));
+
+  const char* brokenZims[] = {
+    "invalid.outofbounds_first_direntptr.zim",
+    "invalid.outofbounds_last_direntptr.zim",
+    "invalid.outofbounds_first_clusterptr.zim",
+    "invalid.offset_in_cluster.zim",
+    "invalid.nonsorted_dirent_table.zim",
+    "invalid.bad_mimetype_in_dirent.zim"
+  };
+  for(const auto zimName: brokenZims) {
+    for(auto& testfile: getDataFilePath(zimName)) {
+      CapturedStderr stderror;
+      EXPECT_FALSE(zim::validate(testfile.path, checksToRun, 4)) << testfile.path;
+      EXPECT_NE(std::string(stderror), "") << testfile.path;
+    }
+  }
+  ASSERT_EQ(zim::getClusterCacheCurrentSize(), 0);
+}
+
 void checkEquivalence(const zim::Archive& archive1, const zim::Archive& archive2)
 {
   EXPECT_EQ(archive1.getFilesize(), archive2.getFilesize());
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include "buffer_arena.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace
+{
+
+using namespace zim;
+
+TEST(BufferArena, roundSize)
+{
+  ASSERT_EQ(BufferArena::roundSize(1), 1U);
+  ASSERT_EQ(BufferArena::roundSize(4096), 4096U);
+  ASSERT_EQ(BufferArena::roundSize(4097), 5120U);
+  ASSERT_EQ(BufferArena::roundSize(8192), 8192U);
+  ASSERT_EQ(BufferArena::roundSize(8193), 10240U);
+  ASSERT_EQ(BufferArena::roundSize(1000000), 1048576U);
+  ASSERT_EQ(BufferArena::roundSize(1048577), 1310720U);
+  for (size_t size = 1; size < 10000000; size = size*3+1) {
+    const auto rounded = BufferArena::roundSize(size);
+    ASSERT_GE(rounded, size);
+    ASSERT_LE(rounded, size + size/4 + 1);
+  }
+}
+
+TEST(BufferArena, reuseFreedBuffers)
+{
+  BufferArena arena(1024*1024);
+
+  char* data = arena.allocate(10000);
+  memset(data, 'a', 10000);
+  auto stats = arena.getStats();
+  ASSERT_EQ(stats.allocationCount, 1U);
+  ASSERT_EQ(stats.reuseCount, 0U);
+  ASSERT_EQ(stats.usedSize, BufferArena::roundSize(10000));
+  ASSERT_EQ(stats.cachedSize, 0U);
+
+  arena.deallocate(data, 10000);
+  stats = arena.getStats();
+  ASSERT_EQ(stats.usedSize, 0U);
+  ASSERT_EQ(stats.cachedSize, BufferArena::roundSize(10000));
+
+  // Same size class
+  char* data2 = arena.allocate(9500);
+  ASSERT_EQ(data2, data);
+  stats = arena.getStats();
+  ASSERT_EQ(stats.allocationCount, 2U);
+  ASSERT_EQ(stats.reuseCount, 1U);
+  ASSERT_EQ(stats.cachedSize, 0U);
+
+  // Another size class
+  char* data3 = arena.allocate(100000);
+  ASSERT_EQ(arena.getStats().reuseCount, 1U);
+
+  // Small buffers are not recycled
+  char* data4 = arena.allocate(100);
+  arena.deallocate(data4, 100);
+  ASSERT_EQ(arena.getStats().cachedSize, 0U);
+
+  arena.deallocate(data2, 9500);
+  arena.deallocate(data3, 100000);
+  stats = arena.getStats();
+  ASSERT_EQ(stats.usedSize, 0U);
+  ASSERT_EQ(stats.cachedSize, BufferArena::roundSize(10000) + BufferArena::roundSize(100000));
+
+  arena.setMaxCachedSize(20000);
+  ASSERT_EQ(arena.getStats().cachedSize, BufferArena::roundSize(10000));
+
+  arena.setMaxCachedSize(0);
+  ASSERT_EQ(arena.getStats().cachedSize, 0U);
+  data = arena.allocate(10000);
+  arena.deallocate(data, 10000);
+  ASSERT_EQ(arena.getStats().cachedSize, 0U);
+}
+
+TEST(BufferArena, bigBuffers)
+{
+  BufferArena arena(16*1024*1024);
+  arena.setUseHugePages(true);
+  const size_t size = 4*1024*1024 + 10;
+  char* data = arena.allocate(size);
+  memset(data, 'a', size);
+  arena.deallocate(data, size);
+  ASSERT_EQ(arena.allocate(size), data);
+  arena.deallocate(data, size);
+}
+
+class CountingAllocator : public ClusterBufferAllocator
+{
+  public:
+    char* allocate(size_t size) override {
+      allocated += size;
+      return new char[size];
+    }
+    void deallocate(char* data, size_t size) override {
+      deallocated += size;
+      delete[] data;
+    }
+
+    std::atomic<size_t> allocated{0};
+    std::atomic<size_t> deallocated{0};
+};
+
+TEST(BufferArena, customAllocator)
+{
+  auto allocator = std::make_shared<CountingAllocator>();
+  setClusterDataAllocator(allocator);
+  {
+    const auto buffer = makeClusterDataBuffer(zsize_t(1000));
+    ASSERT_EQ(buffer.size(), zsize_t(1000));
+    ASSERT_EQ(allocator->allocated, 1000U);
+    ASSERT_EQ(allocator->deallocated, 0U);
+
+    // The allocator is changed, but the buffer is still deallocated by the
+    // allocator which allocated it.
+    setClusterDataAllocator(nullptr);
+  }
+  ASSERT_EQ(allocator->deallocated, 1000U);
+
+  const auto statsBefore = getDefaultBufferArena().getStats();
+  {
+    const auto buffer = makeClusterDataBuffer(zsize_t(10000));
+    ASSERT_EQ(getDefaultBufferArena().getStats().allocationCount, statsBefore.allocationCount+1);
+  }
+  ASSERT_EQ(getDefaultBufferArena().getStats().usedSize, statsBefore.usedSize);
+  ASSERT_EQ(allocator->allocated, 1000U);
+}
+
+} // unnamed namespace
@@ -55,6 +55,25 @@ TEST(ConcurrentCacheTest, handleException) {
     EXPECT_EQ(cache.getOrPut(8, LazyValue(888)), 888);
 }
 
+TEST(ConcurrentCacheTest, getIfReady) {
+    zim::ConcurrentCache<int, int, zim::UnitCostEstimation> cache(2);
+    int value = 0;
+    EXPECT_FALSE(cache.getIfReady(3, value));
+    EXPECT_EQ(cache.getOrPut(3, LazyValue(2025)), 2025);
+    EXPECT_TRUE(cache.getIfReady(3, value));
+    EXPECT_EQ(value, 2025);
+
+    // An item being obtained is not ready.
+    zim::NamedThread thread("a", [&cache]() {
+      cache.getOrPut(4, LazyValue(2026, std::chrono::milliseconds(200)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(cache.getIfReady(4, value));
+    thread.join();
+    EXPECT_TRUE(cache.getIfReady(4, value));
+    EXPECT_EQ(value, 2026);
+}
+
 TEST(ConcurrentCacheTest, addAnItemToAnEmptyCache) {
     zim::ConcurrentCache<int, int, zim::UnitCostEstimation> cache(1);
 
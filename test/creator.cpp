@@ -152,7 +152,8 @@ TEST(ZimCreator, createEmptyZim)
   Fileheader header;
   header.read(*reader);
   ASSERT_FALSE(header.hasMainPage());
-  ASSERT_EQ(header.getArticleCount(), 2u); // counter + titleListIndexesv0
+  ASSERT_TRUE(header.useSplitChecksum());
+  ASSERT_EQ(header.getArticleCount(), 5u); // counter + clusterChecksums + clusterListIndexes + foldedTitleListIndexes + titleListIndexesv0
 
   //Read the only one item existing.
   auto pathPtrReader = reader->sub_reader(offset_t(header.getPathPtrPos()), zsize_t(sizeof(offset_t)*header.getArticleCount()));
@@ -163,6 +164,18 @@ TEST(ZimCreator, createEmptyZim)
   test_article_dirent(dirent, 'M', "Counter", None, 1, cluster_index_t(0), None);
 
   dirent = direntAccessor.getDirent(entry_index_t(1));
+  // The checksums listing is alone in the last cluster.
+  test_article_dirent(dirent, 'X', "listing/clusterChecksums/v1", None, 0, cluster_index_t(2), blob_index_t(0));
+
+  dirent = direntAccessor.getDirent(entry_index_t(2));
+  test_article_dirent(dirent, 'X', "listing/clusterOrdered/v1", None, 0, cluster_index_t(1), None);
+  auto clusterListingBlobIndex = dirent->getBlobNumber();
+
+  dirent = direntAccessor.getDirent(entry_index_t(3));
+  test_article_dirent(dirent, 'X', "listing/foldedTitleOrdered/v1", None, 0, cluster_index_t(1), None);
+  auto foldedListingBlobIndex = dirent->getBlobNumber();
+
+  dirent = direntAccessor.getDirent(entry_index_t(4));
   test_article_dirent(dirent, 'X', "listing/titleOrdered/v1", None, 0, cluster_index_t(1), None);
   auto v0BlobIndex = dirent->getBlobNumber();
 
@@ -170,9 +183,21 @@ TEST(ZimCreator, createEmptyZim)
   auto clusterOffset = offset_t(reader->read_uint<offset_type>(offset_t(clusterPtrPos+8)));
   auto cluster = Cluster::read(*reader, clusterOffset);
   ASSERT_EQ(cluster->getCompression(), Cluster::Compression::None);
-  ASSERT_EQ(cluster->count(), blob_index_t(1)); // Only titleListIndexesv0
+  ASSERT_EQ(cluster->count(), blob_index_t(3)); // Only titleListIndexesv0, foldedTitleListIndexes and clusterListIndexes
   auto blob = cluster->getBlob(v0BlobIndex);
   ASSERT_EQ(blob.size(), 0);
+  blob = cluster->getBlob(foldedListingBlobIndex);
+  ASSERT_EQ(blob.size(), 0);
+  blob = cluster->getBlob(clusterListingBlobIndex);
+  ASSERT_EQ(blob.size(), 0);
+
+  ASSERT_EQ(header.getClusterCount(), 3u);
+  clusterOffset = offset_t(reader->read_uint<offset_type>(offset_t(clusterPtrPos+16)));
+  cluster = Cluster::read(*reader, clusterOffset);
+  ASSERT_EQ(cluster->getCompression(), Cluster::Compression::None);
+  ASSERT_EQ(cluster->count(), blob_index_t(1));
+  blob = cluster->getBlob(blob_index_t(0));
+  ASSERT_EQ(blob.size(), 2*16); // The MD5 of the two previous clusters
 }
 
 
@@ -236,7 +261,7 @@ TEST(ZimCreator, createZim)
   header.read(*reader);
   ASSERT_TRUE(header.hasMainPage());
 #if defined(ENABLE_XAPIAN)
-  entry_index_type nb_entry = 13; // counter + 2*illustration + xapiantitleIndex + xapianfulltextIndex + foo + foo2 + foo_bis + foo3 + foo_ter + Title + mainPage + titleListIndexes
+  entry_index_type nb_entry = 16; // counter + 2*illustration + xapiantitleIndex + xapianfulltextIndex + foo + foo2 + foo_bis + foo3 + foo_ter + Title + mainPage + titleListIndexes + foldedTitleListIndexes + clusterListIndexes + clusterChecksums
   int xapian_mimetype = 0;
   int listing_mimetype = 1;
   int png_mimetype = 2;
@@ -244,7 +269,7 @@ TEST(ZimCreator, createZim)
   int plain_mimetype = 4;
   int plainutf8_mimetype = 5;
 #else
-  entry_index_type nb_entry = 11; // counter + 2*illustration + foo + foo_bis + foo2 + foo3 + foo_ter + Title + mainPage + titleListIndexes
+  entry_index_type nb_entry = 14; // counter + 2*illustration + foo + foo_bis + foo2 + foo3 + foo_ter + Title + mainPage + titleListIndexes + foldedTitleListIndexes + clusterListIndexes + clusterChecksums
   int listing_mimetype = 0;
   int png_mimetype = 1;
   int html_mimetype = 2;
@@ -301,6 +326,17 @@ TEST(ZimCreator, createZim)
   test_article_dirent(dirent, 'X', "fulltext/xapian", "fulltext/xapian", xapian_mimetype, cluster_index_t(1), None);
 #endif
 
+  dirent = direntAccessor.getDirent(entry_index_t(direntIdx++));
+  test_article_dirent(dirent, 'X', "listing/clusterChecksums/v1", None, listing_mimetype, cluster_index_t(2), blob_index_t(0));
+
+  dirent = direntAccessor.getDirent(entry_index_t(direntIdx++));
+  test_article_dirent(dirent, 'X', "listing/clusterOrdered/v1", None, listing_mimetype, cluster_index_t(1), None);
+  auto clusterListingBlobIndex = dirent->getBlobNumber();
+
+  dirent = direntAccessor.getDirent(entry_index_t(direntIdx++));
+  test_article_dirent(dirent, 'X', "listing/foldedTitleOrdered/v1", None, listing_mimetype, cluster_index_t(1), None);
+  auto foldedListingBlobIndex = dirent->getBlobNumber();
+
   dirent = direntAccessor.getDirent(entry_index_t(direntIdx++));
   test_article_dirent(dirent, 'X', "listing/titleOrdered/v1", None, listing_mimetype, cluster_index_t(1), None);
   auto v1BlobIndex = dirent->getBlobNumber();
@@ -335,7 +371,7 @@ TEST(ZimCreator, createZim)
   clusterOffset = offset_t(reader->read_uint<offset_type>(offset_t(clusterPtrPos + 8)));
   cluster = Cluster::read(*reader, clusterOffset);
   ASSERT_EQ(cluster->getCompression(), Cluster::Compression::None);
-  ASSERT_EQ(cluster->count(), blob_index_t(nb_entry-8)); // 7 entries are either compressed or redirections + 1 entry is a clone of content
+  ASSERT_EQ(cluster->count(), blob_index_t(nb_entry-9)); // 7 entries are either compressed or redirections + 1 entry is a clone of content + 1 entry in last cluster
 
   ASSERT_EQ(header.getTitleIdxPos(), 0xffffffffffffffffUL);
 
@@ -349,11 +385,42 @@ TEST(ZimCreator, createZim)
   };
   ASSERT_EQ(blob1Data, expectedBlob1Data);
 
+  blob = cluster->getBlob(foldedListingBlobIndex);
+  ASSERT_EQ(blob.size(), 3*sizeof(title_index_t));
+  std::vector<char> foldedListingData(blob.data(), blob.end());
+  std::vector<char> expectedFoldedListingData = {
+    1, 0, 0, 0, // "afoo"
+    0, 0, 0, 0, // "foo"
+    4, 0, 0, 0  // "the same redirection"
+  };
+  ASSERT_EQ(foldedListingData, expectedFoldedListingData);
+
+  blob = cluster->getBlob(clusterListingBlobIndex);
+  ASSERT_EQ(blob.size(), 5*sizeof(entry_index_t));
+  std::vector<char> clusterListingData(blob.data(), blob.end());
+  std::vector<char> expectedClusterListingData = {
+    2, 0, 0, 0, // Redirections first
+    4, 0, 0, 0,
+    0, 0, 0, 0, // Then items by cluster and blob
+    1, 0, 0, 0,
+    3, 0, 0, 0  // foo_bis shares the blob of foo2
+  };
+  ASSERT_EQ(clusterListingData, expectedClusterListingData);
+
   blob = cluster->getBlob(illustration48BlobIndex);
   ASSERT_EQ(std::string(blob), "PNGBinaryContent48");
 
   blob = cluster->getBlob(illustration96BlobIndex);
   ASSERT_EQ(std::string(blob), "PNGBinaryContent96");
+
+  // Test cluster checksums
+  ASSERT_EQ(header.getClusterCount(), 3u);
+  clusterOffset = offset_t(reader->read_uint<offset_type>(offset_t(clusterPtrPos + 16)));
+  cluster = Cluster::read(*reader, clusterOffset);
+  ASSERT_EQ(cluster->getCompression(), Cluster::Compression::None);
+  ASSERT_EQ(cluster->count(), blob_index_t(1));
+  blob = cluster->getBlob(blob_index_t(0));
+  ASSERT_EQ(blob.size(), 2*16);
 }
 
 
@@ -98,4 +98,21 @@ TYPED_TEST(DecoderStreamReaderTest, compressedDataFollowedByGarbage) {
   }
 }
 
+TYPED_TEST(DecoderStreamReaderTest, skip) {
+  typedef typename TestFixture::CompressionInfo CompressionInfo;
+
+  const int N = 10000;
+  const std::string s("DecoderStreamReader should work correctly");
+  const std::string compDataStr = compress<CompressionInfo>(s*N);
+  auto compData = zim::Buffer::makeBuffer(compDataStr.data(), zim::zsize_t(compDataStr.size()));
+
+  auto compReader = std::make_shared<zim::BufferReader>(compData);
+  zim::DecoderStreamReader<CompressionInfo> dds(compReader);
+  // Skip more than the internal chunk size.
+  dds.skip(zim::zsize_t(s.size()*(N-2) + 4));
+  std::string out(s.size(), '\0');
+  dds.read(&out[0], zim::zsize_t(s.size()));
+  ASSERT_EQ(out, s.substr(4) + s.substr(0, 4));
+}
+
 } // unnamed namespace
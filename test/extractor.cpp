@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include <zim/extractor.h>
+#include <zim/item.h>
+#include <zim/entry.h>
+
+#include "tools.h"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+
+typedef std::map<std::string, std::string> Contents;
+
+const std::string longPath = "dir/" + std::string(120, 'l') + "/item";
+
+Contents createArchive(const std::string& path)
+{
+  Contents contents;
+  zim::writer::Creator creator;
+  creator.configClusterSize(2048);
+  creator.startZimCreation(path);
+  for (int i = 0; i < 40; i++) {
+    const auto itemPath = (i % 2 ? "dir/sub/item" : "item") + std::to_string(i);
+    std::string content;
+    for (int j = 0; j < 30; j++) {
+      content += itemPath + " content " + std::to_string(j) + "\n";
+    }
+    contents[itemPath] = content;
+    creator.addItem(std::make_shared<zim::unittests::TestItem>(itemPath, "text/html", itemPath, content));
+  }
+  contents[longPath] = "long";
+  creator.addItem(std::make_shared<zim::unittests::TestItem>(longPath, "text/plain", "Long", "long"));
+  creator.addRedirection("dir/redirect", "Redirect", "item0");
+  creator.finishZimCreation();
+  return contents;
+}
+
+// Parse a tar stream, return the content of the files and the target of
+// the symlinks.
+void parseTar(const std::string& tar, Contents& files, Contents& links)
+{
+  size_t pos = 0;
+  std::string longName, longLink;
+  while (true) {
+    ASSERT_LE(pos + 512, tar.size());
+    const char* header = tar.data() + pos;
+    pos += 512;
+    if (header[0] == '\0') {
+      return;
+    }
+    const auto size = std::stoull(std::string(header + 124, 11), nullptr, 8);
+    const std::string data = tar.substr(pos, size);
+    pos += (size + 511) / 512 * 512;
+
+    const auto type = header[156];
+    if (type == 'L') {
+      longName = data.c_str();
+      continue;
+    }
+    if (type == 'K') {
+      longLink = data.c_str();
+      continue;
+    }
+    auto name = longName.empty() ? std::string(header, strnlen(header, 100)) : longName;
+    auto link = longLink.empty() ? std::string(header + 157, strnlen(header + 157, 100)) : longLink;
+    longName.clear();
+    longLink.clear();
+
+    unsigned checksum = 0;
+    for (int i = 0; i < 512; i++) {
+      checksum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header[i]);
+    }
+    ASSERT_EQ(checksum, std::stoul(std::string(header + 148, 6), nullptr, 8)) << name;
+
+    if (type == '0') {
+      files[name] = data;
+    } else if (type == '2') {
+      links[name] = link;
+    } else {
+      FAIL() << "Unexpected type " << type;
+    }
+  }
+}
+
+TEST(Extractor, callbackSink)
+{
+  zim::unittests::TempFile temp("zimfile");
+  const auto expected = createArchive(temp.path());
+  const zim::Archive archive(temp.path());
+  const auto cacheSize = zim::getClusterCacheCurrentSize();
+
+  for (unsigned workerCount : {1, 3, 8}) {
+    Contents contents;
+    zim::CallbackExtractSink sink([&](const zim::Item& item, const zim::Blob& data) {
+      ASSERT_EQ(contents.count(item.getPath()), 0U);
+      contents[item.getPath()] = std::string(data);
+    });
+    // A small limit forces the workers to wait for the sink.
+    zim::Extractor(archive)
+      .setWorkerCount(workerCount)
+      .setMaxPendingSize(1000)
+      .extract(sink);
+    ASSERT_EQ(contents, expected) << workerCount;
+  }
+
+  // Clusters are not stored in the cluster cache.
+  ASSERT_EQ(zim::getClusterCacheCurrentSize(), cacheSize);
+}
+
+TEST(Extractor, sinkError)
+{
+  zim::unittests::TempFile temp("zimfile");
+  createArchive(temp.path());
+  const zim::Archive archive(temp.path());
+
+  size_t count = 0;
+  zim::CallbackExtractSink sink([&](const zim::Item&, const zim::Blob&) {
+    if (++count == 5) {
+      throw std::runtime_error("sink error");
+    }
+  });
+  ASSERT_THROW(zim::Extractor(archive).setWorkerCount(4).setMaxPendingSize(0).extract(sink), std::runtime_error);
+  ASSERT_EQ(count, 5U);
+}
+
+TEST(Extractor, tarSink)
+{
+  zim::unittests::TempFile temp("zimfile");
+  const auto expected = createArchive(temp.path());
+  const zim::Archive archive(temp.path());
+
+  std::ostringstream out;
+  zim::TarExtractSink sink(out);
+  zim::Extractor(archive).setWorkerCount(4).extract(sink);
+
+  const auto tar = out.str();
+  ASSERT_EQ(tar.size() % 512, 0U);
+  Contents files, links;
+  parseTar(tar, files, links);
+  ASSERT_EQ(files, expected);
+  ASSERT_EQ(links, (Contents{{"dir/redirect", "../item0"}}));
+}
+
+#ifndef _WIN32
+TEST(Extractor, directorySink)
+{
+  zim::unittests::TempFile temp("zimfile");
+  const auto expected = createArchive(temp.path());
+  const zim::Archive archive(temp.path());
+
+  const auto directory = temp.path() + ".d";
+  zim::DirectoryExtractSink sink(directory);
+  zim::Extractor(archive).setWorkerCount(2).extract(sink);
+
+  for (const auto& item : expected) {
+    const auto path = directory + "/" + item.first;
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    ASSERT_EQ(content.str(), item.second) << path;
+    ASSERT_EQ(unlink(path.c_str()), 0);
+  }
+  for (const auto& dir : {"/dir/" + std::string(120, 'l'), std::string("/dir/sub"), std::string("/dir"), std::string()}) {
+    ASSERT_EQ(rmdir((directory + dir).c_str()), 0) << dir;
+  }
+}
+#endif
+
+} // unnamed namespace
@@ -17,14 +17,18 @@
  *
  */
 
+#define ZIM_PRIVATE
 #include <zim/zim.h>
 #include <zim/archive.h>
 #include <zim/error.h>
 #include <zim/item.h>
 
 #include "tools.h"
+#include "../src/fileimpl.h"
 #include "gtest/gtest.h"
 
+#include <map>
+
 namespace
 {
 
@@ -167,4 +171,126 @@ TEST(IteartorTests, iteratorFunctions)
 
 #endif
 
+TEST(IteratorTests, partitionByCluster)
+{
+    zim::unittests::TempFile temp("zimfile");
+    {
+        zim::writer::Creator creator;
+        creator.configClusterSize(2048);
+        creator.startZimCreation(temp.path());
+        for (int i = 0; i < 60; i++) {
+            const auto path = "item" + std::to_string(i);
+            std::string content;
+            for (int j = 0; j < 50; j++) {
+                content += path + " content " + std::to_string(j) + "\n";
+            }
+            creator.addItem(std::make_shared<zim::unittests::TestItem>(path, "text/html", path, content));
+        }
+        creator.addRedirection("redirect", "Redirect", "item0");
+        creator.finishZimCreation();
+    }
+    const zim::Archive archive(temp.path());
+
+    ASSERT_TRUE(archive.partitionByCluster(0).empty());
+
+    const auto allEntries = archive.iterEfficient();
+    for (size_t partCount : {1, 3, 4, 1000}) {
+        const auto ranges = archive.partitionByCluster(partCount);
+        ASSERT_EQ(ranges.size(), partCount);
+
+        std::vector<zim::entry_index_type> entries;
+        std::map<zim::cluster_index_type, size_t> clusterRange;
+        for (size_t r = 0; r < ranges.size(); r++) {
+            for (auto& entry: ranges[r]) {
+                entries.push_back(entry.getIndex());
+                if (entry.isRedirect()) {
+                    continue;
+                }
+                const auto cluster = entry.getItem().getClusterIndex();
+                // A cluster must be in only one range.
+                const auto it = clusterRange.find(cluster);
+                if (it != clusterRange.end()) {
+                    ASSERT_EQ(it->second, r) << "cluster " << cluster;
+                }
+                clusterRange[cluster] = r;
+            }
+        }
+
+        std::vector<zim::entry_index_type> expected;
+        for (auto& entry: allEntries) {
+            expected.push_back(entry.getIndex());
+        }
+        ASSERT_EQ(entries, expected);
+
+        if (partCount == 4) {
+            ASSERT_GT(clusterRange.size(), 8U);
+            // Ranges are balanced.
+            for (auto& range: ranges) {
+                ASSERT_GT(range.size(), 0);
+                ASSERT_LT(range.size(), int(archive.getEntryCount()/2));
+            }
+        }
+    }
+
+    // The last cluster (the checksums of the others) ends before the dirents:
+    // an uncompressed cluster header, two blob offsets and the checksums.
+    const auto clusterSizes = archive.getImpl()->getClusterSizes();
+    ASSERT_EQ(clusterSizes.size(), archive.getClusterCount());
+    ASSERT_EQ(clusterSizes.back().v, 1 + 2*4 + 16*(clusterSizes.size()-1));
+}
+
+TEST(IteratorTests, clusterOrderListing)
+{
+    zim::unittests::TempFile temp("zimfile");
+    {
+        zim::writer::Creator creator;
+        creator.configClusterSize(1024);
+        creator.startZimCreation(temp.path());
+        for (int i = 0; i < 30; i++) {
+            // Paths are not in the same order than the items in the clusters.
+            const auto path = "item" + std::to_string((i * 7) % 30);
+            const std::string content(200, char('a' + i % 26));
+            creator.addItem(std::make_shared<zim::unittests::TestItem>(path, "text/html", path, content));
+            creator.addRedirection("redirect" + std::to_string(i), "Redirect", path);
+        }
+        creator.finishZimCreation();
+    }
+    const zim::Archive archive(temp.path());
+
+    // The writer stores the cluster order: redirects first,
+    // then items by cluster and blob.
+    std::vector<zim::entry_index_type> entries;
+    std::pair<zim::cluster_index_type, zim::blob_index_type> previous(0, 0);
+    bool firstItem = true;
+    for (auto& entry: archive.iterEfficient()) {
+        entries.push_back(entry.getIndex());
+        if (entry.isRedirect()) {
+            ASSERT_TRUE(firstItem) << entry.getPath();
+            continue;
+        }
+        const auto item = entry.getItem();
+        const std::pair<zim::cluster_index_type, zim::blob_index_type> current(item.getClusterIndex(), item.getBlobIndex());
+        if (!firstItem) {
+            ASSERT_LT(previous, current) << entry.getPath();
+        }
+        previous = current;
+        firstItem = false;
+    }
+    ASSERT_EQ(entries.size(), archive.getEntryCount());
+    std::sort(entries.begin(), entries.end());
+    ASSERT_EQ(std::adjacent_find(entries.begin(), entries.end()), entries.end());
+
+    // Archives without the listing sort the entries on first use.
+    // Entries are grouped by cluster the same way (redirects with cluster 0).
+    const auto sorted = archive.getImpl()->sortEntriesByCluster();
+    ASSERT_EQ(sorted.size(), archive.getEntryCount());
+    auto clusterKey = [&](zim::entry_index_type idx) -> zim::cluster_index_type {
+        const auto entry = archive.getEntryByPath(idx);
+        return entry.isRedirect() ? 0 : entry.getItem().getClusterIndex();
+    };
+    for (zim::entry_index_type i = 0; i < sorted.size(); i++) {
+        ASSERT_EQ(clusterKey(sorted[i]), clusterKey(archive.getEntryByClusterOrder(i).getIndex())) << i;
+    }
+}
+
 } // namespace
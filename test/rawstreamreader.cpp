@@ -51,4 +51,20 @@ TEST(ReaderDataStreamWrapper, shouldJustWork)
   ASSERT_EQ(-987654321,  rdr.read<int64_t>());
 }
 
+TEST(ReaderDataStreamWrapper, skip)
+{
+  char data[] = "abcdefghijklmnopqrstuvwxyz";
+  auto  reader = std::make_shared<BufferReader>(Buffer::makeBuffer(data, zsize_t(sizeof(data))));
+
+  RawStreamReader rdr(reader);
+  rdr.skip(zsize_t(4));
+  char out[4];
+  rdr.read(out, zsize_t(4));
+  ASSERT_EQ("efgh", std::string(out, 4));
+  rdr.skip(zsize_t(0));
+  rdr.skip(zsize_t(10));
+  rdr.read(out, zsize_t(4));
+  ASSERT_EQ("stuv", std::string(out, 4));
+}
+
 } // unnamed namespace
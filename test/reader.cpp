@@ -38,7 +38,8 @@ using zim::unittests::makeTempFile;
 std::unique_ptr<Reader> createFileReader(const char* data, zsize_t size) {
   const auto tmpfile = makeTempFile("data", data);
   auto fd = DEFAULTFS::openFile(tmpfile->path());
-  return std::unique_ptr<Reader>(new FileReader(std::make_shared<typename DEFAULTFS::FD>(std::move(fd)), offset_t(0), size));
+  auto fhandle = std::make_shared<PooledFD>(std::make_shared<const DEFAULTFS::FD>(std::move(fd)));
+  return std::unique_ptr<Reader>(new FileReader(fhandle, offset_t(0), size));
 }
 
 std::unique_ptr<Reader> createMultiFileReader(const char* data, zsize_t size) {
@@ -162,4 +163,52 @@ TEST(FileReader, zeroReader)
   }
 }
 
+TEST(FileReader, getBuffers)
+{
+  char data[] = "abcdefghijklmnopqrstuvwxyz";
+  for(auto& createReader:createReaders) {
+    auto reader = createReader(data, zsize_t(26));
+    ASSERT_TRUE(reader->get_buffers(offset_t(5), zsize_t(0)).empty());
+
+    const auto buffers = reader->get_buffers(offset_t(5), zsize_t(10));
+    ASSERT_EQ(buffers.size(), 1U);
+    ASSERT_EQ(buffers[0].size(), zsize_t(10));
+    ASSERT_EQ(0, memcmp(buffers[0].data(), "fghijklmno", 10));
+  }
+}
+
+#ifndef _WIN32
+TEST(MultiPartFileReader, getBuffersSplitOnParts)
+{
+  const auto tmpfile = makeTempFile("data", "abcdefghijklmnopqrstuvwxyz");
+  const auto fd = tmpfile->fd();
+  const std::vector<FdInput> parts{
+    FdInput(fd, 0, 10),
+    FdInput(fd, 10, 10),
+    FdInput(fd, 20, 6)
+  };
+  auto fileCompound = std::make_shared<FileCompound>(parts);
+  const MultiPartFileReader reader(fileCompound);
+
+  // In one part
+  auto buffers = reader.get_buffers(offset_t(2), zsize_t(5));
+  ASSERT_EQ(buffers.size(), 1U);
+  ASSERT_EQ(std::string(buffers[0].data(), buffers[0].size().v), "cdefg");
+
+  // Across all the parts
+  buffers = reader.get_buffers(offset_t(5), zsize_t(20));
+  ASSERT_EQ(buffers.size(), 3U);
+  ASSERT_EQ(std::string(buffers[0].data(), buffers[0].size().v), "fghij");
+  ASSERT_EQ(std::string(buffers[1].data(), buffers[1].size().v), "klmnopqrst");
+  ASSERT_EQ(std::string(buffers[2].data(), buffers[2].size().v), "uvwxy");
+
+  // Starting exactly at a part boundary
+  auto subReader = reader.sub_reader(offset_t(10), zsize_t(16));
+  buffers = subReader->get_buffers(offset_t(0), zsize_t(16));
+  ASSERT_EQ(buffers.size(), 2U);
+  ASSERT_EQ(std::string(buffers[0].data(), buffers[0].size().v), "klmnopqrst");
+  ASSERT_EQ(std::string(buffers[1].data(), buffers[1].size().v), "uvwxyz");
+}
+#endif
+
 } // unnamed namespace
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#define ZIM_PRIVATE
+#include <zim/scrubber.h>
+#include <zim/item.h>
+#include <zim/entry.h>
+
+#include "tools.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+using zim::unittests::TempFile;
+using zim::unittests::TestItem;
+
+void createArchive(const std::string& path)
+{
+  zim::writer::Creator creator;
+  creator.configClusterSize(1024);
+  creator.startZimCreation(path);
+  for (int i = 0; i < 20; i++) {
+    const auto itemPath = "item" + std::to_string(i);
+    creator.addItem(std::make_shared<TestItem>(itemPath, "text/html", itemPath, std::string(300, 'a' + i)));
+  }
+  // Images are not compressed.
+  creator.addItem(std::make_shared<TestItem>("image", "image/png", "Image", std::string(2000, 'i')));
+  creator.addRedirection("redirect", "Redirect", "item0");
+  creator.finishZimCreation();
+}
+
+struct ScrubResult
+{
+  std::vector<std::string> errors;
+  zim::size_type lastChecked = 0;
+  zim::size_type lastTotal = 0;
+};
+
+void scrub(zim::Scrubber& scrubber, ScrubResult& result)
+{
+  std::mutex mutex;
+  scrubber.setBytesPerSecond(0)
+          .setProgressCallback([&](zim::size_type checked, zim::size_type total) {
+            std::lock_guard<std::mutex> lock(mutex);
+            EXPECT_LE(result.lastChecked, checked);
+            result.lastChecked = checked;
+            result.lastTotal = total;
+          })
+          .setErrorCallback([&](const std::string& error) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.errors.push_back(error);
+          });
+  scrubber.start();
+  scrubber.wait();
+  ASSERT_FALSE(scrubber.isRunning());
+}
+
+TEST(Scrubber, validArchive)
+{
+  TempFile temp("zimfile");
+  createArchive(temp.path());
+
+  const zim::Archive archive(temp.path());
+  zim::Scrubber scrubber(archive);
+  ScrubResult result;
+  scrub(scrubber, result);
+  EXPECT_TRUE(result.errors.empty());
+  EXPECT_EQ(scrubber.getErrorCount(), 0U);
+  EXPECT_EQ(result.lastTotal, archive.getAllEntryCount() + archive.getClusterCount());
+  EXPECT_EQ(result.lastChecked, result.lastTotal);
+
+  // The scrubber can be restarted.
+  ScrubResult result2;
+  scrub(scrubber, result2);
+  EXPECT_TRUE(result2.errors.empty());
+  EXPECT_EQ(result2.lastChecked, result.lastTotal);
+}
+
+TEST(Scrubber, dropPageCache)
+{
+  TempFile temp("zimfile");
+  createArchive(temp.path());
+
+  const zim::Archive archive(temp.path());
+  // Keep a cluster in use while scrubbing.
+  const auto data = archive.getEntryByPath("item0").getItem().getData();
+  zim::Scrubber scrubber(archive);
+  scrubber.setDropPageCache(true);
+  ScrubResult result;
+  scrub(scrubber, result);
+  EXPECT_TRUE(result.errors.empty());
+  EXPECT_EQ(result.lastChecked, result.lastTotal);
+  EXPECT_EQ(std::string(archive.getEntryByPath("item0").getItem().getData()), std::string(data));
+}
+
+TEST(Scrubber, corruptedCluster)
+{
+  TempFile temp("zimfile");
+  createArchive(temp.path());
+
+  zim::offset_type imageOffset;
+  {
+    const zim::Archive archive(temp.path());
+    imageOffset = archive.getEntryByPath("image").getItem().getDirectAccessInformation().offset;
+    ASSERT_NE(imageOffset, 0U);
+  }
+  {
+    std::fstream file(temp.path(), std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(imageOffset + 10);
+    file.put('x');
+  }
+
+  const zim::Archive archive(temp.path());
+  zim::Scrubber scrubber(archive);
+  ScrubResult result;
+  scrub(scrubber, result);
+  ASSERT_EQ(result.errors.size(), 1U);
+  EXPECT_EQ(result.errors[0].find("Cluster #"), 0U) << result.errors[0];
+  EXPECT_EQ(scrubber.getErrorCount(), 1U);
+  // Errors do not stop the scrubbing.
+  EXPECT_EQ(result.lastChecked, result.lastTotal);
+}
+
+TEST(Scrubber, stop)
+{
+  TempFile temp("zimfile");
+  createArchive(temp.path());
+
+  const zim::Archive archive(temp.path());
+  zim::Scrubber scrubber(archive);
+  zim::size_type lastChecked = 0;
+  // Throttle the scrubber so much it would take hours to finish.
+  scrubber.setBytesPerSecond(1)
+          .setProgressCallback([&](zim::size_type checked, zim::size_type /*total*/) {
+            lastChecked = checked;
+          });
+  scrubber.start();
+  ASSERT_TRUE(scrubber.isRunning());
+  ASSERT_THROW(scrubber.start(), std::logic_error);
+
+  const auto start = std::chrono::steady_clock::now();
+  scrubber.stop();
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ASSERT_FALSE(scrubber.isRunning());
+  ASSERT_LT(lastChecked, archive.getAllEntryCount() + archive.getClusterCount());
+}
+
+} // unnamed namespace
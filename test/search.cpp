@@ -25,6 +25,14 @@
 
 #include <xapian.h>
 
+#include <set>
+#include <thread>
+
+#ifndef _WIN32
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
 #include "tools.h"
 #include "gtest/gtest.h"
 
@@ -112,6 +120,83 @@ TEST(Search, fulltextSnippet)
   );
 }
 
+TEST(Search, snippetOfBigItem)
+{
+  TempZimArchive tza("testZim");
+  zim::writer::Creator creator;
+  creator.configIndexing(true, "en");
+  creator.startZimCreation(tza.getPath());
+  std::string content = "<p>a random paragraph at the start</p>";
+  for (int i = 0; i < 20000; ++i) {
+    content += "<p>filler</p>";
+  }
+  ASSERT_GT(content.size(), 64U*1024U);
+  content += "<p>a hidden word at the end</p>";
+  creator.addItem(std::make_shared<TestItem>("bigPath", "text/html", "Big Article", content));
+  creator.addItem(std::make_shared<TestItem>("smallPath", "text/html", "Small Article", "another random paragraph"));
+  creator.finishZimCreation();
+
+  zim::Archive archive(tza.getPath());
+
+  // Only the start of the item is used to generate the snippet.
+  const auto cacheSize = zim::getSnippetSourceCacheCurrentSize();
+  const auto snippets = getSnippet(archive, "random paragraph", 2);
+  ASSERT_EQ(2U, snippets.size());
+  for (const auto& snippet : snippets) {
+    ASSERT_NE(std::string::npos, snippet.find("<b>random</b> <b>paragraph</b>")) << snippet;
+    ASSERT_LT(snippet.size(), 1000U);
+  }
+
+  // The extracted text is cached.
+  const auto filledCacheSize = zim::getSnippetSourceCacheCurrentSize();
+  ASSERT_GT(filledCacheSize, cacheSize);
+  ASSERT_LT(filledCacheSize - cacheSize, 2*64U*1024U);
+  ASSERT_EQ(snippets, getSnippet(archive, "random paragraph", 2));
+  ASSERT_EQ(filledCacheSize, zim::getSnippetSourceCacheCurrentSize());
+
+  // A term only present after the start of the item is found, but not
+  // highlighted in the snippet.
+  const auto hiddenSnippets = getSnippet(archive, "hidden", 1);
+  ASSERT_EQ(1U, hiddenSnippets.size());
+  ASSERT_EQ(std::string::npos, hiddenSnippets[0].find("<b>hidden</b>")) << hiddenSnippets[0];
+}
+
+TEST(Search, storedSnippets)
+{
+  TempZimArchive tza("testZim");
+  zim::writer::Creator creator;
+  creator.configIndexing(true, "en");
+  creator.configSearchSnippets(60);
+  creator.startZimCreation(tza.getPath());
+  std::string content = "this is the content of a random paragraph.";
+  for (int i = 0; i < 100; ++i) {
+    content += " filler";
+  }
+  content += " conclusion";
+  creator.addItem(std::make_shared<TestItem>("testPath", "text/html", "Test Article", content));
+  creator.finishZimCreation();
+
+  zim::Archive archive(tza.getPath());
+
+  // The snippets are generated from the stored excerpt of the content.
+  EXPECT_SNIPPET_EQ(
+    archive,
+    1,
+    "random paragraph",
+    {
+      "this is the content of a <b>random</b> <b>paragraph</b>. filler filler"
+    }
+  );
+  EXPECT_SNIPPET_EQ(
+    archive,
+    1,
+    "conclusion",
+    {
+      "this is the content of a random paragraph. filler filler"
+    }
+  );
+}
+
 TEST(Search, multiSearch)
 {
   TempZimArchive tza("testZim");
@@ -331,4 +416,240 @@ TEST(Search, accents)
     ASSERT_EQ(result.begin().getTitle(), "Test Article0");
   }
 }
+
+TEST(Search, concurrentSearches)
+{
+  TempZimArchive tza("testZim");
+
+  zim::writer::Creator creator;
+  creator.configIndexing(true, "en");
+  creator.startZimCreation(tza.getPath());
+  for (int i = 0; i < 20; ++i) {
+    const auto content = i % 2 ? "This is a test article. Odd." : "This is a test article. Even.";
+    creator.addItem(std::make_shared<TestItem>("path" + std::to_string(i), "text/html", "Test Article" + std::to_string(i), content));
+  }
+  creator.finishZimCreation();
+
+  zim::Archive archive(tza.getPath());
+  zim::Searcher sharedSearcher(archive);
+
+  // A search still alive doesn't prevent the next ones from running.
+  auto firstSearch = sharedSearcher.search(zim::Query("odd"));
+  auto firstResults = firstSearch.getResults(0, 20);
+
+  std::vector<std::thread> threads;
+  std::vector<int> matches(8, 0);
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t]() {
+      zim::Searcher ownSearcher(archive);
+      auto& searcher = t % 2 ? sharedSearcher : ownSearcher;
+      for (int i = 0; i < 10; ++i) {
+        auto search = searcher.search(zim::Query(t % 4 < 2 ? "odd" : "even"));
+        int count = 0;
+        for (const auto& entry : search.getResults(0, 20)) {
+          (void)entry;
+          ++count;
+        }
+        matches[t] = count;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(std::vector<int>(8, 10), matches);
+  ASSERT_EQ(10, firstResults.size());
+}
+
+TEST(Search, parallelSearch)
+{
+  std::vector<std::unique_ptr<TempZimArchive>> tzas;
+  std::vector<zim::Archive> archives;
+  for (int a = 0; a < 3; ++a) {
+    tzas.emplace_back(new TempZimArchive("testZim"));
+    zim::writer::Creator creator;
+    creator.configIndexing(true, "en");
+    creator.startZimCreation(tzas.back()->getPath());
+    for (int i = 0; i < 5; ++i) {
+      const auto suffix = std::to_string(a) + "_" + std::to_string(i);
+      const auto content = i % 2 ? "This is a test article. Odd." : "This is a test article. Even.";
+      creator.addItem(std::make_shared<TestItem>("path" + suffix, "text/html", "Test Article" + suffix, content));
+    }
+    creator.finishZimCreation();
+    archives.emplace_back(tzas.back()->getPath());
+  }
+
+  zim::Searcher searcher(archives);
+  zim::Searcher parallelSearcher(archives);
+  parallelSearcher.setParallelSearch(2);
+  parallelSearcher.setArchiveTimeout(60000);
+
+  for (const auto& query : {"test article", "odd", "even", "nothing"}) {
+    auto results = searcher.search(zim::Query(query)).getResults(0, 20);
+    auto parallelResults = parallelSearcher.search(zim::Query(query)).getResults(0, 20);
+    ASSERT_TRUE(parallelResults.isComplete());
+    ASSERT_EQ(results.getEstimatedMatches(), parallelResults.getEstimatedMatches());
+
+    std::set<std::string> paths, parallelPaths;
+    for (auto it = results.begin(); it != results.end(); ++it) {
+      paths.insert(it.getPath());
+    }
+    for (auto it = parallelResults.begin(); it != parallelResults.end(); ++it) {
+      parallelPaths.insert(it.getPath());
+    }
+    ASSERT_EQ(paths, parallelPaths) << query;
+  }
+
+  // The best results of all the archives are merged.
+  auto search = parallelSearcher.search(zim::Query("odd"));
+  ASSERT_EQ(4, search.getResults(0, 4).size());
+  ASSERT_EQ(2, search.getResults(4, 4).size());
+}
+
+#ifndef _WIN32
+TEST(Search, searchArchiveOpenedByFd)
+{
+  TempZimArchive tza("testZim");
+
+  zim::writer::Creator creator;
+  creator.configIndexing(true, "en");
+  creator.startZimCreation(tza.getPath());
+  creator.addItem(std::make_shared<TestItem>("path0", "text/html", "Test Article0", "This is a test article. temp0"));
+  creator.addItem(std::make_shared<TestItem>("path1", "text/html", "Test Article1", "This is another test article. For article1."));
+  creator.finishZimCreation();
+
+  const int fd = open(tza.getPath().c_str(), O_RDONLY);
+  ASSERT_NE(-1, fd);
+  zim::Archive archive(zim::FdInput(fd, 0, zim::Archive(tza.getPath()).getFilesize()));
+  // The fulltext index is opened from the fd held by the archive, not from
+  // the (now invalid) path of the user fd.
+  close(fd);
+
+  zim::Searcher searcher(archive);
+  auto search = searcher.search(zim::Query("temp0"));
+  auto results = search.getResults(0, 10);
+  ASSERT_EQ(1, results.size());
+  ASSERT_EQ("path0", results.begin().getPath());
+}
+#endif
+
+TEST(Search, resultCache)
+{
+  TempZimArchive tza("testZim");
+
+  zim::writer::Creator creator;
+  creator.configIndexing(true, "en");
+  creator.startZimCreation(tza.getPath());
+  creator.addItem(std::make_shared<TestItem>("path0", "text/html", "Test Article0", "This is a test article. temp0"));
+  creator.addItem(std::make_shared<TestItem>("path1", "text/html", "Test Article1", "This is another test article. For article1."));
+  creator.addItem(std::make_shared<TestItem>("path2", "text/html", "Test Article2", "This is a test article. Super."));
+  creator.finishZimCreation();
+
+  const auto initialMaxSize = zim::getSearchResultCacheMaxSize();
+  zim::setSearchResultCacheMaxSize(0);
+  ASSERT_EQ(0U, zim::getSearchResultCacheCurrentSize());
+  zim::setSearchResultCacheMaxSize(1024*1024);
+
+  zim::Archive archive(tza.getPath());
+  zim::Searcher searcher(archive);
+
+  auto getPaths = [&](const std::string& query, int start, int count) {
+    std::vector<std::string> paths;
+    for (const auto& entry : searcher.search(zim::Query(query)).getResults(start, count)) {
+      paths.push_back(entry.getPath());
+    }
+    return paths;
+  };
+
+  const auto paths = getPaths("test article", 0, 3);
+  ASSERT_EQ(3U, paths.size());
+  const auto cacheSize = zim::getSearchResultCacheCurrentSize();
+  ASSERT_GT(cacheSize, 0U);
+
+  // The same search is served from the cache.
+  ASSERT_EQ(paths, getPaths("test article", 0, 3));
+  ASSERT_EQ(cacheSize, zim::getSearchResultCacheCurrentSize());
+
+  // Other pages and other queries are cached separately.
+  ASSERT_EQ(std::vector<std::string>(paths.begin() + 1, paths.end()), getPaths("test article", 1, 2));
+  ASSERT_GT(zim::getSearchResultCacheCurrentSize(), cacheSize);
+  ASSERT_EQ(std::vector<std::string>{"path2"}, getPaths("super", 0, 3));
+
+  auto search = searcher.search(zim::Query("test article"));
+  ASSERT_EQ(3, search.getEstimatedMatches());
+  ASSERT_EQ(3, search.getEstimatedMatches());
+  auto result = search.getResults(0, 1);
+  ASSERT_EQ(1, result.size());
+  ASSERT_NE("", result.begin().getSnippet());
+
+  // An archive rebuilt with the same uuid is not served the cached results.
+  TempZimArchive rebuiltTza("testZim");
+  {
+    zim::writer::Creator rebuiltCreator;
+    rebuiltCreator.configIndexing(true, "en");
+    rebuiltCreator.setUuid(archive.getUuid());
+    rebuiltCreator.startZimCreation(rebuiltTza.getPath());
+    rebuiltCreator.addItem(std::make_shared<TestItem>("path3", "text/html", "Test Article3", "This is a rebuilt test article."));
+    rebuiltCreator.finishZimCreation();
+  }
+  const zim::Archive rebuilt(rebuiltTza.getPath());
+  ASSERT_EQ(archive.getUuid(), rebuilt.getUuid());
+  std::vector<std::string> rebuiltPaths;
+  for (const auto& entry : zim::Searcher(rebuilt).search(zim::Query("test article")).getResults(0, 3)) {
+    rebuiltPaths.push_back(entry.getPath());
+  }
+  ASSERT_EQ(std::vector<std::string>{"path3"}, rebuiltPaths);
+
+  // Without cache, searches still work.
+  zim::setSearchResultCacheMaxSize(0);
+  ASSERT_EQ(0U, zim::getSearchResultCacheCurrentSize());
+  ASSERT_EQ(paths, getPaths("test article", 0, 3));
+  ASSERT_EQ(0U, zim::getSearchResultCacheCurrentSize());
+
+  zim::setSearchResultCacheMaxSize(initialMaxSize);
+}
+
+TEST(Search, estimationWithResults)
+{
+  TempZimArchive tza("testZim");
+
+  zim::writer::Creator creator;
+  creator.configIndexing(true, "en");
+  creator.startZimCreation(tza.getPath());
+  for (int i = 0; i < 30; ++i) {
+    creator.addItem(std::make_shared<TestItem>("path" + std::to_string(i), "text/html", "Test Article" + std::to_string(i), "This is a test article."));
+  }
+  creator.finishZimCreation();
+
+  zim::Archive archive(tza.getPath());
+  zim::Searcher searcher(archive);
+
+  {
+    auto search = searcher.search(zim::Query("test article"));
+    const auto result = search.getResults(0, 20);
+    ASSERT_EQ(20, result.size());
+    ASSERT_EQ(30, result.getEstimatedMatches());
+
+    // The estimation comes from the results already fetched.
+    const auto cacheSize = zim::getSearchResultCacheCurrentSize();
+    ASSERT_EQ(30, search.getEstimatedMatches());
+    ASSERT_EQ(cacheSize, zim::getSearchResultCacheCurrentSize());
+  }
+
+  {
+    auto search = searcher.search(zim::Query("article"));
+    const auto result = search.getResults(0, 5, 100);
+    ASSERT_EQ(5, result.size());
+    ASSERT_EQ(30, result.getEstimatedMatches());
+    ASSERT_EQ(30, search.getEstimatedMatches());
+  }
+
+  {
+    auto search = searcher.search(zim::Query("non existing word"));
+    const auto result = search.getResults(0, 10);
+    ASSERT_EQ(0, result.size());
+    ASSERT_EQ(0, result.getEstimatedMatches());
+  }
+}
 } // unnamed namespace
@@ -22,7 +22,10 @@
 #include <zim/suggestion.h>
 #include <zim/suggestion_iterator.h>
 #include <zim/error.h>
+#include <zim/writer/creator.h>
 #include "tools.h"
+#include "../src/fileimpl.h"
+#include "../src/title_prefix_index.h"
 
 #include "gtest/gtest.h"
 
@@ -164,9 +167,221 @@ TEST(suggestion_iterator, rangeBased) {
   ASSERT_TRUE(it2 == it1);
 
   it2 = srs.end();
-  ASSERT_EQ(it2->getTitle(), "random c");
+  ASSERT_THROW(it2.getEntry(), std::runtime_error);
 }
 
+TEST(suggestion_iterator, foldedRangeBased) {
+  TempZimArchive tza("testZim");
+
+  zim::Archive archive = tza.createZimFromContent({
+    {"Eiffel Tower", "item"},
+    {"eiffel", "item"},
+    {"Éiffel (disambiguation)", "item"},
+    {"Effel", "item"}
+  });
+
+  zim::SuggestionSearcher searcher(archive);
+  auto search = searcher.suggest("eiffel");
+
+#if defined(ENABLE_XAPIAN)
+  search.forceRangeSuggestion();    // Close xapian db to force rangeBased search
+#endif  // ENABLE_XAPIAN
+
+  // Case and accents are ignored, titles are sorted by their folded form.
+  ASSERT_EQ(search.getEstimatedMatches(), 3);
+  auto srs = search.getResults(0, archive.getEntryCount());
+  ASSERT_EQ(srs.size(), 3);
+
+  auto it = srs.begin();
+  ASSERT_EQ(it->getTitle(), "eiffel");
+  it++;
+  ASSERT_EQ(it->getTitle(), "Éiffel (disambiguation)");
+  it++;
+  ASSERT_EQ(it->getTitle(), "Eiffel Tower");
+  ASSERT_EQ(it.getEntry().getPath(), "dummyPathEiffel Tower");
+  it++;
+  ASSERT_EQ(it, srs.end());
+
+  srs = search.getResults(2, 5);
+  ASSERT_EQ(srs.size(), 1);
+  ASSERT_EQ(srs.begin()->getTitle(), "Eiffel Tower");
+
+  search = searcher.suggest("EIFFEL T");
+#if defined(ENABLE_XAPIAN)
+  search.forceRangeSuggestion();
+#endif  // ENABLE_XAPIAN
+  ASSERT_EQ(search.getEstimatedMatches(), 1);
+
+  search = searcher.suggest("Tower");
+#if defined(ENABLE_XAPIAN)
+  search.forceRangeSuggestion();
+#endif  // ENABLE_XAPIAN
+  ASSERT_EQ(search.getEstimatedMatches(), 0);
+}
+
+TEST(suggestion_iterator, prefixIndexBased) {
+  TempZimArchive tza("testZim");
+
+  zim::Archive archive = tza.createZimFromContent({
+    {"Article b", "item b"},
+    {"article a", "item a"},
+    {"Ärticle", "item"},
+    {"random c", "random c"}
+  });
+
+  zim::SuggestionSearcher searcher(archive);
+  searcher.setUsePrefixIndex(true);
+  auto search = searcher.suggest("ARTI");
+
+  // Case and accents are ignored, shortest titles first.
+  ASSERT_EQ(search.getEstimatedMatches(), 3);
+  auto srs = search.getResults(0, archive.getEntryCount());
+  ASSERT_EQ(srs.size(), 3);
+
+  auto it1 = srs.begin();
+  ASSERT_EQ(it1->getTitle(), "Ärticle");
+  it1++;
+  ASSERT_EQ(it1->getTitle(), "article a");
+  ASSERT_EQ(it1.getEntry().getPath(), "dummyPatharticle a");
+  ASSERT_FALSE(it1->hasSnippet());
+
+  zim::SuggestionIterator it2 = it1;
+  ASSERT_TRUE(it2 == it1);
+  it1++;
+  ASSERT_EQ(it1->getTitle(), "Article b");
+  it1--;
+  ASSERT_EQ(it1->getTitle(), "article a");
+
+  it1++;
+  it1++;
+  ASSERT_EQ(it1, srs.end());
+  ASSERT_THROW(it1.getEntry(), std::runtime_error);
+
+  srs = search.getResults(1, 1);
+  ASSERT_EQ(srs.size(), 1);
+  ASSERT_EQ(srs.begin()->getTitle(), "article a");
+}
+
+#if defined(ENABLE_XAPIAN)
+// 0 `nbSuggestions` creates the same archive without stored suggestions.
+zim::Archive createArchiveWithPrefixSuggestions(TempZimArchive& tza, unsigned nbSuggestions, zim::size_type maxSize) {
+  zim::writer::Creator creator;
+  creator.configIndexing(false, "en");
+  creator.configPrefixSuggestions(nbSuggestions, maxSize);
+  creator.startZimCreation(tza.getPath());
+  for (const std::string title : {"Article b", "article", "Ärticle long", "ARTS", "random c", "The art"}) {
+    creator.addItem(std::make_shared<zim::unittests::TestItem>("dummyPath" + title, "text/html", title, "item"));
+  }
+  creator.finishZimCreation();
+  return zim::Archive(tza.getPath());
+}
+
+std::vector<std::string> getSuggestionPaths(const zim::Archive& archive, const std::string& query, int start, int maxResults) {
+  zim::SuggestionSearcher searcher(archive);
+  const auto srs = searcher.suggest(query).getResults(start, maxResults);
+  std::vector<std::string> paths;
+  for (auto it = srs.begin(); it != srs.end(); it++) {
+    paths.push_back(it.getEntry().getPath());
+  }
+  return paths;
+}
+
+TEST(suggestion_iterator, prefixSuggestions) {
+  TempZimArchive tza("testZim");
+  const auto archive = createArchiveWithPrefixSuggestions(tza, 2, 1024);
+  TempZimArchive refTza("testZim");
+  const auto refArchive = createArchiveWithPrefixSuggestions(refTza, 0, 1024);
+  ASSERT_FALSE(refArchive.getImpl()->getTitlePrefixListing());
+
+  // The prefixes of the title words, as written and folded.
+  const auto listing = archive.getImpl()->getTitlePrefixListing();
+  ASSERT_TRUE(listing);
+  zim::TitlePrefixListing::Prefix prefix;
+  for (const std::string query : {"a", "A", "ar", "Ar", "AR", "art", "ART", "r", "ran", "t", "the", "The"}) {
+    ASSERT_TRUE(listing->find(query, prefix)) << query;
+  }
+  ASSERT_FALSE(listing->find("arti", prefix));
+  ASSERT_FALSE(listing->find("he", prefix));
+
+  // The stored suggestions are the first results of the title index.
+  for (const std::string query : {"a", "Ar", "ar", "ÄR", "art", "ran", "t", "arti", "random c", "zz"}) {
+    zim::SuggestionSearcher searcher(archive);
+    zim::SuggestionSearcher refSearcher(refArchive);
+    ASSERT_EQ(searcher.suggest(query).getEstimatedMatches(),
+              refSearcher.suggest(query).getEstimatedMatches()) << query;
+    ASSERT_EQ(getSuggestionPaths(archive, query, 0, 2),
+              getSuggestionPaths(refArchive, query, 0, 2)) << query;
+  }
+
+  ASSERT_TRUE(listing->find("ar", prefix));
+  ASSERT_EQ(prefix.count, 5U);
+  ASSERT_EQ(prefix.entries.size(), 2U);
+  std::vector<std::string> paths;
+  for (const auto entry : prefix.entries) {
+    paths.push_back(archive.getEntryByPath(entry).getPath());
+  }
+  ASSERT_EQ(paths, getSuggestionPaths(refArchive, "ar", 0, 2));
+}
+
+TEST(suggestion_iterator, prefixSuggestionsPaging) {
+  TempZimArchive tza("testZim");
+  const auto archive = createArchiveWithPrefixSuggestions(tza, 2, 1024);
+  TempZimArchive refTza("testZim");
+  const auto refArchive = createArchiveWithPrefixSuggestions(refTza, 0, 1024);
+
+  // The pages across the two stored suggestions continue with the title
+  // index, in the same order.
+  for (const std::string query : {"ar", "a", "ran"}) {
+    const auto all = getSuggestionPaths(refArchive, query, 0, 10);
+    ASSERT_EQ(getSuggestionPaths(archive, query, 0, 10), all) << query;
+    std::vector<std::string> paged;
+    for (int start = 0; start < 6; ++start) {
+      const auto page = getSuggestionPaths(archive, query, start, 1);
+      paged.insert(paged.end(), page.begin(), page.end());
+      for (int maxResults = 0; maxResults < 4; ++maxResults) {
+        ASSERT_EQ(getSuggestionPaths(archive, query, start, maxResults),
+                  getSuggestionPaths(refArchive, query, start, maxResults))
+          << query << " " << start << " " << maxResults;
+      }
+    }
+    ASSERT_EQ(paged, all) << query;
+  }
+  ASSERT_EQ(getSuggestionPaths(refArchive, "ar", 0, 10).size(), 5U);
+}
+
+TEST(suggestion_iterator, prefixSuggestionsSizeBudget) {
+  TempZimArchive tza("testZim");
+  // Room for the one character prefixes starting the most words: "a" (5
+  // titles), "A" (3) and "T" (1, the first one with a single title).
+  const auto archive = createArchiveWithPrefixSuggestions(tza, 2, 60);
+
+  const auto listing = archive.getImpl()->getTitlePrefixListing();
+  ASSERT_TRUE(listing);
+  ASSERT_EQ(listing->size(), 3U);
+  zim::TitlePrefixListing::Prefix prefix;
+  ASSERT_TRUE(listing->find("A", prefix));
+  ASSERT_TRUE(listing->find("T", prefix));
+  ASSERT_EQ(prefix.entries.size(), 1U);
+  ASSERT_TRUE(listing->find("a", prefix));
+  ASSERT_EQ(prefix.count, 5U);
+  ASSERT_EQ(prefix.entries.size(), 2U);
+  ASSERT_FALSE(listing->find("b", prefix));
+  ASSERT_FALSE(listing->find("ar", prefix));
+}
+
+TEST(suggestion_iterator, prefixSuggestionsNeedLanguage) {
+  TempZimArchive tza("testZim");
+  zim::writer::Creator creator;
+  creator.configPrefixSuggestions(2, 1024);
+  creator.startZimCreation(tza.getPath());
+  creator.addItem(std::make_shared<zim::unittests::TestItem>("dummyPath", "text/html", "article", "item"));
+  creator.finishZimCreation();
+
+  const zim::Archive archive(tza.getPath());
+  ASSERT_FALSE(archive.getImpl()->getTitlePrefixListing());
+}
+#endif  // ENABLE_XAPIAN
+
 #if defined(ENABLE_XAPIAN)
 TEST(search_iterator, stemmedSearch) {
   TempZimArchive tza("testZim");
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+#include "thread_pool.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+
+using namespace zim;
+
+const auto TIMEOUT = std::chrono::seconds(10);
+
+TEST(ThreadPool, blockingTasksRunConcurrently)
+{
+  const unsigned TASK_COUNT = 4;
+  std::mutex mutex;
+  std::condition_variable cv;
+  unsigned started = 0;
+  bool release = false;
+
+  ThreadPool pool("test", TASK_COUNT);
+  for (unsigned i = 0; i < TASK_COUNT; ++i) {
+    pool.submit([&]() {
+      std::unique_lock<std::mutex> lock(mutex);
+      ++started;
+      cv.notify_all();
+      cv.wait_for(lock, TIMEOUT, [&]() { return release; });
+    });
+    // Each task is submitted while all the previous ones are still running.
+    std::unique_lock<std::mutex> lock(mutex);
+    ASSERT_TRUE(cv.wait_for(lock, TIMEOUT, [&]() { return started == i + 1; })) << "task " << i;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  release = true;
+  cv.notify_all();
+}
+
+TEST(ThreadPool, threadCountIsRespected)
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  unsigned running = 0;
+  unsigned maxRunning = 0;
+  unsigned done = 0;
+
+  {
+    ThreadPool pool("test", 2);
+    for (unsigned i = 0; i < 10; ++i) {
+      pool.submit([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        maxRunning = std::max(maxRunning, ++running);
+        cv.notify_all();
+        // Give the other threads a chance to run concurrently.
+        cv.wait_for(lock, std::chrono::milliseconds(10), [&]() { return running > 2; });
+        --running;
+        ++done;
+      });
+    }
+    // The pool waits for the tasks to be done.
+  }
+
+  ASSERT_EQ(done, 10U);
+  ASSERT_LE(maxRunning, 2U);
+}
+
+} // unnamed namespace
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 libzim contributors
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * is provided AS IS, WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE, and
+ * NON-INFRINGEMENT.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ *
+ */
+
+
+#include "../src/title_prefix_index.h"
+#include "../src/tools.h"
+
+#include <zim/error.h>
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using zim::TitlePrefixIndex;
+using zim::TitlePrefixListing;
+
+std::vector<TitlePrefixIndex::Title> generateTitles()
+{
+  std::vector<TitlePrefixIndex::Title> titles;
+  const std::vector<std::string> words = {"Paris", "pari", "Éclair", "eclipse", "a", "Ab", "abc", "z"};
+  zim::entry_index_type entry = 0;
+  for (const auto& first: words) {
+    for (const auto& second: words) {
+      titles.push_back({first + " " + second, entry++});
+      titles.push_back({first + second, entry++});
+    }
+  }
+  titles.push_back({"", entry++});
+  return titles;
+}
+
+// The expected results, computed by scanning all the titles.
+std::vector<zim::entry_index_type> bruteForce(std::vector<TitlePrefixIndex::Title> titles, const std::string& prefix)
+{
+  const auto foldedPrefix = zim::foldTitle(prefix);
+  std::vector<TitlePrefixIndex::Title> matches;
+  for (const auto& title: titles) {
+    if (zim::foldTitle(title.title).compare(0, foldedPrefix.size(), foldedPrefix) == 0) {
+      matches.push_back(title);
+    }
+  }
+  std::sort(matches.begin(), matches.end(), [](const TitlePrefixIndex::Title& a, const TitlePrefixIndex::Title& b) {
+    const auto foldedA = zim::foldTitle(a.title);
+    const auto foldedB = zim::foldTitle(b.title);
+    if (a.title.size() != b.title.size()) {
+      return a.title.size() < b.title.size();
+    }
+    if (foldedA != foldedB) {
+      return foldedA < foldedB;
+    }
+    return a.entry < b.entry;
+  });
+  std::vector<zim::entry_index_type> entries;
+  for (const auto& match: matches) {
+    entries.push_back(match.entry);
+  }
+  return entries;
+}
+
+TEST(TitlePrefixIndex, empty)
+{
+  const TitlePrefixIndex index({});
+  ASSERT_EQ(0U, index.size());
+  ASSERT_EQ(0U, index.count(""));
+  ASSERT_EQ(0U, index.count("a"));
+  ASSERT_TRUE(index.getBest("a", 0, 10).empty());
+}
+
+TEST(TitlePrefixIndex, prefixes)
+{
+  const auto titles = generateTitles();
+  const TitlePrefixIndex index(titles);
+  ASSERT_EQ(titles.size(), index.size());
+
+  for (const std::string prefix : {"", "a", "A", "ab", "abc", "abca", "abc ", "p", "PAR", "paris",
+                                   "e", "é", "ÉCL", "eclipsez", "z", "zz", "b", "0", "~"}) {
+    const auto expected = bruteForce(titles, prefix);
+    ASSERT_EQ(expected.size(), index.count(prefix)) << prefix;
+    ASSERT_EQ(expected, index.getBest(prefix, 0, titles.size())) << prefix;
+
+    // Ranges of results
+    for (size_t start = 0; start <= expected.size(); start += 7) {
+      const auto end = std::min(start + 5, expected.size());
+      const std::vector<zim::entry_index_type> expectedRange(expected.begin() + start, expected.begin() + end);
+      ASSERT_EQ(expectedRange, index.getBest(prefix, start, 5)) << prefix << " " << start;
+    }
+  }
+}
+
+TEST(TitlePrefixListing, serialization)
+{
+  const std::vector<TitlePrefixListing::Prefix> prefixes = {
+    {"a", 12, {5, 3, 0x12345678}},
+    {"ab", 2, {3, 5}},
+    {"b", 0, {}},
+    {"\xc3\xa9", 300, {7}}
+  };
+  const auto data = TitlePrefixListing::serialize(prefixes);
+  size_t expectedSize = sizeof(uint32_t);
+  for (const auto& prefix: prefixes) {
+    expectedSize += TitlePrefixListing::recordSize(prefix);
+  }
+  ASSERT_EQ(expectedSize, data.size());
+
+  const TitlePrefixListing listing(zim::Blob(data.data(), data.size()));
+  ASSERT_EQ(4U, listing.size());
+  for (const auto& expected: prefixes) {
+    TitlePrefixListing::Prefix prefix;
+    ASSERT_TRUE(listing.find(expected.prefix, prefix)) << expected.prefix;
+    ASSERT_EQ(expected.prefix, prefix.prefix);
+    ASSERT_EQ(expected.count, prefix.count);
+    ASSERT_EQ(expected.entries, prefix.entries);
+  }
+
+  TitlePrefixListing::Prefix prefix;
+  for (const std::string missing : {"", "0", "aa", "abc", "c", "\xc3"}) {
+    ASSERT_FALSE(listing.find(missing, prefix)) << missing;
+  }
+
+  const auto emptyData = TitlePrefixListing::serialize({});
+  const TitlePrefixListing emptyListing(zim::Blob(emptyData.data(), emptyData.size()));
+  ASSERT_EQ(0U, emptyListing.size());
+  ASSERT_FALSE(emptyListing.find("a", prefix));
+}
+
+TEST(TitlePrefixListing, invalidData)
+{
+  ASSERT_THROW(TitlePrefixListing(zim::Blob("\x01\x00", 2)), zim::ZimFileFormatError);
+  // Two records announced, only one offset.
+  ASSERT_THROW(TitlePrefixListing(zim::Blob("\x02\x00\x00\x00\x08\x00\x00\x00", 8)), zim::ZimFileFormatError);
+
+  // The record is truncated.
+  auto data = TitlePrefixListing::serialize({{"a", 3, {1, 2, 3}}});
+  data.resize(data.size() - 1);
+  const TitlePrefixListing listing(zim::Blob(data.data(), data.size()));
+  TitlePrefixListing::Prefix prefix;
+  ASSERT_THROW(listing.find("a", prefix), zim::ZimFileFormatError);
+}
+
+} // unnamed namespace
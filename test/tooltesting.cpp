@@ -93,6 +93,17 @@ namespace {
     ASSERT_EQ(zim::stripMimeParameters(";"), "");
   }
 
+  TEST(Tools, foldTitle) {
+    ASSERT_EQ(zim::foldTitle("Eiffel Tower"), "eiffel tower");
+    ASSERT_EQ(zim::foldTitle("ÉLÈVE à Łódź"), "eleve a lodz");
+    ASSERT_EQ(zim::foldTitle("Straße, Æther, Œuvre"), "strasse, aether, oeuvre");
+    // Decomposed accents
+    ASSERT_EQ(zim::foldTitle("Be\xcc\x81po"), "bepo");
+    ASSERT_EQ(zim::foldTitle("ΣΟΦΙΑ Москва"), "σοφια москва");
+    // Not utf-8
+    ASSERT_EQ(zim::foldTitle("A\xff\xc3"), "a\xff\xc3");
+  }
+
 #if defined(ENABLE_XAPIAN)
   TEST(Tools, removeAccents) {
     ASSERT_EQ(zim::removeAccents("bépoàǹ"), "bepoan");